@@ -121,10 +121,3 @@ void *mremap(void* addr, size_t old_len, size_t new_len, int flags, ...){
     return mpk_mremap(addr, old_len, new_len, flags);
 }
 */
-
-void* __allocate_extern_stack(size_t size){
-    //TODO: should ensure mmap is done in extern stack. perhaps should use real_mmap
-     char* extern_stack_ptr = unsafe_allocator.malloc(size); 
-    //char* extern_stack_ptr = mmap(0, size,  PROT_READ | PROT_WRITE, MAP_POPULATE | MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
-    return extern_stack_ptr+size;
-}
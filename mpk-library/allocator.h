@@ -41,6 +41,6 @@ void* __safe_malloc(size_t);
 void* __unsafe_malloc(size_t);
 void __safe_free(void*);
 void __unsafe_free(void*);
-void* __allocate_extern_stack(size_t);
+void* __allocate_extern_stack(size_t);   // extern_stack.c, attached to the caller
 void init_allocator_hooks();
 #endif //MPK_LIBRARY_ALLOCATOR_H
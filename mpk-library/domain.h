@@ -23,10 +23,11 @@ typedef struct domain {
   void *extern_stack_ptr; //+0
   uint64_t domain; //+8
   uint64_t eax_scrap; //+16
-  uint64_t edx_scrap; //+32
-  uint64_t ecx_scrap; //+48
-  void *safe_stack_ptr; //+56
-  uint64_t unsafeFlag; //+64
+  uint64_t edx_scrap; //+24
+  uint64_t ecx_scrap; //+32
+  void *safe_stack_ptr; //+40
+  uint64_t unsafeFlag; //+48
+  void *ffi_tail_target; //+56, callee handed to the shared FFI gates
 } domain_t;
 
 
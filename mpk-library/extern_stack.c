@@ -0,0 +1,242 @@
+//
+// Extern stack lifecycle, derived from compiler-rt/lib/safestack/safestack.cpp.
+//
+// Stacks live in the unsafe window (they come from the unsafe allocator), get
+// a PROT_NONE guard page at their low end and are attached to the thread that
+// uses them. When that thread exits, its stacks are queued with its tid and
+// only recycled once the kernel reports the thread gone, since the stacks are
+// still in use while the thread unwinds. Recycled stacks are cached and
+// handed to the next thread instead of being freed, so thread churn costs the
+// same as with SafeStack.
+//
+// Native stacks of extern-domain threads are different: glibc keeps the
+// thread descriptor on them, and pthread_join reads it after the thread is
+// gone. They are freed after the join (or, for detached threads, once the
+// thread is gone) and never go to the cache. They are listed before the
+// thread starts and get their owner from whichever of the creator and the
+// thread itself gets there first, so a thread detaching itself right away
+// still finds its stack.
+//
+
+#include "extern_stack.h"
+#include "probes.h"
+#include <errno.h>
+#include <signal.h>
+
+__thread domain_t *__mpk_tls_domain __attribute__((tls_model("initial-exec")));
+
+/* stacks attached to the current thread */
+static __thread extern_stack_t *thread_stacks __attribute__((tls_model("initial-exec")));
+
+static pthread_key_t EXTERN_STACK_KEY;
+static pthread_mutex_t stacks_lock = PTHREAD_MUTEX_INITIALIZER;
+static extern_stack_t *dead_stacks;     // owners exited, maybe still unwinding
+static extern_stack_t *cached_stacks;   // ready for reuse
+static extern_stack_t *joinable_stacks; // native stacks of joinable threads
+static size_t num_cached_stacks;
+
+static char *extern_stack_guard(extern_stack_t *stack){
+    return (char*)(((size_t)stack->base + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1));
+}
+
+static pid_t extern_stack_gettid(){
+    return (pid_t)syscall(SYS_gettid);
+}
+
+static void extern_stack_free(extern_stack_t *stack){
+    mprotect(extern_stack_guard(stack), EXTERN_STACK_GUARD_SIZE,
+             PROT_READ | PROT_WRITE);
+    __unsafe_free(stack->base);
+    __safe_free(stack);
+}
+
+/* Move stacks whose owner is gone from dead_stacks to the cache (native
+ * stacks are freed); the caller holds stacks_lock. A native stack whose
+ * thread has not started yet has no tid. */
+static void reap_dead_stacks(){
+    pid_t pid = getpid();
+    extern_stack_t **link = &dead_stacks;
+    while(*link){
+        extern_stack_t *stack = *link;
+        pid_t tid = __atomic_load_n(&stack->tid, __ATOMIC_ACQUIRE);
+        if(tid && syscall(SYS_tgkill, pid, tid, 0) == -1 && errno == ESRCH){
+            *link = stack->next;
+            if(!stack->native && num_cached_stacks < EXTERN_STACK_CACHE_MAX){
+                stack->next = cached_stacks;
+                cached_stacks = stack;
+                num_cached_stacks++;
+            }else{
+                extern_stack_free(stack);
+            }
+        }else{
+            link = &stack->next;
+        }
+    }
+}
+
+static void extern_stack_thread_exit(void *ptr){
+    extern_stack_t *stack = ptr;
+    pid_t tid = extern_stack_gettid();
+    pthread_mutex_lock(&stacks_lock);
+    while(stack){
+        extern_stack_t *next = stack->next;
+        MPK_PROBE2(extern_stack_release, extern_stack_bottom(stack), tid);
+        stack->tid = tid;
+        stack->next = dead_stacks;
+        dead_stacks = stack;
+        stack = next;
+    }
+    reap_dead_stacks();
+    pthread_mutex_unlock(&stacks_lock);
+    thread_stacks = NULL;
+}
+
+void init_extern_stacks(){
+    if(pthread_key_create(&EXTERN_STACK_KEY, extern_stack_thread_exit)){
+        DOMAIN_KEY_CREATE_ERROR
+    }
+}
+
+static extern_stack_t *extern_stack_create(size_t size){
+    extern_stack_t *stack = __safe_malloc(sizeof(extern_stack_t));
+    if(!stack)
+        OUT_OF_MEMORY_ERROR
+    /* over-allocate by a page so the guard can be page aligned */
+    char *mem = __unsafe_malloc(size + EXTERN_STACK_GUARD_SIZE + PAGE_SIZE);
+    if(!mem)
+        OUT_OF_MEMORY_ERROR
+    stack->base = mem;
+    stack->size = size;
+    stack->tid = 0;
+    stack->native = 0;
+    stack->has_owner = 0;
+    stack->next = NULL;
+    mprotect(extern_stack_guard(stack), EXTERN_STACK_GUARD_SIZE, PROT_NONE);
+    return stack;
+}
+
+extern_stack_t *extern_stack_acquire(size_t size){
+    size = (size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+
+    pthread_mutex_lock(&stacks_lock);
+    reap_dead_stacks();
+    extern_stack_t **link = &cached_stacks;
+    while(*link && (*link)->size != size)
+        link = &(*link)->next;
+    extern_stack_t *stack = *link;
+    if(stack){
+        *link = stack->next;
+        num_cached_stacks--;
+    }
+    pthread_mutex_unlock(&stacks_lock);
+    if(stack){
+        stack->next = NULL;
+        MPK_PROBE3(extern_stack_alloc, extern_stack_bottom(stack), size, 1);
+        return stack;
+    }
+
+    stack = extern_stack_create(size);
+    MPK_PROBE3(extern_stack_alloc, extern_stack_bottom(stack), size, 0);
+    return stack;
+}
+
+void *extern_stack_bottom(extern_stack_t *stack){
+    return extern_stack_guard(stack) + EXTERN_STACK_GUARD_SIZE;
+}
+
+void *extern_stack_top(extern_stack_t *stack){
+    return (char*)extern_stack_bottom(stack) + stack->size;
+}
+
+/* Tie stack to the calling thread; it is recycled after the thread exits. */
+void extern_stack_attach(extern_stack_t *stack){
+    stack->next = thread_stacks;
+    thread_stacks = stack;
+    if(pthread_setspecific(EXTERN_STACK_KEY, thread_stacks)){
+        DOMAIN_SET_ERROR
+    }
+}
+
+void* __allocate_extern_stack(size_t size){
+    extern_stack_t *stack = extern_stack_acquire(size);
+    extern_stack_attach(stack);
+    return extern_stack_top(stack);
+}
+
+extern_stack_t *native_stack_create(size_t size){
+    size = (size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+    extern_stack_t *stack = extern_stack_create(size);
+    stack->native = 1;
+    return stack;
+}
+
+/* Listed before the thread is created, without an owner yet. */
+void native_stack_add_joinable(extern_stack_t *stack){
+    pthread_mutex_lock(&stacks_lock);
+    stack->next = joinable_stacks;
+    joinable_stacks = stack;
+    pthread_mutex_unlock(&stacks_lock);
+}
+
+/* Name the thread running on stack, unless it is named already. The stack is
+ * only touched while it is still listed: once released it may be gone. */
+void native_stack_set_owner(extern_stack_t *stack, pthread_t owner){
+    pthread_mutex_lock(&stacks_lock);
+    extern_stack_t *listed = joinable_stacks;
+    while(listed && listed != stack)
+        listed = listed->next;
+    if(listed && !stack->has_owner){
+        stack->owner = owner;
+        stack->has_owner = 1;
+    }
+    pthread_mutex_unlock(&stacks_lock);
+}
+
+/* Called on the new thread, before it runs any user code. */
+void native_stack_started(extern_stack_t *stack){
+    __atomic_store_n(&stack->tid, extern_stack_gettid(), __ATOMIC_RELEASE);
+    native_stack_set_owner(stack, pthread_self());
+}
+
+static extern_stack_t *take_joinable_stack(pthread_t owner){
+    extern_stack_t **link = &joinable_stacks;
+    while(*link && !((*link)->has_owner && pthread_equal((*link)->owner, owner)))
+        link = &(*link)->next;
+    extern_stack_t *stack = *link;
+    if(stack)
+        *link = stack->next;
+    return stack;
+}
+
+/* pthread_join has returned: nothing uses the stack any more. */
+void native_stack_release_joined(pthread_t owner){
+    pthread_mutex_lock(&stacks_lock);
+    extern_stack_t *stack = take_joinable_stack(owner);
+    pthread_mutex_unlock(&stacks_lock);
+    if(stack)
+        extern_stack_free(stack);
+}
+
+/* A detached thread frees its descriptor itself; the stack is free once the
+ * thread is gone. */
+void native_stack_release_detached(pthread_t owner){
+    pthread_mutex_lock(&stacks_lock);
+    extern_stack_t *stack = take_joinable_stack(owner);
+    if(stack){
+        stack->next = dead_stacks;
+        dead_stacks = stack;
+    }
+    reap_dead_stacks();
+    pthread_mutex_unlock(&stacks_lock);
+}
+
+/* The thread was never created. */
+void native_stack_destroy(extern_stack_t *stack){
+    pthread_mutex_lock(&stacks_lock);
+    extern_stack_t **link = &joinable_stacks;
+    while(*link != stack)
+        link = &(*link)->next;
+    *link = stack->next;
+    pthread_mutex_unlock(&stacks_lock);
+    extern_stack_free(stack);
+}
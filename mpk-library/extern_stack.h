@@ -0,0 +1,44 @@
+//
+// Extern stack lifecycle, derived from compiler-rt's SafeStack runtime.
+//
+
+#ifndef MPK_LIBRARY_EXTERN_STACK_H
+#define MPK_LIBRARY_EXTERN_STACK_H
+
+#include "allocator.h"
+
+#define EXTERN_STACK_GUARD_SIZE     (PAGE_SIZE)
+#define EXTERN_STACK_CACHE_MAX      (64)
+
+typedef struct extern_stack {
+    void *base;                 // lowest address, guard page(s) included
+    size_t size;                // usable size above the guard
+    pid_t tid;                  // owning thread, for deferred release
+    int native;                 // native stack of a thread, never cached
+    int has_owner;              // owner is known
+    pthread_t owner;            // thread running on a native stack
+    struct extern_stack *next;
+} extern_stack_t;
+
+/* Per-thread domain block at a fixed (initial-exec) TLS offset, so the
+ * extern stack pointer at domain+0 is one %fs-relative load away. */
+extern __thread domain_t *__mpk_tls_domain __attribute__((tls_model("initial-exec")));
+
+void init_extern_stacks();
+extern_stack_t *extern_stack_acquire(size_t size);
+void *extern_stack_bottom(extern_stack_t *stack);
+void *extern_stack_top(extern_stack_t *stack);
+void extern_stack_attach(extern_stack_t *stack);
+
+/* Native stacks handed to pthread_attr_setstack. glibc keeps the thread
+ * descriptor on them until the thread is joined, so they are freed after
+ * pthread_join, or once a detached thread is gone, and never cached. */
+extern_stack_t *native_stack_create(size_t size);
+void native_stack_started(extern_stack_t *stack);
+void native_stack_add_joinable(extern_stack_t *stack);
+void native_stack_set_owner(extern_stack_t *stack, pthread_t owner);
+void native_stack_release_joined(pthread_t owner);
+void native_stack_release_detached(pthread_t owner);
+void native_stack_destroy(extern_stack_t *stack);
+
+#endif //MPK_LIBRARY_EXTERN_STACK_H
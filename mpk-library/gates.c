@@ -0,0 +1,138 @@
+//
+// Shared out-of-line gates for FFI calls: the tail gate for calls the
+// compiler keeps in tail position and the call gate used by cold call sites.
+//
+
+#include "mpk.h"
+#include "probes.h"
+#include <stddef.h>
+
+_Static_assert(offsetof(domain_t, extern_stack_ptr) == 0, "extern stack slot");
+_Static_assert(offsetof(domain_t, domain) == 8, "domain slot");
+_Static_assert(offsetof(domain_t, ffi_tail_target) == 56, "tail target slot");
+/* the tail gate tests for the unsafe window with rsp >> 34 == 0x1440 */
+_Static_assert(UNSAFE_REGION_LEN == (1UL << 34) &&
+               UNSAFE_START_ADDR == (0x1440UL << 34), "unsafe window");
+
+/* __mpk_ffi_tail_gate is entered with a jmp from a Rust wrapper whose last
+ * action is an FFI call. %r15 holds the domain block, the callee was stored
+ * in domain->ffi_tail_target and all arguments are in registers. The gate
+ * takes over the wrapper's return address, moves to the extern stack, switches
+ * the domain and jumps to the callee, which returns into __mpk_ffi_tail_return.
+ * The stub switches back and returns straight to the wrapper's caller, so the
+ * wrapper costs one gate and no frame of its own.
+ * The wrapper's stack pointer, its return address and the callee are kept in
+ * a frame on the extern stack rather than in the domain block, so a callback
+ * making another tail-gated call cannot clobber them. Such a callback already
+ * runs on the extern stack (%rsp lies in the unsafe window), and its gate
+ * places the new frame below the current one instead of at the extern stack
+ * top. Frame, from the top: saved %rsp, return address, callee, padding.
+ * %r10/%r11 are scratch under the SysV ABI and are used to keep %rax (the
+ * vararg vector count), %rcx and %rdx (arguments or return values) alive
+ * across WRPKRU. */
+__asm__(
+    ".text\n"
+    ".globl __mpk_ffi_tail_gate\n"
+    ".type __mpk_ffi_tail_gate,@function\n"
+    "__mpk_ffi_tail_gate:\n"
+    MPK_ASM_PROBE(gate_enter, "8@56(%r15)")
+    "  popq %r11\n"
+    "  movq %rsp, %r10\n"
+    "  shrq $34, %r10\n"
+    "  cmpq $0x1440, %r10\n"
+    "  movq %rsp, %r10\n"
+    "  je 1f\n"
+    "  movq (%r15), %r10\n"
+    "1:\n"
+    "  andq $-16, %r10\n"
+    "  movq %rsp, -8(%r10)\n"
+    "  movq %r11, -16(%r10)\n"
+    "  movq 56(%r15), %r11\n"
+    "  movq %r11, -24(%r10)\n"
+    "  leaq -32(%r10), %rsp\n"
+    "  leaq __mpk_ffi_tail_return(%rip), %r11\n"
+    "  pushq %r11\n"
+    "  movl $1, 8(%r15)\n"
+    "  movq %rax, %r10\n"
+    "  movq %rcx, %r11\n"
+    "  movq %rdx, 16(%r15)\n"
+    "  xorl %ecx, %ecx\n"
+    "  xorl %edx, %edx\n"
+    "  xorl %eax, %eax\n"
+    "  .byte 0x0f,0x01,0xef\n" /* wrpkru */
+    "  movq %r10, %rax\n"
+    "  movq %r11, %rcx\n"
+    "  movq 16(%r15), %rdx\n"
+    "  jmpq *16(%rsp)\n"
+    ".size __mpk_ffi_tail_gate, .-__mpk_ffi_tail_gate\n"
+    "\n"
+    ".type __mpk_ffi_tail_return,@function\n"
+    "__mpk_ffi_tail_return:\n"
+    "  movq %rax, %r10\n"
+    "  movq %rdx, %r11\n"
+    "  xorl %ecx, %ecx\n"
+    "  xorl %edx, %edx\n"
+    "  xorl %eax, %eax\n"
+    "  .byte 0x0f,0x01,0xef\n" /* wrpkru */
+    "  movq %r10, %rax\n"
+    "  movq %r11, %rdx\n"
+    "  movl $0, 8(%r15)\n"
+    MPK_ASM_PROBE(gate_exit, "8@%rax")
+    "  movq 16(%rsp), %rcx\n"
+    "  movq 24(%rsp), %rsp\n"
+    "  jmpq *%rcx\n"
+    ".size __mpk_ffi_tail_return, .-__mpk_ffi_tail_return\n");
+
+/* __mpk_ffi_gate is called from FFI call sites that the X86 isolation pass
+ * does not expand inline (-mpk-outline-gates) and from indirect calls of
+ * SFI-confined C code. The call site stored the callee in
+ * domain->ffi_tail_target and placed all arguments in registers. The gate
+ * performs the same sequence as the inline expansion: save %rsp, move to the
+ * extern stack, switch the domain, call the callee, switch back and return to
+ * the call site. Like the tail gate, it keeps the saved %rsp and the callee
+ * in a frame on the extern stack, below the current stack pointer when
+ * entered from a callback, so nested gated calls do not clobber them.
+ * %r10/%r11 keep %rax, %rcx and %rdx alive across WRPKRU. */
+__asm__(
+    ".text\n"
+    ".globl __mpk_ffi_gate\n"
+    ".type __mpk_ffi_gate,@function\n"
+    "__mpk_ffi_gate:\n"
+    MPK_ASM_PROBE(gate_enter, "8@56(%r15)")
+    "  movq %rsp, %r10\n"
+    "  shrq $34, %r10\n"
+    "  cmpq $0x1440, %r10\n"
+    "  movq %rsp, %r10\n"
+    "  je 1f\n"
+    "  movq (%r15), %r10\n"
+    "1:\n"
+    "  andq $-16, %r10\n"
+    "  movq %rsp, -8(%r10)\n"
+    "  movq 56(%r15), %r11\n"
+    "  movq %r11, -16(%r10)\n"
+    "  leaq -16(%r10), %rsp\n"
+    "  movl $1, 8(%r15)\n"
+    "  movq %rax, %r10\n"
+    "  movq %rcx, %r11\n"
+    "  movq %rdx, 16(%r15)\n"
+    "  xorl %ecx, %ecx\n"
+    "  xorl %edx, %edx\n"
+    "  xorl %eax, %eax\n"
+    "  .byte 0x0f,0x01,0xef\n" /* wrpkru */
+    "  movq %r10, %rax\n"
+    "  movq %r11, %rcx\n"
+    "  movq 16(%r15), %rdx\n"
+    "  callq *(%rsp)\n"
+    "  movq %rax, %r10\n"
+    "  movq %rdx, %r11\n"
+    "  xorl %ecx, %ecx\n"
+    "  xorl %edx, %edx\n"
+    "  xorl %eax, %eax\n"
+    "  .byte 0x0f,0x01,0xef\n" /* wrpkru */
+    "  movq %r10, %rax\n"
+    "  movq %r11, %rdx\n"
+    "  movl $0, 8(%r15)\n"
+    MPK_ASM_PROBE(gate_exit, "8@%rax")
+    "  movq 8(%rsp), %rsp\n"
+    "  retq\n"
+    ".size __mpk_ffi_gate, .-__mpk_ffi_gate\n");
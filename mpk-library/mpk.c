@@ -1,6 +1,7 @@
 
 #include "mpk.h"
 #include "domain.h"
+#include "probes.h"
 #include <stdio.h>
 
 int INITIALIZING = 0;
@@ -36,41 +37,58 @@ int __pkey_set(int pkey, unsigned long rights, unsigned long flags) {
 void *mpk_malloc(size_t size) {
   ensure_initialized();
     TOTAL_HEAP += 1;
+  void *ptr;
   if (get_domain()) {
     UNSAFE_HEAP += 1;
-    return unsafe_allocator.malloc(size);
+    ptr = unsafe_allocator.malloc(size);
+    MPK_PROBE2(unsafe_alloc, ptr, size);
+    return ptr;
   }
 
   /* fprintf(stderr, "safe malloc\n"); */
-  return safe_allocator.malloc(size);
+  ptr = safe_allocator.malloc(size);
+  MPK_PROBE2(safe_alloc, ptr, size);
+  return ptr;
 }
 
 void *mpk_realloc(void *addr, size_t size) {
   ensure_initialized();
     TOTAL_HEAP += 1;
+  void *ptr;
   if ((size_t)addr < UNSAFE_END_ADDR && (size_t)addr > UNSAFE_START_ADDR) {
       UNSAFE_HEAP += 1;
-    return unsafe_allocator.realloc(addr, size);
+    ptr = unsafe_allocator.realloc(addr, size);
+    MPK_PROBE2(unsafe_alloc, ptr, size);
+    return ptr;
   }
-  return safe_allocator.realloc(addr, size);
+  ptr = safe_allocator.realloc(addr, size);
+  MPK_PROBE2(safe_alloc, ptr, size);
+  return ptr;
 }
 
 void *mpk_calloc(size_t num, size_t size) {
   ensure_initialized();
     TOTAL_HEAP += num;
+  void *ptr;
   if (get_domain()) {
       UNSAFE_HEAP += num;
-    return unsafe_allocator.calloc(num, size);
+    ptr = unsafe_allocator.calloc(num, size);
+    MPK_PROBE2(unsafe_alloc, ptr, num * size);
+    return ptr;
   }
 
-  return safe_allocator.calloc(num, size);
+  ptr = safe_allocator.calloc(num, size);
+  MPK_PROBE2(safe_alloc, ptr, num * size);
+  return ptr;
 }
 
 void mpk_free(void *addr) {
   ensure_initialized();
   if (!((size_t)addr < UNSAFE_END_ADDR && (size_t)addr > UNSAFE_START_ADDR)) {
+     MPK_PROBE1(safe_free, addr);
      safe_allocator.free(addr);
   } else{
+    MPK_PROBE1(unsafe_free, addr);
     unsafe_allocator.free(addr);
   }
 }
@@ -110,6 +128,7 @@ void *__get_domain_ptr() {
 size_t SFI_EXCEPTION = 0;
 void __sfi_exception() {
   SFI_EXCEPTION++;
+  MPK_PROBE1(sfi_exception, __builtin_return_address(0));
   return;
 }
 
@@ -117,16 +136,22 @@ uint8_t *__mpk_unsafe__rust_alloc(uint64_t size, uint64_t align, uint8_t flag) {
     TOTAL_HEAP += 1;
   if (flag) {
       UNSAFE_HEAP += 1;
-    return unsafe_allocator.malloc(size);
+    uint8_t *ptr = unsafe_allocator.malloc(size);
+    MPK_PROBE2(unsafe_alloc, ptr, size);
+    return ptr;
   } else {
-    return safe_allocator.malloc(size);
+    uint8_t *ptr = safe_allocator.malloc(size);
+    MPK_PROBE2(safe_alloc, ptr, size);
+    return ptr;
   }
 }
 
 void __mpk_unsafe__rust_dealloc(uint8_t *ptr, uint64_t size, uint64_t align) {
   if ((size_t)ptr < UNSAFE_END_ADDR && (size_t)ptr > UNSAFE_START_ADDR) {
+    MPK_PROBE1(unsafe_free, ptr);
     return unsafe_allocator.free(ptr);
   }
+  MPK_PROBE1(safe_free, ptr);
   safe_allocator.free(ptr);
 }
 
@@ -134,9 +159,13 @@ uint8_t *__mpk_unsafe__rdl_alloc(uint64_t size, uint64_t align, uint8_t flag) {
     TOTAL_HEAP += 1;
     if (flag) {
         UNSAFE_HEAP += 1;
-        return unsafe_allocator.malloc(size);
+        uint8_t *ptr = unsafe_allocator.malloc(size);
+        MPK_PROBE2(unsafe_alloc, ptr, size);
+        return ptr;
     } else {
-        return safe_allocator.malloc(size);
+        uint8_t *ptr = safe_allocator.malloc(size);
+        MPK_PROBE2(safe_alloc, ptr, size);
+        return ptr;
     }
 }
 
@@ -145,9 +174,13 @@ uint8_t *__mpk_unsafe__rdl_alloc_zeroed(uint64_t size, uint64_t align,
     TOTAL_HEAP += 1;
     if (flag) {
         UNSAFE_HEAP += 1;
-        return unsafe_allocator.calloc((size + align) / align, align);
+        uint8_t *ptr = unsafe_allocator.calloc((size + align) / align, align);
+        MPK_PROBE2(unsafe_alloc, ptr, size);
+        return ptr;
     }else {
-        return safe_allocator.calloc((size + align) / align, align);
+        uint8_t *ptr = safe_allocator.calloc((size + align) / align, align);
+        MPK_PROBE2(safe_alloc, ptr, size);
+        return ptr;
     }
 }
 
@@ -157,15 +190,21 @@ uint8_t *__mpk_unsafe__rdl_realloc(uint8_t *ptr, uint64_t old_size,
     TOTAL_HEAP += 1;
     if ((size_t)ptr < UNSAFE_END_ADDR && (size_t)ptr > UNSAFE_START_ADDR) {
         UNSAFE_HEAP += 1;
-        return unsafe_allocator.realloc(ptr, new_size);
+        uint8_t *new_ptr = unsafe_allocator.realloc(ptr, new_size);
+        MPK_PROBE2(unsafe_alloc, new_ptr, new_size);
+        return new_ptr;
     }
-    return safe_allocator.realloc(ptr, new_size);
+    uint8_t *new_ptr = safe_allocator.realloc(ptr, new_size);
+    MPK_PROBE2(safe_alloc, new_ptr, new_size);
+    return new_ptr;
 }
 
 void __mpk_unsafe__rdl_dealloc(uint8_t *ptr, uint64_t size, uint64_t align) {
     if ((size_t)ptr < UNSAFE_END_ADDR && (size_t)ptr > UNSAFE_START_ADDR) {
+        MPK_PROBE1(unsafe_free, ptr);
         return unsafe_allocator.free(ptr);
     }
+    MPK_PROBE1(safe_free, ptr);
     safe_allocator.free(ptr);
 }
 uint8_t *__mpk_unsafe__rust_realloc(uint8_t *ptr, uint64_t old_size,
@@ -174,9 +213,13 @@ uint8_t *__mpk_unsafe__rust_realloc(uint8_t *ptr, uint64_t old_size,
     TOTAL_HEAP += 1;
   if ((size_t)ptr < UNSAFE_END_ADDR && (size_t)ptr > UNSAFE_START_ADDR) {
       UNSAFE_HEAP += 1;
-    return unsafe_allocator.realloc(ptr, new_size);
+    uint8_t *new_ptr = unsafe_allocator.realloc(ptr, new_size);
+    MPK_PROBE2(unsafe_alloc, new_ptr, new_size);
+    return new_ptr;
   }
-  return safe_allocator.realloc(ptr, new_size);
+  uint8_t *new_ptr = safe_allocator.realloc(ptr, new_size);
+  MPK_PROBE2(safe_alloc, new_ptr, new_size);
+  return new_ptr;
 }
 uint8_t *__mpk_unsafe__rust_alloc_zeroed(uint64_t size, uint64_t align,
                                          uint8_t flag) {
@@ -184,9 +227,13 @@ uint8_t *__mpk_unsafe__rust_alloc_zeroed(uint64_t size, uint64_t align,
     TOTAL_HEAP += 1;
   if (flag) {
       UNSAFE_HEAP += 1;
-    return unsafe_allocator.calloc((size + align) / align, align);
+    uint8_t *ptr = unsafe_allocator.calloc((size + align) / align, align);
+    MPK_PROBE2(unsafe_alloc, ptr, size);
+    return ptr;
   }else {
-      return safe_allocator.calloc((size + align) / align, align);
+      uint8_t *ptr = safe_allocator.calloc((size + align) / align, align);
+      MPK_PROBE2(safe_alloc, ptr, size);
+      return ptr;
   }
 }
 
@@ -30,6 +30,8 @@ void __mpk_unsafe__rdl_dealloc(uint8_t *ptr, uint64_t size, uint64_t align);
 
 void __mpk_exit();
 void __mpk_entry();
+void __mpk_ffi_tail_gate();
+void __mpk_ffi_gate();
 void __sfi_exception();
 void *__get_domain_ptr();
 static inline void __wrpkru(unsigned int pkru);
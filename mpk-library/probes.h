@@ -0,0 +1,65 @@
+//
+// USDT probes of the MPK runtime (provider "mpk"), listed with
+//   perf list 'sdt_mpk:*'   or   bpftrace -l 'usdt:libmpk.so:mpk:*'
+//
+// A probe is a single NOP plus an entry in .note.stapsdt until a tracer
+// attaches to it. Built with -DMPK_USDT, which CMake sets when sys/sdt.h is
+// available; otherwise the probes compile to nothing.
+//
+//   gate_enter(callee)                 shared FFI gates, before WRPKRU
+//   gate_exit(retval)                  shared FFI gates, back in the safe domain
+//   domain_switch(old, new)            set_domain_value
+//   safe_alloc/unsafe_alloc(ptr, size)
+//   safe_free/unsafe_free(ptr)
+//   extern_stack_alloc(bottom, size, reused)
+//   extern_stack_release(bottom, tid)  owner thread exiting
+//   thread_hook(domain_ptr, domain, start_routine)
+//   sfi_exception(return_address)
+//
+
+#ifndef MPK_LIBRARY_PROBES_H
+#define MPK_LIBRARY_PROBES_H
+
+#ifdef MPK_USDT
+#include <sys/sdt.h>
+
+#define MPK_PROBE0(name)                STAP_PROBE(mpk, name)
+#define MPK_PROBE1(name, a)             STAP_PROBE1(mpk, name, a)
+#define MPK_PROBE2(name, a, b)          STAP_PROBE2(mpk, name, a, b)
+#define MPK_PROBE3(name, a, b, c)       STAP_PROBE3(mpk, name, a, b, c)
+
+/* Probe for the assembly gates, which cannot use the C macros. args is a
+ * string of SDT argument specifiers, e.g. "8@56(%r15)". The note layout
+ * follows sys/sdt.h (version 3 notes). */
+#define MPK_ASM_PROBE(name, args)                                       \
+    "990: nop\n"                                                        \
+    ".pushsection .note.stapsdt,\"\",\"note\"\n"                        \
+    ".balign 4\n"                                                       \
+    ".4byte 992f-991f, 994f-993f, 3\n"                                  \
+    "991: .asciz \"stapsdt\"\n"                                         \
+    "992: .balign 4\n"                                                  \
+    "993: .8byte 990b\n"                                                \
+    ".8byte _.stapsdt.base\n"                                           \
+    ".8byte 0\n"                                                        \
+    ".asciz \"mpk\"\n"                                                  \
+    ".asciz \"" #name "\"\n"                                            \
+    ".asciz \"" args "\"\n"                                             \
+    "994: .balign 4\n"                                                  \
+    ".popsection\n"                                                     \
+    ".ifndef _.stapsdt.base\n"                                          \
+    ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+    ".weak _.stapsdt.base\n"                                            \
+    ".hidden _.stapsdt.base\n"                                          \
+    "_.stapsdt.base: .space 1\n"                                        \
+    ".size _.stapsdt.base, 1\n"                                         \
+    ".popsection\n"                                                     \
+    ".endif\n"
+#else
+#define MPK_PROBE0(name)
+#define MPK_PROBE1(name, a)
+#define MPK_PROBE2(name, a, b)
+#define MPK_PROBE3(name, a, b, c)
+#define MPK_ASM_PROBE(name, args) ""
+#endif
+
+#endif //MPK_LIBRARY_PROBES_H
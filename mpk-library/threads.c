@@ -3,8 +3,11 @@
 //
 
 #include "threads.h"
+#include "probes.h"
 /* hook function */
 pthread_create_t real_pthread_create = 0;
+pthread_join_t real_pthread_join = 0;
+pthread_detach_t real_pthread_detach = 0;
 
 static pthread_key_t DOMAIN_KEY;
 static pthread_once_t MPK_INITIALIZATION = PTHREAD_ONCE_INIT;
@@ -19,17 +22,21 @@ void init_domain_key(){
     if(pthread_setspecific(DOMAIN_KEY, domain)){
         DOMAIN_SET_ERROR
     }
+    __mpk_tls_domain = domain;
 }
 
 void init_threading_hooks(){
   real_pthread_create = dlsym(RTLD_NEXT, "pthread_create");
-  if(!real_pthread_create){
+  real_pthread_join = dlsym(RTLD_NEXT, "pthread_join");
+  real_pthread_detach = dlsym(RTLD_NEXT, "pthread_detach");
+  if(!real_pthread_create || !real_pthread_join || !real_pthread_detach){
     PTHREAD_HOOKING_ERROR
   }
 }
 
 static void mpk_initialization(){
     init_allocator_hooks();
+    init_extern_stacks();
     init_domain_key();
     init_threading_hooks();
     mi_process_init();
@@ -47,6 +54,7 @@ int get_domain(){
 
 void set_domain_value(int new_domain){
     domain_t* domain = pthread_getspecific(DOMAIN_KEY);
+    MPK_PROBE2(domain_switch, domain->domain, new_domain);
     domain->domain = new_domain;
     __pkey_set(DOMAIN_KEY, 0, 0); //dummy function call for measuring ovh.
     if(new_domain ==2 )
@@ -54,7 +62,9 @@ void set_domain_value(int new_domain){
 }
 
 domain_t *get_domain_ptr(){
-    domain_t *domain = pthread_getspecific(DOMAIN_KEY);
+    domain_t *domain = __mpk_tls_domain;
+    if(!domain)
+        domain = pthread_getspecific(DOMAIN_KEY);
     if(!domain)
         NO_DOMAIN_VALUE_ERROR
     if(!domain->extern_stack_ptr){
@@ -68,6 +78,9 @@ void* thread_hook(void* args){
 
     if(pthread_setspecific(DOMAIN_KEY, (domain_t*)data.temp_domain))
         DOMAIN_SET_ERROR
+    __mpk_tls_domain = NULL;
+    if(data.thread_stack)
+        native_stack_started(data.thread_stack);
 
     domain_t* domain;
     if(data.domain){
@@ -89,6 +102,8 @@ void* thread_hook(void* args){
     if(pthread_setspecific(DOMAIN_KEY, domain)){
         DOMAIN_SET_ERROR
     }
+    __mpk_tls_domain = domain;
+    MPK_PROBE3(thread_hook, domain, data.domain, data.orig_func);
     asm("mov %0, %%r15;"
         ::"r" (domain)
         :"%r15");
@@ -115,10 +130,12 @@ int pthread_create(pthread_t *restrict thread, const pthread_attr_t *restrict at
     thread_data->orig_func = routine;
     thread_data->domain = get_domain();
     thread_data->temp_domain = mpk_malloc(sizeof(domain_t));
+    thread_data->thread_stack = NULL;
     ((domain_t*)thread_data->temp_domain)->domain = thread_data->domain;
     size_t stack_size;
     pthread_attr_t temp_attr;
     void* stack_addr;
+    int detach_state = PTHREAD_CREATE_JOINABLE;
     if(thread_data->domain) {
         /* fprintf(stderr, "external, temp_attr %p\n"); */
 
@@ -132,13 +149,44 @@ int pthread_create(pthread_t *restrict thread, const pthread_attr_t *restrict at
 
         /* fprintf(stderr,"assigned stack size: 0x%lx, addr: %p\n",stack_size, stack_addr); */
         stack_size = stack_size > DEFAULT_STACK_SIZE? stack_size: DEFAULT_STACK_SIZE;
-       void *stack = __allocate_extern_stack(DEFAULT_STACK_SIZE);
-       //fprintf(stderr,"New thread stack = %p\n", stack);
-       pthread_attr_setstack(&temp_attr, stack, DEFAULT_STACK_SIZE);
+       if(attr)
+           pthread_attr_getdetachstate(attr, &detach_state);
+       pthread_attr_setdetachstate(&temp_attr, detach_state);
+       /* freed after the thread is joined, or gone if detached */
+       thread_data->thread_stack = native_stack_create(stack_size);
+       pthread_attr_setstack(&temp_attr, extern_stack_bottom(thread_data->thread_stack), stack_size);
        attr = &temp_attr;
     }
+    extern_stack_t *thread_stack = thread_data->thread_stack;
+    if(thread_stack)
+        native_stack_add_joinable(thread_stack);
     int _return = real_pthread_create(thread, attr, thread_hook, thread_data);
     /* fprintf(stderr, "Thread created\n"); */
+    if(thread_stack){
+        if(_return)
+            native_stack_destroy(thread_stack);
+        else{
+            native_stack_set_owner(thread_stack, *thread);
+            if(detach_state == PTHREAD_CREATE_DETACHED)
+                native_stack_release_detached(*thread);
+        }
+    }
+    return _return;
+}
+
+int pthread_join(pthread_t thread, void **retval){
+    ensure_initialized();
+    int _return = real_pthread_join(thread, retval);
+    if(!_return)
+        native_stack_release_joined(thread);
+    return _return;
+}
+
+int pthread_detach(pthread_t thread){
+    ensure_initialized();
+    int _return = real_pthread_detach(thread);
+    if(!_return)
+        native_stack_release_detached(thread);
     return _return;
 }
 
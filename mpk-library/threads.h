@@ -6,16 +6,20 @@
 #define MPK_LIBRARY_THREADS_H
 
 #include "allocator.h"
+#include "extern_stack.h"
 
 typedef struct thread_data{
     int domain;
     void* (*orig_func)(void*);
     void* orig_args;
     void* temp_domain;
+    extern_stack_t* thread_stack;   // native stack of an extern-domain thread, freed after join
 } thread_data_t;
 
 void init_threading_hooks();
 void free_domain_data(void*);
 void *thread_hook(void* args);
 typedef int (*pthread_create_t)(pthread_t* restrict, const pthread_attr_t* restrict, void*(*)(void*), void* restrict);
+typedef int (*pthread_join_t)(pthread_t, void**);
+typedef int (*pthread_detach_t)(pthread_t);
 #endif //MPK_LIBRARY_THREADS_H
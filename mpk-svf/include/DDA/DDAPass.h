@@ -75,6 +75,9 @@ public:
 
     void findUnsafePointers(PointerAnalysis* _pta,SVFG* svfg, PAG* pag, const SVFModule* svfModule);
 
+    /// Whether a PAG node is a pointer that code marked MPK-Unsafe defines or uses
+    static bool isUnsafePointer(const PAGNode* node);
+
 private:
     /// Print queries' pts
     void printQueryPTS();
@@ -0,0 +1,88 @@
+/*
+ * @file: DDAServer.h
+ *
+ * Long-running demand-driven analysis server
+ */
+
+#ifndef DDASERVER_H_
+#define DDASERVER_H_
+
+#include "DDA/ContextDDA.h"
+#include "DDA/DDAClient.h"
+
+namespace SVF
+{
+
+/*!
+ * Keeps the PAG, SVFG and the context-sensitive DDA query caches of a program
+ * in memory and answers queries over a local Unix socket.
+ *
+ * Requests are a 1-byte opcode, a 4-byte payload length and the payload.
+ * Responses are a 1-byte status, a 4-byte payload length and the payload.
+ * Integers are host-endian u32_t.
+ */
+class DDAServer
+{
+public:
+    enum Opcode
+    {
+        OpLookup = 1,   ///< "function\0value" or "\0global" -> node id
+        OpPointsTo = 2, ///< node id -> count, object node ids
+        OpAlias = 3,    ///< node id, node id -> AliasResult
+        OpUnsafe = 4,   ///< node id -> 1 if a pointee is accessed by unsafe code
+        OpName = 5,     ///< node id -> name of its value
+        OpReload = 6,   ///< reread the bitcode files -> number of changed functions
+        OpShutdown = 7,
+    };
+
+    enum Status
+    {
+        StatusOk = 0,
+        StatusError = 1,
+    };
+
+    typedef Map<std::string, size_t> FunctionHashMap;
+
+    /// Requests are names and node ids; anything longer is rejected
+    static const u32_t MaxRequestLen = 1 << 16;
+
+    DDAServer(const std::vector<std::string>& names);
+    ~DDAServer();
+
+    /// Serve clients of the same user on socketPath (mode 0600) until an
+    /// OpShutdown request
+    bool serve(const std::string& socketPath);
+
+    /// Socket in the per-user runtime directory, empty if there is none
+    static std::string getDefaultSocketPath();
+
+private:
+    std::vector<std::string> moduleNames;
+    SVFModule* svfModule;
+    DDAClient* client;
+    ContextDDA* dda;
+    FunctionHashMap functionHashes;
+    Map<NodeID, PointsTo> ptsCache;
+    PointsTo unsafeObjs;
+    bool unsafeObjsBuilt;
+
+    /// Build the PAG, Andersen's analysis and the SVFG
+    void build();
+    /// Release everything build() created
+    void release();
+
+    /// Fingerprint the function bodies of the bitcode files as they are on disk
+    bool hashModules(FunctionHashMap& hashes) const;
+
+    const PointsTo& getPts(NodeID id);
+    const PointsTo& getUnsafeObjs();
+    bool isValidNode(NodeID id) const;
+
+    /// Answer a request, returns false once the server should exit
+    bool handle(u32_t op, const std::string& req, u32_t& status, std::string& resp);
+    bool handleClient(int fd);
+};
+
+} // End namespace SVF
+
+#endif /* DDASERVER_H_ */
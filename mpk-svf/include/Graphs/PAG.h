@@ -75,6 +75,7 @@ public:
     typedef std::pair<NodeID, LocationSet> NodeLocationSet;
     typedef Map<NodeOffset,NodeID> NodeOffsetMap;
     typedef Map<NodeLocationSet,NodeID> NodeLocationSetMap;
+    typedef Map<NodeID, NodeVector> GepObjNodeTable;
     typedef Map<const Value*, NodeLocationSetMap> GepValPNMap;
     typedef Map<NodePair,NodeID> NodePairSetMap;
     typedef Map<const PAGNode*, std::pair<const InsertValPE*, const CopyPE*>> InsertValMap;
@@ -90,6 +91,7 @@ private:
     Inst2PAGEdgesMap inst2PTAPAGEdgesMap;	///< Map a instruction to its PointerAnalysis related PAGEdges
     GepValPNMap GepValNodeMap;	///< Map a pair<base,off> to a gep value node id
     NodeLocationSetMap GepObjNodeMap;	///< Map a pair<base,off> to a gep obj node id
+    GepObjNodeTable gepObjNodeTable;	///< Map a base obj to its gep obj node ids indexed by plain field offset (0 if absent)
     MemObjToFieldsMap memToFieldsMap;	///< Map a mem object id to all its fields
     PAGEdgeSet globPAGEdgesSet;	///< Global PAGEdges without control flow information
     PHINodeMap phiNodeMap;	///< A set of phi copy edges
@@ -135,6 +137,25 @@ public:
         return GepObjNodeMap;
     }
 
+    /// Whether ls is a plain non-negative field offset (no strides, byte offset equal to field offset),
+    /// i.e. one that getModulusOffset produces under the field-index memory model
+    static inline bool isPlainFieldOffset(const LocationSet& ls)
+    {
+        return ls.isConstantOffset() && ls.getOffset() >= 0 && ls.getByteOffset() == ls.getOffset();
+    }
+
+    /// Remove the gep obj node of <base,ls> from GepObjNodeMap and the direct field table
+    inline void removeGepObjNodeEntry(NodeID base, const LocationSet& ls)
+    {
+        GepObjNodeMap.erase(std::make_pair(base, ls));
+        if (isPlainFieldOffset(ls))
+        {
+            GepObjNodeTable::iterator it = gepObjNodeTable.find(base);
+            if (it != gepObjNodeTable.end() && (u32_t) ls.getOffset() < it->second.size())
+                it->second[ls.getOffset()] = 0;
+        }
+    }
+
     inline InsertValMap& getInsertValCopyMap(){
         return insertValMap;
     }
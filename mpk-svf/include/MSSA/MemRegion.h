@@ -166,11 +166,9 @@ public:
     //@{
     /// Map a function to its indirect refs/mods of memory objects
     typedef Map<const SVFFunction*, NodeBS> FunToNodeBSMap;
-    /// Map a callsite to its indirect refs/mods of memory objects
-    typedef Map<const CallBlockNode*, NodeBS> CallSiteToNodeBSMap;
     //@}
 
-    typedef Map<NodeID, NodeBS> NodeToPTSSMap;
+    typedef Map<NodeID, PointsTo> NodeToPTSSMap;
 
     /// PAG edge list
     typedef PAG::PAGEdgeList PAGEdgeList;
@@ -228,13 +226,13 @@ private:
     /// Map a function to its indirect defs of memory objects
     FunToNodeBSMap funToModsMap;
     /// Map a callsite to its indirect uses of memory objects
-    CallSiteToNodeBSMap csToRefsMap;
+    CallSiteToPointsToMap csToRefsMap;
     /// Map a callsite to its indirect defs of memory objects
-    CallSiteToNodeBSMap csToModsMap;
+    CallSiteToPointsToMap csToModsMap;
     /// Map a callsite to all its object might pass into its callees
-    CallSiteToNodeBSMap csToCallSiteArgsPtsMap;
+    CallSiteToPointsToMap csToCallSiteArgsPtsMap;
     /// Map a callsite to all its object might return from its callees
-    CallSiteToNodeBSMap csToCallSiteRetPtsMap;
+    CallSiteToPointsToMap csToCallSiteRetPtsMap;
 
     /// Map a pointer to its cached points-to chain;
     NodeToPTSSMap cachedPtsChainMap;
@@ -249,15 +247,15 @@ private:
     void collectCallSitePts(const CallBlockNode* cs);
 
     //Recursive collect points-to chain
-    NodeBS& CollectPtsChain(NodeID id);
+    PointsTo& CollectPtsChain(NodeID id);
 
     /// Return the pts chain of all callsite arguments
-    inline NodeBS& getCallSiteArgsPts(const CallBlockNode* cs)
+    inline PointsTo& getCallSiteArgsPts(const CallBlockNode* cs)
     {
         return csToCallSiteArgsPtsMap[cs];
     }
     /// Return the pts chain of the return parameter of the callsite
-    inline NodeBS& getCallSiteRetPts(const CallBlockNode* cs)
+    inline PointsTo& getCallSiteRetPts(const CallBlockNode* cs)
     {
         return csToCallSiteRetPtsMap[cs];
     }
@@ -266,7 +264,7 @@ private:
     bool isNonLocalObject(NodeID id, const SVFFunction* curFun) const;
 
     /// Get all the objects in callee's modref escaped via global objects (the chain pts of globals)
-    void getEscapObjviaGlobals(NodeBS& globs, const NodeBS& pts);
+    void getEscapObjviaGlobals(PointsTo& globs, const NodeBS& pts);
 
     /// Get reverse topo call graph scc
     void getCallGraphSCCRevTopoOrder(WorkList& worklist);
@@ -381,9 +379,9 @@ protected:
     /// Add/Get methods for side-effect of functions and callsites
     //@{
     /// Add indirect uses an memory object in the function
-    void addRefSideEffectOfFunction(const SVFFunction* fun, const NodeBS& refs);
+    void addRefSideEffectOfFunction(const SVFFunction* fun, const PointsTo& refs);
     /// Add indirect def an memory object in the function
-    void addModSideEffectOfFunction(const SVFFunction* fun, const NodeBS& mods);
+    void addModSideEffectOfFunction(const SVFFunction* fun, const PointsTo& mods);
     /// Add indirect uses an memory object in the function
     bool addRefSideEffectOfCallSite(const CallBlockNode* cs, const NodeBS& refs);
     /// Add indirect def an memory object in the function
@@ -400,12 +398,12 @@ protected:
         return funToModsMap[fun];
     }
     /// Get indirect refs of a callsite
-    inline const NodeBS& getRefSideEffectOfCallSite(const CallBlockNode* cs)
+    inline const PointsTo& getRefSideEffectOfCallSite(const CallBlockNode* cs)
     {
         return csToRefsMap[cs];
     }
     /// Get indirect mods of a callsite
-    inline const NodeBS& getModSideEffectOfCallSite(const CallBlockNode* cs)
+    inline const PointsTo& getModSideEffectOfCallSite(const CallBlockNode* cs)
     {
         return csToModsMap[cs];
     }
@@ -10,6 +10,7 @@
 
 #include "MTA/TCT.h"
 #include "Util/SVFUtil.h"
+#include <mutex>
 namespace SVF
 {
 
@@ -32,6 +33,10 @@ public:
     typedef Map<CxtThreadStmt,NodeBS> ThreadStmtToThreadInterleav;
     typedef Map<const Instruction*,CxtThreadStmtSet> InstToThreadStmtSetMap;
 
+    /// Interned <thread, context id, statement> used while propagating a single root
+    typedef u32_t CxtID;
+    typedef std::pair<std::pair<NodeID,CxtID>,const Instruction*> ThreadStmtKey;
+
     typedef Set<CxtStmt> LockSpan;
 
     typedef std::pair<const Function*,const Function*> FuncPair;
@@ -115,6 +120,99 @@ public:
     void printInterleaving();
 
 private:
+
+    /*!
+     * Interleaving facts contributed by a single TCT root thread.
+     *
+     * Every fact seeded for a root only carries the root's own thread id, so the
+     * propagation of one root is a one-bit problem independent of all other roots.
+     * Contexts are interned to dense ids, and each statement reached maps to whether
+     * the root's bit is currently set (cleared bits come from must-join sites).
+     */
+    class RootInterleaving
+    {
+    public:
+        typedef Map<CallStrCxt,CxtID> CxtToIDMap;
+        typedef Map<ThreadStmtKey,bool> ThreadStmtToBitMap;
+        typedef FIFOWorkList<ThreadStmtKey> ThreadStmtKeyWorkList;
+
+        RootInterleaving(NodeID t) : rootTid(t)
+        {
+        }
+        inline NodeID getRootTid() const
+        {
+            return rootTid;
+        }
+        /// Intern the context of a thread statement
+        inline ThreadStmtKey getKey(const CxtThreadStmt& cts)
+        {
+            std::pair<CxtToIDMap::iterator,bool> res = cxtToID.insert(std::make_pair(cts.getContext(), (CxtID) idToCxt.size()));
+            if(res.second)
+                idToCxt.push_back(cts.getContext());
+            return std::make_pair(std::make_pair(cts.getTid(), res.first->second), cts.getStmt());
+        }
+        inline CxtThreadStmt getCxtThreadStmt(const ThreadStmtKey& key) const
+        {
+            return CxtThreadStmt(key.first.first, idToCxt[key.first.second], key.second);
+        }
+        /// Whether the root thread may interleave with cts
+        inline bool hasBit(const CxtThreadStmt& cts)
+        {
+            ThreadStmtToBitMap::const_iterator it = facts.find(getKey(cts));
+            return it!=facts.end() && it->second;
+        }
+        /// Set/clear the root's bit, pushing the statement if it changed
+        //@{
+        inline void setBit(const CxtThreadStmt& cts)
+        {
+            ThreadStmtKey key = getKey(cts);
+            bool& bit = facts[key];
+            if(!bit)
+            {
+                bit = true;
+                worklist.push(key);
+            }
+        }
+        inline void clearBit(const CxtThreadStmt& cts)
+        {
+            ThreadStmtKey key = getKey(cts);
+            ThreadStmtToBitMap::iterator it = facts.find(key);
+            if(it!=facts.end() && it->second)
+            {
+                it->second = false;
+                worklist.push(key);
+            }
+        }
+        //@}
+        inline bool empty() const
+        {
+            return worklist.empty();
+        }
+        inline CxtThreadStmt pop()
+        {
+            return getCxtThreadStmt(worklist.pop());
+        }
+        inline const ThreadStmtToBitMap& getFacts() const
+        {
+            return facts;
+        }
+
+    private:
+        NodeID rootTid;
+        CxtToIDMap cxtToID;
+        std::vector<CallStrCxt> idToCxt;
+        ThreadStmtToBitMap facts;
+        ThreadStmtKeyWorkList worklist;
+    };
+
+    /// Propagate the interleaving facts of one root thread to its fixpoint
+    void analyzeRootInterleaving(RootInterleaving& ri);
+
+    /// Merge the facts of a root thread into threadStmtToTheadInterLeav and instToTSMap
+    void mergeRootInterleaving(const RootInterleaving& ri);
+
+    /// Populate the lazily built ICFG call nodes and ExtAPI cache before roots run in parallel
+    void prepareParallelInterleaving();
 	
 	inline const PTACallGraph::FunctionSet& getCallee(const Instruction* inst, PTACallGraph::FunctionSet& callees) {
         tcg->getCallees(getCBN(inst), callees);
@@ -125,64 +223,49 @@ private:
     void updateNonCandidateFunInterleaving();
 
     /// Handle non-candidate function
-    void handleNonCandidateFun(const CxtThreadStmt& cts);
+    void handleNonCandidateFun(RootInterleaving& ri, const CxtThreadStmt& cts);
 
     /// Handle fork
-    void handleFork(const CxtThreadStmt& cts, NodeID rootTid);
+    void handleFork(RootInterleaving& ri, const CxtThreadStmt& cts);
 
     /// Handle join
-    void handleJoin(const CxtThreadStmt& cts, NodeID rootTid);
+    void handleJoin(RootInterleaving& ri, const CxtThreadStmt& cts);
 
     /// Handle call
-    void handleCall(const CxtThreadStmt& cts, NodeID rootTid);
+    void handleCall(RootInterleaving& ri, const CxtThreadStmt& cts);
 
     /// Handle return
-    void handleRet(const CxtThreadStmt& cts);
+    void handleRet(RootInterleaving& ri, const CxtThreadStmt& cts);
 
     /// Handle intra
-    void handleIntra(const CxtThreadStmt& cts);
+    void handleIntra(RootInterleaving& ri, const CxtThreadStmt& cts);
 
     /// Use RCResultValidator to validate mhp results
     void validateResults();
 
     /// Add/Remove interleaving thread for statement inst
     //@{
-    inline void addInterleavingThread(const CxtThreadStmt& tgr, NodeID tid)
+    inline void addInterleavingThread(RootInterleaving& ri, const CxtThreadStmt& tgr, NodeID tid)
     {
-        if(threadStmtToTheadInterLeav[tgr].test_and_set(tid))
-        {
-            instToTSMap[tgr.getStmt()].insert(tgr);
-            pushToCTSWorkList(tgr);
-        }
+        assert(tid == ri.getRootTid() && "only the root thread is propagated");
+        ri.setBit(tgr);
     }
-    inline void addInterleavingThread(const CxtThreadStmt& tgr, const CxtThreadStmt& src)
+    inline void addInterleavingThread(RootInterleaving& ri, const CxtThreadStmt& tgr, const CxtThreadStmt& src)
     {
-        bool changed = threadStmtToTheadInterLeav[tgr] |= threadStmtToTheadInterLeav[src];
-        if(changed)
-        {
-            instToTSMap[tgr.getStmt()].insert(tgr);
-            pushToCTSWorkList(tgr);
-        }
+        if(ri.hasBit(src))
+            ri.setBit(tgr);
     }
-    inline void rmInterleavingThread(const CxtThreadStmt& tgr, const NodeBS& tids, const Instruction* joinsite)
+    inline void rmInterleavingThread(RootInterleaving& ri, const CxtThreadStmt& tgr, const NodeBS& tids, const Instruction* joinsite)
     {
-        NodeBS joinedTids;
-        for(NodeBS::iterator it = tids.begin(), eit = tids.end(); it!=eit; ++it)
-        {
-            if(isMustJoin(tgr.getTid(),joinsite))
-                joinedTids.set(*it);
-        }
-        if(threadStmtToTheadInterLeav[tgr].intersectWithComplement(joinedTids))
-        {
-            pushToCTSWorkList(tgr);
-        }
+        if(tids.test(ri.getRootTid()) && isMustJoin(tgr.getTid(),joinsite))
+            ri.clearBit(tgr);
     }
     //@}
 
     /// Update Ancestor and sibling threads
     //@{
-    void updateAncestorThreads(NodeID tid);
-    void updateSiblingThreads(NodeID tid);
+    void updateAncestorThreads(RootInterleaving& ri);
+    void updateSiblingThreads(RootInterleaving& ri);
     //@}
 
     /// Thread curTid can be fully joined by parentTid recurively
@@ -213,18 +296,6 @@ private:
         return tct->matchCxt(cxt,call,callee);
     }
 
-    /// WorkList helper functions
-    //@{
-    inline bool pushToCTSWorkList(const CxtThreadStmt& cs)
-    {
-        return cxtStmtList.push(cs);
-    }
-    inline CxtThreadStmt popFromCTSWorkList()
-    {
-        CxtThreadStmt ctp = cxtStmtList.pop();
-        return ctp;
-    }
-
     /// Whether it is a fork site
     inline bool isTDFork(const Instruction* call)
     {
@@ -248,10 +319,10 @@ private:
     ThreadCallGraph* tcg;				///< TCG
     TCT* tct;							///< TCT
     ForkJoinAnalysis* fja;				///< ForJoin Analysis
-    CxtThreadStmtWorkList cxtStmtList;	///< CxtThreadStmt worklist
     ThreadStmtToThreadInterleav threadStmtToTheadInterLeav; /// Map a statement to its thread interleavings
     InstToThreadStmtSetMap instToTSMap; ///< Map an instruction to its ThreadStmtSet
     FuncPairToBool nonCandidateFuncMHPRelMap;
+    std::mutex joinedTidMutex;			///< Guards the lazily cached joined thread ids of fja
 
 
 public:
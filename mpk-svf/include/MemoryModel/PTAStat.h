@@ -118,6 +118,15 @@ public:
 
     static const char* NumOfNullPointer;	///< Number of pointers points-to null
 
+    static const char* NumOfBddVars;	///< Number of BDD variables (branch conditions)
+    static const char* NumOfBddNodes;	///< Number of BDD nodes
+    static const char* MaxNumOfLiveBddNodes;	///< Peak number of live BDD nodes
+    static const char* NumOfBddCacheSlots;	///< Number of BDD computed table slots
+    static const char* NumOfBddGC;	///< Number of BDD garbage collections
+    static const char* NumOfBddReorder;	///< Number of BDD variable reorderings
+    static const char* BddGCTime;	///< Time of BDD garbage collections
+    static const char* BddReorderTime;	///< Time of BDD variable reorderings
+
     typedef Map<const char*,u32_t> NUMStatMap;
 
     typedef Map<const char*,double> TIMEStatMap;
@@ -159,6 +168,8 @@ public:
     virtual void printStatPerQuery(NodeID, const PointsTo&) {}
 
     virtual void callgraphStat();
+
+    virtual void bddStat();
 private:
     void bitcastInstStat();
     void branchStat();
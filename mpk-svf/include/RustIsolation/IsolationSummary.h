@@ -0,0 +1,74 @@
+#ifndef _MPK_ISOLATION_SUMMARY_H
+#define _MPK_ISOLATION_SUMMARY_H
+
+#include "Util/BasicTypes.h"
+
+using namespace SVF;
+
+/*!
+ * Isolation summary of an exported function of a library crate, computed once
+ * when the crate is compiled (-mpk-emit-summary) and stored next to its rlib.
+ * Parameter masks are indexed by argument number; functions with more than 64
+ * arguments are never summarized.
+ */
+struct IsolationSummary
+{
+    enum Flags
+    {
+        RetAlloc = 1 << 0,      ///< returns or publishes heap memory allocated inside, so the caller context decides its domain
+        RetUnsafe = 1 << 1,     ///< returns memory that unsafe code in the crate accesses
+        LocalUnsafe = 1 << 2,   ///< contains allocation sites that unsafe code in the crate accesses
+        IndirectCalls = 1 << 3, ///< may call through function pointers
+        UnknownOrigin = 1 << 4, ///< returns, publishes or lets unsafe code access memory it got neither from its parameters nor from its own allocations (globals, memory loaded through pointers)
+    };
+
+    u64_t unsafeParams = 0;     ///< pointees of these parameters may flow to unsafe code
+    u64_t retParams = 0;        ///< the return value may point into these parameters
+    u64_t storedParams = 0;     ///< these parameters may be stored into non-local memory
+    u32_t flags = 0;
+
+    /// Whether the analysis of the final program loses nothing if the body is
+    /// skipped: no pointer flows out of the function and no allocation inside
+    /// it depends on the caller.
+    inline bool isSelfContained() const
+    {
+        return retParams == 0 && storedParams == 0 && flags == 0;
+    }
+
+    inline bool operator==(const IsolationSummary& rhs) const
+    {
+        return unsafeParams == rhs.unsafeParams && retParams == rhs.retParams &&
+               storedParams == rhs.storedParams && flags == rhs.flags;
+    }
+};
+
+typedef Map<std::string, IsolationSummary> IsolationSummaryMap;
+
+/// Summaries loaded with -mpk-summaries, by function name
+extern IsolationSummaryMap LoadedIsolationSummaries;
+
+/// Load the comma separated summary files given with -mpk-summaries
+void loadIsolationSummaries();
+
+/// Compute the summaries of the exported functions of the modules and write
+/// them to the -mpk-emit-summary file
+void emitIsolationSummaries(const std::vector<std::reference_wrapper<Module>>& modules);
+
+/// Take the bodies of self-contained summarized functions out of the analysis
+/// and add their parameter effects at the call sites of M
+void applyIsolationSummaries(Module& M);
+
+/// Take the bodies of functions out of the analysis when the representative of
+/// their structural class (see StructuralHash.h) has a self-contained summary;
+/// the representatives are still analyzed
+void shareStructuralSummaries(const std::vector<std::reference_wrapper<Module>>& modules);
+
+/// Put the bodies taken out by applyIsolationSummaries and
+/// shareStructuralSummaries back before the modules are written
+void restoreSummarizedBodies();
+
+/// Put the bodies back and forget the loaded summaries before the modules are
+/// released, so that the next modules start over
+void releaseIsolationSummaries();
+
+#endif
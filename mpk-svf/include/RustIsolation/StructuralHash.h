@@ -0,0 +1,25 @@
+#ifndef _MPK_STRUCTURAL_HASH_H
+#define _MPK_STRUCTURAL_HASH_H
+
+#include "Util/BasicTypes.h"
+
+using namespace SVF;
+
+/*!
+ * Monomorphization gives every instantiation of a generic function (e.g.,
+ * Vec<T>::push for each T) its own body. The bodies differ only in type
+ * names, type sizes and size constants, none of which the isolation summaries
+ * depend on. Functions are grouped by a hash of their bodies that leaves those
+ * out; callees are compared by their own group, refined until the grouping is
+ * stable, so two functions only share a group if everything they call does.
+ * Hash-equal functions are then compared body by body, leaving out the same
+ * details, so a hash collision never lets a function share a summary.
+ */
+typedef Map<const Function*, const Function*> StructuralClassMap;
+
+/// Map every defined function of the modules to the first function (in module
+/// order) of its structural class
+void computeStructuralClasses(const std::vector<std::reference_wrapper<Module>>& modules,
+                              StructuralClassMap& representatives);
+
+#endif
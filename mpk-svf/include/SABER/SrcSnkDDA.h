@@ -109,6 +109,8 @@ public:
     virtual void finalize()
     {
         dumpSlices();
+        if(Options::PStat)
+            printBDDStat();
     }
 
     /// Get PAG
@@ -258,6 +260,8 @@ protected:
     }
     /// Propagate information forward by matching context
     virtual void FWProcessOutgoingEdge(const DPIm& item, SVFGEdge* edge);
+    /// Match the context of newItem along edge, return false if it should not be propagated
+    bool propagateForward(ProgSlice* slice, const SVFGEdge* edge, DPIm& newItem);
     /// Propagate information backward without matching context, as forward analysis already did it
     virtual void BWProcessIncomingEdge(const DPIm& item, SVFGEdge* edge);
     /// Whether has been visited or not, in order to avoid recursion on SVFG
@@ -306,6 +310,14 @@ protected:
     void printBDDStat();
     //@}
 
+    /// Source-parallel checking (-saber-threads)
+    /// Slices are computed by worker threads with their own visited sets, while
+    /// guards (BDDs) are solved and bugs reported in source order on this thread.
+    //@{
+    void analyzeSourcesInParallel(u32_t numThreads);
+    void sliceSource(ProgSlice* slice);
+    //@}
+
 };
 
 } // End namespace SVF
@@ -73,12 +73,7 @@ public:
         return llvmModuleSet;
     }
 
-    static void releaseLLVMModuleSet()
-    {
-        if (llvmModuleSet)
-            delete llvmModuleSet;
-        llvmModuleSet = nullptr;
-    }
+    static void releaseLLVMModuleSet();
 
     SVFModule* buildSVFModule(Module &mod);
     SVFModule* buildSVFModule(const std::vector<std::string> &moduleNameVec);
@@ -230,7 +225,9 @@ public:
 
 private:
     void loadModules(const std::vector<std::string> &moduleNameVec);
+    void materializeReachableFunctions();
     void addSVFMain();
+    void loadProfile();
     void initialize();
     void buildFunToFunMap();
     void buildGlobalDefToRepMap();
@@ -132,6 +132,9 @@ public:
     /// Handle indirect call
     void handleIndCall(CallSite cs);
 
+    /// Handle the spawnee of a thread fork call
+    void handleForkCall(const Instruction* inst);
+
     /// Handle external call
     //@{
     virtual void handleExtCall(CallSite cs, const SVFFunction *F);
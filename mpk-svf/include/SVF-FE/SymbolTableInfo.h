@@ -56,6 +56,7 @@ public:
     typedef OrderedMap<SymID,SYMTYPE> IDToSymTyMapTy;
     /// struct type to struct info map
     typedef OrderedMap<const Type*, StInfo*> TypeToFieldInfoMap;
+    typedef Map<const Type*, StInfo*> TypeToStInfoCache;
     typedef Set<CallSite> CallSiteSet;
     typedef OrderedMap<const Instruction*,CallSiteID> CallSiteToIDMapTy;
     typedef OrderedMap<CallSiteID,const Instruction*> IDToCallSiteMapTy;
@@ -381,36 +382,43 @@ public:
     }
 
     ///Get a reference to StructInfo.
+    /// Hot GEP/field queries go through the hashed stInfoCache first and only
+    /// fall back to the ordered typeToFieldInfo map (and lazy collection) on a miss.
     inline StInfo* getStructInfo(const Type *T)
     {
-        return getStructInfoIter(T)->second;
+        TypeToStInfoCache::const_iterator it = stInfoCache.find(T);
+        if (it != stInfoCache.end())
+            return it->second;
+        StInfo* stInfo = getStructInfoIter(T)->second;
+        stInfoCache[T] = stInfo;
+        return stInfo;
     }
 
     ///Get a reference to the components of struct_info.
     const inline std::vector<u32_t>& getFattenFieldIdxVec(const Type *T)
     {
-        return getStructInfoIter(T)->second->getFieldIdxVec();
+        return getStructInfo(T)->getFieldIdxVec();
     }
     const inline std::vector<u32_t>& getFattenFieldOffsetVec(const Type *T)
     {
-        return getStructInfoIter(T)->second->getFieldOffsetVec();
+        return getStructInfo(T)->getFieldOffsetVec();
     }
     const inline std::vector<FieldInfo>& getFlattenFieldInfoVec(const Type *T)
     {
-        return getStructInfoIter(T)->second->getFlattenFieldInfoVec();
+        return getStructInfo(T)->getFlattenFieldInfoVec();
     }
     const inline Type* getOrigSubTypeWithFldInx(const Type* baseType, u32_t field_idx)
     {
-        return getStructInfoIter(baseType)->second->getFieldTypeWithFldIdx(field_idx);
+        return getStructInfo(baseType)->getFieldTypeWithFldIdx(field_idx);
     }
     const inline Type* getOrigSubTypeWithByteOffset(const Type* baseType, u32_t byteOffset)
     {
-        return getStructInfoIter(baseType)->second->getFieldTypeWithByteOffset(byteOffset);
+        return getStructInfo(baseType)->getFieldTypeWithByteOffset(byteOffset);
     }
 
     const inline bool enclosesPointer(const Type* T){
-        std::vector<FieldInfo> fI = getFlattenFieldInfoVec(T);
-        for(auto f: fI){
+        const std::vector<FieldInfo>& fI = getFlattenFieldInfoVec(T);
+        for(const FieldInfo& f: fI){
             if(f.getFlattenElemTy()->isPointerTy())
                 return true;
         }
@@ -453,6 +461,9 @@ protected:
     /// fsize[0] is always the size of the expanded struct.
     TypeToFieldInfoMap typeToFieldInfo;
 
+    /// Hashed view of typeToFieldInfo for constant-time layout lookups
+    TypeToStInfoCache stInfoCache;
+
     ///The struct type with the most fields
     const Type* maxStruct;
 
@@ -44,11 +44,8 @@ class BddCondManager
 {
 public:
 
-    /// Constructor
-    BddCondManager()
-    {
-        m_bdd_mgr = Cudd_Init(0, 0, CUDD_UNIQUE_SLOTS, CUDD_CACHE_SLOTS, 0);
-    }
+    /// Constructor, numVars and cacheSlots size the unique table and computed table up front
+    BddCondManager(u32_t numVars = 0, u32_t cacheSlots = CUDD_CACHE_SLOTS);
 
     /// Destructor
     ~BddCondManager()
@@ -86,6 +83,26 @@ public:
     {
         return Cudd_ReadPeakLiveNodeCount(m_bdd_mgr);
     }
+    inline u32_t getGCNumber()
+    {
+        return Cudd_ReadGarbageCollections(m_bdd_mgr);
+    }
+    inline double getGCTime()
+    {
+        return Cudd_ReadGarbageCollectionTime(m_bdd_mgr);
+    }
+    inline u32_t getReorderNumber()
+    {
+        return Cudd_ReadReorderings(m_bdd_mgr);
+    }
+    inline double getReorderTime()
+    {
+        return Cudd_ReadReorderingTime(m_bdd_mgr);
+    }
+    inline u32_t getCacheSlots()
+    {
+        return Cudd_ReadCacheSlots(m_bdd_mgr);
+    }
     inline void markForRelease(DdNode* cond)
     {
         Cudd_RecursiveDeref(m_bdd_mgr,cond);
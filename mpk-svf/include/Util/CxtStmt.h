@@ -465,8 +465,8 @@ template <> struct std::hash<SVF::CxtThreadProc> {
 };
 template <> struct std::hash<SVF::CxtThreadStmt> {
 	size_t operator()(const SVF::CxtThreadStmt& cts) const {
-		std::hash<SVF::NodeID> h;
-		return h(cts.getTid());
+		SVF::Hash<std::pair<SVF::NodeID, const SVF::Instruction*>> h;
+		return h(std::make_pair(cts.getTid(), cts.getStmt()));
 	}
 };
 template <> struct std::hash<SVF::CxtStmt> {
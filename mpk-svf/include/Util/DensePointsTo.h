@@ -0,0 +1,628 @@
+//===- DensePointsTo.h -- Hybrid inline/dense points-to set -------------------//
+
+/*
+ * DensePointsTo.h
+ *
+ * A drop-in alternative to llvm::SparseBitVector<> for points-to sets, enabled
+ * with SVF_DENSE_PTS. Small sets live in a sorted inline array. Larger sets are
+ * a contiguous word array over the range of IDs they cover, so unions,
+ * intersections and popcounts run over plain memory with SIMD kernels
+ * (selected at run time, see DensePointsTo.cpp). Sets spread so thinly over
+ * their range that most of the words would be zero fall back to an
+ * llvm::SparseBitVector.
+ */
+
+#ifndef INCLUDE_UTIL_DENSEPOINTSTO_H_
+#define INCLUDE_UTIL_DENSEPOINTSTO_H_
+
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/SparseBitVector.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace SVF
+{
+
+class DensePointsTo
+{
+public:
+    typedef uint64_t Word;
+    typedef unsigned ElemTy;
+
+    static const unsigned WordBits = 64;
+    /// Sets with more elements switch to the dense representation
+    static const unsigned InlineCap = 8;
+    /// Sets whose word array would span more words than SparseSpan times
+    /// their population switch to the sparse representation
+    static const unsigned SparseSpan = 8;
+
+    /// Word kernels, dispatched to AVX2, SSE4.1 or scalar code on first use
+    struct Kernels
+    {
+        /// dst |= src, returns whether dst changed
+        bool (*orWords)(Word* dst, const Word* src, unsigned n);
+        /// dst &= src, returns whether dst changed
+        bool (*andWords)(Word* dst, const Word* src, unsigned n);
+        /// dst &= ~src, returns whether dst changed
+        bool (*andNotWords)(Word* dst, const Word* src, unsigned n);
+        /// whether a & b has any bit set
+        bool (*intersectWords)(const Word* a, const Word* b, unsigned n);
+        /// whether sub & ~super has no bit set
+        bool (*subsetWords)(const Word* sub, const Word* super, unsigned n);
+        unsigned (*popcountWords)(const Word* a, unsigned n);
+    };
+    static const Kernels& getKernels();
+
+    enum KernelTier
+    {
+        ScalarKernels,
+        SSEKernels,
+        AVX2Kernels,
+    };
+    /// The kernels of one tier, nullptr when the build or the host lacks it
+    static const Kernels* getKernels(KernelTier tier);
+
+    class iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef ElemTy value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const ElemTy* pointer;
+        typedef const ElemTy& reference;
+
+        iterator(const DensePointsTo* p, bool atEnd) : pts(p), pos(0), cur(0), end(atEnd)
+        {
+            if (end)
+                return;
+            if (pts->rep == Sparse)
+            {
+                sit = pts->sparseBits.begin();
+                findSparse();
+            }
+            else
+                findFrom(0);
+        }
+        inline ElemTy operator*() const
+        {
+            return cur;
+        }
+        inline iterator& operator++()
+        {
+            if (pts->rep == Sparse)
+            {
+                ++sit;
+                ++pos;
+                findSparse();
+            }
+            else
+                findFrom(pos + 1);
+            return *this;
+        }
+        inline iterator operator++(int)
+        {
+            iterator it = *this;
+            ++*this;
+            return it;
+        }
+        inline bool operator==(const iterator& rhs) const
+        {
+            return end == rhs.end && (end || (pts == rhs.pts && pos == rhs.pos));
+        }
+        inline bool operator!=(const iterator& rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+    private:
+        const DensePointsTo* pts;
+        /// index into the inline array or the sparse elements, or bit offset
+        /// from the first word
+        unsigned pos;
+        ElemTy cur;
+        bool end;
+        llvm::SparseBitVector<>::iterator sit;
+
+        void findSparse()
+        {
+            end = sit == pts->sparseBits.end();
+            if (!end)
+                cur = *sit;
+        }
+
+        void findFrom(unsigned from)
+        {
+            if (pts->rep == Inline)
+            {
+                pos = from;
+                end = pos >= pts->small.size();
+                if (!end)
+                    cur = pts->small[pos];
+                return;
+            }
+            unsigned w = from / WordBits;
+            if (w < pts->words.size())
+            {
+                Word bits = pts->words[w] & (~Word(0) << (from % WordBits));
+                while (true)
+                {
+                    if (bits)
+                    {
+                        pos = w * WordBits + __builtin_ctzll(bits);
+                        cur = pts->base * WordBits + pos;
+                        return;
+                    }
+                    if (++w >= pts->words.size())
+                        break;
+                    bits = pts->words[w];
+                }
+            }
+            end = true;
+        }
+    };
+    typedef iterator const_iterator;
+
+    DensePointsTo() : base(0), rep(Inline) {}
+
+    DensePointsTo(const llvm::SparseBitVector<>& sbv) : base(0), rep(Inline)
+    {
+        for (ElemTy n : sbv)
+            set(n);
+    }
+
+    operator llvm::SparseBitVector<>() const
+    {
+        if (rep == Sparse)
+            return sparseBits;
+        llvm::SparseBitVector<> sbv;
+        for (ElemTy n : *this)
+            sbv.set(n);
+        return sbv;
+    }
+
+    inline iterator begin() const
+    {
+        return iterator(this, false);
+    }
+    inline iterator end() const
+    {
+        return iterator(this, true);
+    }
+
+    inline bool test(ElemTy n) const
+    {
+        if (rep == Inline)
+            return std::binary_search(small.begin(), small.end(), n);
+        if (rep == Sparse)
+            return sparseBits.test(n);
+        unsigned w = n / WordBits;
+        if (w < base || w - base >= words.size())
+            return false;
+        return words[w - base] & (Word(1) << (n % WordBits));
+    }
+
+    inline void set(ElemTy n)
+    {
+        test_and_set(n);
+    }
+
+    /// Returns true if n was not in the set before
+    bool test_and_set(ElemTy n)
+    {
+        if (rep == Inline)
+        {
+            auto it = std::lower_bound(small.begin(), small.end(), n);
+            if (it != small.end() && *it == n)
+                return false;
+            small.insert(it, n);
+            if (small.size() > InlineCap)
+            {
+                if (isTooSparse(small.front() / WordBits, small.back() / WordBits + 1, small.size()))
+                    toSparse();
+                else
+                    toDense();
+            }
+            return true;
+        }
+        if (rep == Sparse)
+            return sparseBits.test_and_set(n);
+        unsigned w = n / WordBits;
+        if (!covers(w, w + 1) && isTooSparse(w, w + 1, count() + 1))
+        {
+            toSparse();
+            return sparseBits.test_and_set(n);
+        }
+        cover(w, w + 1);
+        Word& word = words[w - base];
+        Word bit = Word(1) << (n % WordBits);
+        if (word & bit)
+            return false;
+        word |= bit;
+        return true;
+    }
+
+    void reset(ElemTy n)
+    {
+        if (rep == Inline)
+        {
+            auto it = std::lower_bound(small.begin(), small.end(), n);
+            if (it != small.end() && *it == n)
+                small.erase(it);
+            return;
+        }
+        if (rep == Sparse)
+        {
+            sparseBits.reset(n);
+            return;
+        }
+        unsigned w = n / WordBits;
+        if (w >= base && w - base < words.size())
+            words[w - base] &= ~(Word(1) << (n % WordBits));
+    }
+
+    inline void clear()
+    {
+        small.clear();
+        words.clear();
+        sparseBits.clear();
+        base = 0;
+        rep = Inline;
+    }
+
+    inline bool empty() const
+    {
+        if (rep == Inline)
+            return small.empty();
+        if (rep == Sparse)
+            return sparseBits.empty();
+        return getKernels().popcountWords(words.data(), words.size()) == 0;
+    }
+
+    inline unsigned count() const
+    {
+        if (rep == Inline)
+            return small.size();
+        if (rep == Sparse)
+            return sparseBits.count();
+        return getKernels().popcountWords(words.data(), words.size());
+    }
+
+    int find_first() const
+    {
+        if (rep == Sparse)
+            return sparseBits.find_first();
+        iterator it = begin();
+        return it == end() ? -1 : *it;
+    }
+
+    int find_last() const
+    {
+        if (rep == Inline)
+            return small.empty() ? -1 : small.back();
+        if (rep == Sparse)
+            return sparseBits.find_last();
+        for (unsigned w = words.size(); w-- > 0;)
+        {
+            if (words[w])
+                return (base + w) * WordBits + (WordBits - 1 - __builtin_clzll(words[w]));
+        }
+        return -1;
+    }
+
+    /// Union, returns whether this set changed
+    bool operator|=(const DensePointsTo& rhs)
+    {
+        if (this == &rhs)
+            return false;
+        if (rhs.rep == Inline)
+        {
+            bool changed = false;
+            for (ElemTy n : rhs.small)
+                changed |= test_and_set(n);
+            return changed;
+        }
+        if (rep == Sparse || rhs.rep == Sparse)
+        {
+            if (rep != Sparse)
+                toSparse();
+            if (rhs.rep == Sparse)
+                return sparseBits |= rhs.sparseBits;
+            bool changed = false;
+            for (ElemTy n : rhs)
+                changed |= sparseBits.test_and_set(n);
+            return changed;
+        }
+        if (rep == Inline)
+        {
+            unsigned oldCount = small.size();
+            DensePointsTo res(rhs);
+            for (ElemTy n : small)
+                res.set(n);
+            bool changed = res.count() != oldCount;
+            *this = std::move(res);
+            return changed;
+        }
+        unsigned lo = rhs.base, hi = rhs.base + rhs.words.size();
+        if (!covers(lo, hi) && isTooSparse(lo, hi, std::max(count(), rhs.count())))
+        {
+            toSparse();
+            return *this |= rhs;
+        }
+        cover(lo, hi);
+        return getKernels().orWords(&words[rhs.base - base], rhs.words.data(), rhs.words.size());
+    }
+
+    /// Intersection, returns whether this set changed
+    bool operator&=(const DensePointsTo& rhs)
+    {
+        if (this == &rhs)
+            return false;
+        if (rep == Inline || rhs.rep == Inline)
+        {
+            const DensePointsTo& probe = rep != Inline ? *this : rhs;
+            const DensePointsTo& elems = rep != Inline ? rhs : *this;
+            llvm::SmallVector<ElemTy, InlineCap> res;
+            for (ElemTy n : elems.small)
+                if (probe.test(n))
+                    res.push_back(n);
+            bool changed = res.size() != count();
+            clear();
+            small.assign(res.begin(), res.end());
+            return changed;
+        }
+        if (rep == Sparse || rhs.rep == Sparse)
+        {
+            if (rep != Sparse)
+                toSparse();
+            if (rhs.rep == Sparse)
+                return sparseBits &= rhs.sparseBits;
+            return sparseBits &= llvm::SparseBitVector<>(rhs);
+        }
+        bool changed = false;
+        unsigned lo = std::max(base, rhs.base);
+        unsigned hi = std::min(base + words.size(), rhs.base + rhs.words.size());
+        for (unsigned w = base; w < base + words.size(); w++)
+        {
+            if ((w < lo || w >= hi) && words[w - base])
+            {
+                words[w - base] = 0;
+                changed = true;
+            }
+        }
+        if (lo < hi)
+            changed |= getKernels().andWords(&words[lo - base], &rhs.words[lo - rhs.base], hi - lo);
+        return changed;
+    }
+
+    /// this &= ~rhs, returns whether this set changed
+    bool intersectWithComplement(const DensePointsTo& rhs)
+    {
+        if (this == &rhs)
+        {
+            bool changed = !empty();
+            clear();
+            return changed;
+        }
+        if (rep == Inline)
+        {
+            unsigned oldCount = small.size();
+            small.erase(std::remove_if(small.begin(), small.end(),
+                                       [&rhs](ElemTy n) { return rhs.test(n); }), small.end());
+            return small.size() != oldCount;
+        }
+        if (rep == Sparse)
+        {
+            if (rhs.rep == Sparse)
+                return sparseBits.intersectWithComplement(rhs.sparseBits);
+            return sparseBits.intersectWithComplement(llvm::SparseBitVector<>(rhs));
+        }
+        if (rhs.rep != Dense)
+        {
+            bool changed = false;
+            for (ElemTy n : rhs)
+            {
+                changed |= test(n);
+                reset(n);
+            }
+            return changed;
+        }
+        unsigned lo = std::max(base, rhs.base);
+        unsigned hi = std::min(base + words.size(), rhs.base + rhs.words.size());
+        if (lo >= hi)
+            return false;
+        return getKernels().andNotWords(&words[lo - base], &rhs.words[lo - rhs.base], hi - lo);
+    }
+
+    /// this = lhs & ~rhs
+    void intersectWithComplement(const DensePointsTo& lhs, const DensePointsTo& rhs)
+    {
+        DensePointsTo res(lhs);
+        res.intersectWithComplement(rhs);
+        *this = std::move(res);
+    }
+
+    bool intersects(const DensePointsTo& rhs) const
+    {
+        if (rep == Sparse && rhs.rep == Sparse)
+            return sparseBits.intersects(rhs.sparseBits);
+        if (rep != Dense || rhs.rep != Dense)
+        {
+            /// probe the word array (or the larger set) with the elements of the other
+            const DensePointsTo& probe = rhs.rep == Inline || (rep == Dense && rhs.rep == Sparse) ? *this : rhs;
+            const DensePointsTo& elems = &probe == this ? rhs : *this;
+            for (ElemTy n : elems)
+                if (probe.test(n))
+                    return true;
+            return false;
+        }
+        unsigned lo = std::max(base, rhs.base);
+        unsigned hi = std::min(base + words.size(), rhs.base + rhs.words.size());
+        if (lo >= hi)
+            return false;
+        return getKernels().intersectWords(&words[lo - base], &rhs.words[lo - rhs.base], hi - lo);
+    }
+
+    /// Whether every element of rhs is in this set
+    bool contains(const DensePointsTo& rhs) const
+    {
+        if (rhs.rep == Inline)
+        {
+            for (ElemTy n : rhs.small)
+                if (!test(n))
+                    return false;
+            return true;
+        }
+        if (rep == Sparse && rhs.rep == Sparse)
+            return sparseBits.contains(rhs.sparseBits);
+        if (rep != Dense || rhs.rep != Dense)
+            return rhs.count() <= count() && std::all_of(rhs.begin(), rhs.end(),
+                    [this](ElemTy n) { return test(n); });
+        unsigned lo = std::max(base, rhs.base);
+        unsigned hi = std::min(base + words.size(), rhs.base + rhs.words.size());
+        for (unsigned w = rhs.base; w < rhs.base + rhs.words.size(); w++)
+        {
+            if ((w < lo || w >= hi) && rhs.words[w - rhs.base])
+                return false;
+        }
+        return lo >= hi || getKernels().subsetWords(&rhs.words[lo - rhs.base], &words[lo - base], hi - lo);
+    }
+
+    inline bool operator==(const DensePointsTo& rhs) const
+    {
+        if (rep == Inline && rhs.rep == Inline)
+            return small == rhs.small;
+        if (rep == Sparse && rhs.rep == Sparse)
+            return sparseBits == rhs.sparseBits;
+        return count() == rhs.count() && contains(rhs);
+    }
+    inline bool operator!=(const DensePointsTo& rhs) const
+    {
+        return !(*this == rhs);
+    }
+
+    inline bool isDense() const
+    {
+        return rep == Dense;
+    }
+    inline bool isSparse() const
+    {
+        return rep == Sparse;
+    }
+
+private:
+    enum Rep
+    {
+        Inline,
+        Dense,
+        Sparse,
+    };
+
+    /// sorted elements while the set is small
+    llvm::SmallVector<ElemTy, InlineCap> small;
+    /// words[i] holds the elements [(base + i) * 64, (base + i + 1) * 64)
+    std::vector<Word> words;
+    unsigned base;
+    /// elements of a set too spread out for the word array
+    llvm::SparseBitVector<> sparseBits;
+    Rep rep;
+
+    /// Whether the word array already covers the words [lo, hi)
+    inline bool covers(unsigned lo, unsigned hi) const
+    {
+        return !words.empty() && lo >= base && hi <= base + words.size();
+    }
+
+    /// Whether a word array covering [lo, hi) and the current words would be
+    /// too large for population elements
+    inline bool isTooSparse(unsigned lo, unsigned hi, unsigned population) const
+    {
+        if (!words.empty())
+        {
+            lo = std::min<unsigned>(lo, base);
+            hi = std::max<unsigned>(hi, base + words.size());
+        }
+        return hi - lo > SparseSpan * population;
+    }
+
+    /// Grow the word array to cover the words [lo, hi)
+    void cover(unsigned lo, unsigned hi)
+    {
+        if (words.empty())
+        {
+            base = lo;
+            words.assign(hi - lo, 0);
+            return;
+        }
+        if (lo < base)
+        {
+            words.insert(words.begin(), base - lo, 0);
+            base = lo;
+        }
+        if (hi > base + words.size())
+            words.resize(hi - base, 0);
+    }
+
+    void toDense()
+    {
+        assert(rep == Inline && !small.empty() && "already dense or empty");
+        base = small.front() / WordBits;
+        words.assign(small.back() / WordBits - base + 1, 0);
+        for (ElemTy n : small)
+            words[n / WordBits - base] |= Word(1) << (n % WordBits);
+        small.clear();
+        rep = Dense;
+    }
+
+    void toSparse()
+    {
+        assert(rep != Sparse && "already sparse");
+        for (ElemTy n : *this)
+            sparseBits.set(n);
+        small.clear();
+        words.clear();
+        base = 0;
+        rep = Sparse;
+    }
+};
+
+inline DensePointsTo operator|(const DensePointsTo& lhs, const DensePointsTo& rhs)
+{
+    DensePointsTo res(lhs);
+    res |= rhs;
+    return res;
+}
+
+inline DensePointsTo operator&(const DensePointsTo& lhs, const DensePointsTo& rhs)
+{
+    DensePointsTo res(lhs);
+    res &= rhs;
+    return res;
+}
+
+inline DensePointsTo operator-(const DensePointsTo& lhs, const DensePointsTo& rhs)
+{
+    DensePointsTo res;
+    res.intersectWithComplement(lhs, rhs);
+    return res;
+}
+
+} // End namespace SVF
+
+/// Specialise hash for DensePointsTo the same way as for SparseBitVectors.
+template <> struct std::hash<SVF::DensePointsTo>
+{
+    size_t operator()(const SVF::DensePointsTo& pts) const
+    {
+        size_t h = pts.count();
+        h = h * 31 + pts.find_first();
+        h = h * 31 + pts.find_last();
+        return h;
+    }
+};
+
+#endif /* INCLUDE_UTIL_DENSEPOINTSTO_H_ */
@@ -70,6 +70,7 @@ public:
         EFT_A1R_A0,       //stores arg0 into *arg1
         EFT_A2R_A1,       //stores arg1 into *arg2
         EFT_A4R_A1,       //stores arg1 into *arg4
+        EFT_A0R_A1,       //stores arg1 into *arg0
         EFT_L_A0__A2R_A0, //stores arg0 into *arg2 and returns it
         EFT_L_A0__A1_A0,  //store arg1 into arg0's base and returns arg0
         EFT_A0R_NEW,      //stores a pointer to an allocated object in *arg0
@@ -88,15 +89,25 @@ public:
         CPP_EFT_DYNAMIC_CAST, // dynamic_cast
         EFT_OTHER         //not found in the list
     };
+
+    //Per-argument effects, only given by loaded summaries
+    enum extarg_t
+    {
+        EXTARG_READONLY= 1,   //nothing is written through the argument (only checked against the effect)
+        EXTARG_NOFOLLOW= 2    //pointers stored in the pointee are never dereferenced
+    };
 private:
 
     //Each Function name is mapped to its extf_t
     //  (hash_map and map are much slower).
     llvm::StringMap<extf_t> info;
+    //Each summarized Function name is mapped to the extarg_t bits of its arguments
+    llvm::StringMap<std::vector<u32_t>> argInfo;
     //A cache of is_ext results for all SVFFunction*'s (hash_map is fastest).
     Map<const SVFFunction*, bool> isext_cache;
 
     void init();                          //fill in the map (see ExtAPI.cpp)
+    bool loadSummaries(const std::string& file); //add the entries of a summary file
 
     ExtAPI()
     {
@@ -135,6 +146,25 @@ public:
             return it->second;
     }
 
+    //Return the extarg_t bits of argument (argNo) of the function named (funName).
+    u32_t get_arg_flags(const std::string& funName, u32_t argNo) const
+    {
+        llvm::StringMap<std::vector<u32_t>>::const_iterator it= argInfo.find(funName);
+        if(it == argInfo.end() || argNo >= it->second.size())
+            return 0;
+        return it->second[argNo];
+    }
+    //Does the MPK runtime define an __mpk_unsafe variant of the function named (funName)?
+    bool has_unsafe_variant(const std::string& funName) const
+    {
+        return info.find("__mpk_unsafe" + funName) != info.end();
+    }
+    //Does the external function never dereference pointers loaded from argument (argNo)?
+    bool is_nofollow_arg(const std::string& funName, u32_t argNo) const
+    {
+        return get_arg_flags(funName, argNo) & EXTARG_NOFOLLOW;
+    }
+
     //Does (F) have a static var X (unavailable to us) that its return points to?
     bool has_static(const SVFFunction* F) const
     {
@@ -65,6 +65,7 @@ public:
     static const llvm::cl::opt<bool> PrintQueryPts;
     static const llvm::cl::opt<bool> WPANum;
     static llvm::cl::bits<PointerAnalysis::PTATY> DDASelected;
+    static const llvm::cl::opt<unsigned> MpkMaxFlagClones;
 
     // FlowDDA.cpp
     static const llvm::cl::opt<unsigned long long> FlowBudget;
@@ -134,6 +135,7 @@ public:
     // MHP.cpp
     static const llvm::cl::opt<bool> PrintInterLev;
     static const llvm::cl::opt<bool> DoLockAnalysis;
+    static const llvm::cl::opt<unsigned> MHPThreads;
 
     // MTA.cpp
     static const llvm::cl::opt<bool> AndersenAnno;
@@ -161,6 +163,7 @@ public:
     // Source-sink analyzer (SrcSnkDDA.cpp)
     static const llvm::cl::opt<bool> DumpSlice;
     static const llvm::cl::opt<unsigned> CxtLimit;
+    static const llvm::cl::opt<unsigned> SaberThreads;
 
     // CHG.cpp
     static const llvm::cl::opt<bool> DumpCHA;
@@ -171,6 +174,11 @@ public:
     // LLVMModule.cpp
     static const llvm::cl::opt<std::string> Graphtxt;
     static const llvm::cl::opt<bool> SVFMain;
+    static const llvm::cl::opt<bool> LazyBitcode;
+    static const llvm::cl::opt<std::string> MpkProfile;
+    static const llvm::cl::opt<std::string> MpkEmitSummary;
+    static const llvm::cl::opt<std::string> MpkSummaries;
+    static const llvm::cl::opt<bool> MpkShareGenerics;
 
     // SymbolTableInfo.cpp
     static const llvm::cl::opt<bool> LocMemModel;
@@ -179,13 +187,26 @@ public:
 
     // Conditions.cpp
     static const llvm::cl::opt<unsigned> MaxBddSize;
+    static const llvm::cl::opt<bool> BddReorder;
+    static const llvm::cl::opt<unsigned> BddReorderThreshold;
 
     // PathCondAllocator.cpp
     static const llvm::cl::opt<bool> PrintPathCond;
+    static const llvm::cl::opt<bool> BddAutoSize;
 
     // SVFUtil.cpp
     static const llvm::cl::opt<bool> DisableWarn;
 
+    // ExtAPI.cpp
+    static const llvm::cl::opt<std::string> ExtSummaries;
+
+    // PhaseProfiler.cpp
+    static const llvm::cl::opt<std::string> PhaseTrace;
+    static const llvm::cl::opt<bool> PhaseStat;
+
+    // SVFAliasAnalysis.cpp
+    static const llvm::cl::opt<bool> SVFAAUseDDA;
+
     // Andersen.cpp
     static const llvm::cl::opt<bool> ConsCGDotGraph;
     static const llvm::cl::opt<bool> BriefConsCGDotGraph;
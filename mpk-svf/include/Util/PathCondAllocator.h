@@ -58,10 +58,9 @@ public:
 
     typedef Map<u32_t,Condition*> IndexToConditionMap;
 
-    /// Constructor
+    /// Constructor, the BDD manager is created by createBddCondManager or on first use
     PathCondAllocator()
     {
-        getBddCondManager();
     }
     /// Destructor
     virtual ~PathCondAllocator()
@@ -92,6 +91,37 @@ public:
     {
         return getBddCondManager()->getMaxLiveCondNumber();
     }
+    static inline u32_t getVarNum()
+    {
+        return getBddCondManager()->BddVarNum();
+    }
+    static inline u32_t getGCNum()
+    {
+        return getBddCondManager()->getGCNumber();
+    }
+    static inline double getGCTime()
+    {
+        return getBddCondManager()->getGCTime();
+    }
+    static inline u32_t getReorderNum()
+    {
+        return getBddCondManager()->getReorderNumber();
+    }
+    static inline double getReorderTime()
+    {
+        return getBddCondManager()->getReorderTime();
+    }
+    static inline u32_t getCacheSlots()
+    {
+        return getBddCondManager()->getCacheSlots();
+    }
+    static inline bool hasBddCondManager()
+    {
+        return bddCondMgr != nullptr;
+    }
+    /// Create the BDD manager sized for the decision variables of a module,
+    /// must be called before any condition (e.g. of the memory SSA) is created
+    static void createBddCondManager(const SVFModule* module);
     //@}
 
     /// Perform path allocation
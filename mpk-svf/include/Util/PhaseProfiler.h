@@ -0,0 +1,107 @@
+//===- PhaseProfiler.h -- Nested phase timers for the SVF pipeline ----------//
+
+/*
+ * PhaseProfiler.h
+ *
+ * Records nested, RAII-scoped phases (module load, PAG, Andersen, SVFG,
+ * DDA queries, isolation rewriting, bitcode dump) with wall time, CPU time
+ * and resident memory deltas. Phases are written as Chrome trace JSON
+ * (-phase-trace=<file>, viewable in chrome://tracing or Perfetto) and/or
+ * printed as an indented summary table (-phase-stat), followed by the counts
+ * the phases recorded (cloned functions, summaries, ...).
+ */
+
+#ifndef PHASEPROFILER_H_
+#define PHASEPROFILER_H_
+
+#include "Util/SVFBasicTypes.h"
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace SVF
+{
+
+class PhaseProfiler
+{
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    /// One closed (or still open) phase
+    struct Phase
+    {
+        std::string name;
+        /// Path of the enclosing phases, e.g. "DDA/ContextDDA"
+        std::string parent;
+        u32_t tid;
+        u32_t depth;
+        double startUs;
+        double wallUs;
+        double cpuMs;
+        s32_t rssStartKB;
+        s32_t rssDeltaKB;
+    };
+
+    static PhaseProfiler* getProfiler();
+
+    /// Whether -phase-trace or -phase-stat is given
+    static bool isEnabled();
+
+    /// Open a phase on the calling thread and return its index
+    u32_t begin(const std::string& name);
+    /// Close the phase returned by begin
+    void end(u32_t idx);
+
+    /// Add to a count of the -phase-stat summary, e.g. summarized functions
+    /// over all modules
+    void addStat(const std::string& name, u64_t value);
+
+    /// Write the trace and/or summary table, as requested on the command line
+    void report();
+
+    void writeChromeTrace(const std::string& file) const;
+    void printSummary(llvm::raw_ostream& O) const;
+
+private:
+    PhaseProfiler();
+
+    static PhaseProfiler* profiler;
+
+    mutable std::mutex phaseMutex;
+    std::vector<Phase> phases;
+    std::vector<std::pair<std::string, u64_t>> stats;
+    Clock::time_point origin;
+};
+
+/*!
+ * Times the enclosing scope as one phase, e.g.
+ *     PhaseTimer timer("Andersen");
+ * Does nothing unless the profiler is enabled.
+ */
+class PhaseTimer
+{
+public:
+    PhaseTimer(const std::string& name) : idx(0), active(PhaseProfiler::isEnabled())
+    {
+        if (active)
+            idx = PhaseProfiler::getProfiler()->begin(name);
+    }
+    ~PhaseTimer()
+    {
+        if (active)
+            PhaseProfiler::getProfiler()->end(idx);
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+    u32_t idx;
+    bool active;
+};
+
+} // End namespace SVF
+
+#endif /* PHASEPROFILER_H_ */
@@ -35,6 +35,7 @@
 #include <llvm/Support/raw_ostream.h>	// for output
 #include <llvm/Support/CommandLine.h>	// for command line options
 #include <llvm/ADT/StringMap.h>	// for StringMap
+#include "Util/DensePointsTo.h"	// for dense points-to
 
 #include <vector>
 #include <list>
@@ -85,7 +86,12 @@ typedef unsigned ThreadID;
 typedef unsigned Version;
 
 typedef llvm::SparseBitVector<> NodeBS;
+/// SVF_DENSE_PTS switches points-to sets to the hybrid inline/dense bitvector
+#ifdef SVF_DENSE_PTS
+typedef DensePointsTo PointsTo;
+#else
 typedef NodeBS PointsTo;
+#endif
 typedef PointsTo AliasSet;
 typedef unsigned PointsToID;
 
@@ -31,6 +31,8 @@
 #define THREADAPI_H_
 
 #include "Util/BasicTypes.h"
+#include <atomic>
+#include <mutex>
 
 namespace SVF
 {
@@ -74,7 +76,7 @@ private:
     TDAPIMap tdAPIMap;
 
     /// Constructor
-    ThreadAPI ()
+    ThreadAPI () : rustTDAPIsBuilt(false)
     {
         init();
     }
@@ -85,6 +87,38 @@ private:
     /// Static reference
     static ThreadAPI* tdAPI;
 
+    /// Rust thread APIs (std::thread::spawn, scoped threads, tokio's spawn_blocking, JoinHandle::join)
+    /// are generic and monomorphized per closure, so they are recognized by their demangled names.
+    /// They are collected from the SVFModule on first use, and forgotten by releaseRustTDAPIs
+    /// when the modules are released, as the maps are keyed by their functions.
+    //@{
+    typedef Map<const SVFFunction*, TD_TYPE> RustTDAPIMap;
+    typedef Map<const SVFFunction*, const Function*> RustSpawneeMap;
+    typedef Set<const Function*> RustRuntimeFunSet;
+
+    mutable std::mutex rustTDAPIMutex;
+    mutable std::atomic<bool> rustTDAPIsBuilt;
+    mutable RustTDAPIMap rustTDAPIMap;
+    /// Instance of a Rust spawn API --> the closure it runs in the new thread
+    mutable RustSpawneeMap rustSpawneeMap;
+    /// Functions implementing the Rust thread runtime, thread API calls inside them
+    /// (e.g., pthread_create in std::sys::unix::thread::Thread::new) are not modeled
+    mutable RustRuntimeFunSet rustRuntimeFuns;
+
+    void initRustTDAPIs() const;
+    inline void ensureRustTDAPIs() const
+    {
+        if(rustTDAPIsBuilt.load(std::memory_order_acquire))
+            return;
+        std::lock_guard<std::mutex> lock(rustTDAPIMutex);
+        if(!rustTDAPIsBuilt.load(std::memory_order_relaxed))
+        {
+            initRustTDAPIs();
+            rustTDAPIsBuilt.store(true, std::memory_order_release);
+        }
+    }
+    //@}
+
     /// Get the function type if it is a threadAPI function
     inline TD_TYPE getType(const SVFFunction* F) const
     {
@@ -93,10 +127,34 @@ private:
             TDAPIMap::const_iterator it= tdAPIMap.find(F->getName().str());
             if(it != tdAPIMap.end())
                 return it->second;
+            ensureRustTDAPIs();
+            RustTDAPIMap::const_iterator rit = rustTDAPIMap.find(F);
+            if(rit != rustTDAPIMap.end())
+                return rit->second;
         }
         return TD_DUMMY;
     }
 
+    /// Get the threadAPI type of a callsite, calls inside the Rust thread runtime are ignored
+    inline TD_TYPE getType(const Instruction *inst) const
+    {
+        TD_TYPE type = getType(getCallee(inst));
+        if(type != TD_DUMMY)
+        {
+            ensureRustTDAPIs();
+            if(rustRuntimeFuns.count(inst->getFunction()))
+                return TD_DUMMY;
+        }
+        return type;
+    }
+
+    /// Arguments of Rust thread APIs
+    //@{
+    const Value* getRustForkedThread(const Instruction *inst) const;
+    const Value* getRustActualParmAtForkSite(const Instruction *inst) const;
+    const Value* getRustJoinedThread(const Instruction *inst) const;
+    //@}
+
 public:
     /// Return a static reference
     static ThreadAPI* getThreadAPI()
@@ -108,6 +166,17 @@ public:
         return tdAPI;
     }
 
+    /// Forget the Rust thread APIs of the released modules, they are collected
+    /// again from the next SVFModule
+    void releaseRustTDAPIs()
+    {
+        std::lock_guard<std::mutex> lock(rustTDAPIMutex);
+        rustTDAPIMap.clear();
+        rustSpawneeMap.clear();
+        rustRuntimeFuns.clear();
+        rustTDAPIsBuilt.store(false, std::memory_order_release);
+    }
+
     /// Return the callee/callsite/func
     //@{
     const SVFFunction* getCallee(const Instruction *inst) const;
@@ -119,7 +188,7 @@ public:
     //@{
     inline bool isTDFork(const Instruction *inst) const
     {
-        return getType(getCallee(inst)) == TD_FORK;
+        return getType(inst) == TD_FORK;
     }
     inline bool isTDFork(CallSite cs) const
     {
@@ -131,7 +200,7 @@ public:
     //@{
     inline bool isHareParFor(const Instruction *inst) const
     {
-        return getType(getCallee(inst)) == HARE_PAR_FOR;
+        return getType(inst) == HARE_PAR_FOR;
     }
     inline bool isHareParFor(CallSite cs) const
     {
@@ -139,6 +208,13 @@ public:
     }
     //@}
 
+    /// Return true if this call is a Rust thread API (spawn/join) rather than a pthread one
+    inline bool isRustTDAPI(const Instruction *inst) const
+    {
+        ensureRustTDAPIs();
+        return rustTDAPIMap.count(getCallee(inst));
+    }
+
     /// Return arguments/attributes of pthread_create / hare_parallel_for
     //@{
     /// Return the first argument of the call,
@@ -146,6 +222,8 @@ public:
     inline const Value* getForkedThread(const Instruction *inst) const
     {
         assert(isTDFork(inst) && "not a thread fork function!");
+        if(isRustTDAPI(inst))
+            return getRustForkedThread(inst);
         CallSite cs = getLLVMCallSite(inst);
         return cs.getArgument(0);
     }
@@ -159,6 +237,8 @@ public:
     inline const Value* getForkedFun(const Instruction *inst) const
     {
         assert(isTDFork(inst) && "not a thread fork function!");
+        if(isRustTDAPI(inst))
+            return rustSpawneeMap.at(getCallee(inst));
         CallSite cs = getLLVMCallSite(inst);
         return cs.getArgument(2)->stripPointerCasts();
     }
@@ -169,9 +249,12 @@ public:
 
     /// Return the forth argument of the call,
     /// Note that, it is the sole argument of start routine ( a void* pointer )
+    /// For Rust spawn APIs it is the closure, or nullptr if the closure captures nothing
     inline const Value* getActualParmAtForkSite(const Instruction *inst) const
     {
         assert(isTDFork(inst) && "not a thread fork function!");
+        if(isRustTDAPI(inst))
+            return getRustActualParmAtForkSite(inst);
         CallSite cs = getLLVMCallSite(inst);
         return cs.getArgument(3);
     }
@@ -213,7 +296,7 @@ public:
     //@{
     inline bool isTDJoin(const Instruction *inst) const
     {
-        return getType(getCallee(inst)) == TD_JOIN;
+        return getType(inst) == TD_JOIN;
     }
     inline bool isTDJoin(CallSite cs) const
     {
@@ -228,6 +311,8 @@ public:
     inline const Value* getJoinedThread(const Instruction *inst) const
     {
         assert(isTDJoin(inst) && "not a thread join function!");
+        if(isRustTDAPI(inst))
+            return getRustJoinedThread(inst);
         CallSite cs = getLLVMCallSite(inst);
         Value* join = cs.getArgument(0);
         if(SVFUtil::isa<LoadInst>(join))
@@ -380,7 +380,7 @@ protected:
         {
             const PointsTo& pts = getPts(it->first);
             NodeBS fldInsenObjs;
-            for(NodeBS::iterator pit = pts.begin(), epit = pts.end(); pit!=epit; ++pit)
+            for(PointsTo::iterator pit = pts.begin(), epit = pts.end(); pit!=epit; ++pit)
             {
                 if(isFieldInsensitive(*pit))
                     fldInsenObjs.set(*pit);
@@ -0,0 +1,167 @@
+//===- SVFAliasAnalysis.h -- SVF results as an LLVM alias analysis -----------//
+
+/*
+ * SVFAliasAnalysis.h
+ *
+ * Answers the alias and mod-ref queries of LLVM's optimizers (LICM, GVN, DSE,
+ * the vectorizers, ...) with whole-program Andersen's (or ContextDDA) points-to
+ * sets and MRGenerator's call side effects. SVFAABuildPass builds it after
+ * inlining, on a copy of the module: SVF adds dummy loads and summary calls to
+ * the module it analyzes, which must not reach the optimized module. The
+ * passes that follow keep changing the IR, so:
+ *  - original values and calls are looked up through ValueMaps that drop
+ *    entries when the IR is deleted or replaced; anything created later gets
+ *    no answer
+ *  - the module must define main: SVF assumes it sees the whole program
+ *  - arguments of functions that are externally visible or address-taken,
+ *    externally visible globals and results of unmodeled external calls point
+ *    to the black hole object
+ *  - mod-ref answers are only given for calls whose callees transitively reach
+ *    no unmodeled external code, atomics or inline assembly
+ * A query SVF cannot answer falls through to the next alias analysis.
+ */
+
+#ifndef SVFALIASANALYSIS_H_
+#define SVFALIASANALYSIS_H_
+
+#include "Util/BasicTypes.h"
+#include <llvm/Analysis/AliasAnalysis.h>
+#include <llvm/IR/ValueMap.h>
+
+namespace SVF
+{
+
+class PAG;
+class PAGBuilder;
+class BVDataPTAImpl;
+class ContextDDA;
+class DDAClient;
+class MemSSA;
+class CallBlockNode;
+
+class SVFAAResult : public llvm::AAResultBase<SVFAAResult>
+{
+    friend llvm::AAResultBase<SVFAAResult>;
+
+    /// Entries are dropped when their IR is deleted or replaced
+    struct ValueMapConfig : llvm::ValueMapConfig<const Value*>
+    {
+        enum { FollowRAUW = false };
+    };
+    typedef llvm::ValueMap<const Value*, NodeID, ValueMapConfig> ValueToNodeMap;
+    typedef llvm::ValueMap<const Value*, const CallBlockNode*, ValueMapConfig> CallToNodeMap;
+    typedef llvm::ValueMap<const Value*, const Function*, ValueMapConfig> FunctionMap;
+
+public:
+    SVFAAResult(Module& module);
+    ~SVFAAResult();
+
+    AliasResult alias(const MemoryLocation& LocA, const MemoryLocation& LocB, llvm::AAQueryInfo& AAQI);
+    ModRefInfo getModRefInfo(const CallBase* call, const MemoryLocation& loc, llvm::AAQueryInfo& AAQI);
+    ModRefInfo getModRefInfo(const CallBase* call1, const CallBase* call2, llvm::AAQueryInfo& AAQI);
+
+private:
+    /// Let escaping arguments and globals and unmodeled external results point to the black hole
+    void addUnknownSources(PAGBuilder& builder, Module& module);
+    /// Find the functions of the analyzed copy whose memory side effects MRGenerator fully sees
+    void collectClosedFunctions(Module& module);
+
+    /// Points-to set of V, false if it is unknown or may contain unknown objects
+    bool getPts(const Value* V, PointsTo& pts);
+    /// The call's node, if all its callees are closed
+    const CallBlockNode* getClosedCall(const CallBase* call);
+    /// Base objects of the objects in pts
+    void getBaseObjs(const PointsTo& pts, NodeBS& objs);
+    /// Base objects the call may modify and read, false if it may touch unknown objects
+    bool getCallModRef(const CallBlockNode* cs, NodeBS& mod, NodeBS& ref);
+
+    PAG* pag;
+    BVDataPTAImpl* ander;
+    ContextDDA* dda;
+    DDAClient* client;
+    MemSSA* mssa;
+
+    /// The copy of the module SVF analyzes
+    std::unique_ptr<Module> analyzed;
+
+    ValueToNodeMap valueToNode;
+    CallToNodeMap callToNode;
+    /// Functions of the module to their copies
+    FunctionMap analyzedFunctions;
+    Set<const Function*> closedFunctions;
+};
+
+/*!
+ * Holds the SVFAAResult that SVFAABuildPass builds. Add it together with an
+ * ExternalAAWrapperPass (see createSVFExternalAAWrapperPass) so that
+ * AAResults picks the result up.
+ */
+class SVFAAWrapperPass : public llvm::ImmutablePass
+{
+public:
+    static char ID;
+
+    SVFAAWrapperPass() : llvm::ImmutablePass(ID) {}
+
+    inline bool hasResult() const
+    {
+        return result != nullptr;
+    }
+    inline SVFAAResult& getResult()
+    {
+        return *result;
+    }
+
+    /// Replace the result with one for the module as it is now
+    void buildResult(Module& module);
+
+    bool doFinalization(Module& module) override;
+
+    void getAnalysisUsage(AnalysisUsage& au) const override
+    {
+        au.setPreservesAll();
+    }
+
+    llvm::StringRef getPassName() const override
+    {
+        return "SVF Alias Analysis";
+    }
+
+private:
+    std::unique_ptr<SVFAAResult> result;
+};
+
+/*!
+ * Builds the SVFAAWrapperPass result for the module as it is when the pass
+ * runs, so put it after the inliner and in front of the passes that should
+ * use SVF's answers
+ */
+class SVFAABuildPass : public llvm::ModulePass
+{
+public:
+    static char ID;
+
+    SVFAABuildPass() : llvm::ModulePass(ID) {}
+
+    bool runOnModule(Module& module) override;
+
+    void getAnalysisUsage(AnalysisUsage& au) const override
+    {
+        au.addRequired<SVFAAWrapperPass>();
+        au.setPreservesAll();
+    }
+
+    llvm::StringRef getPassName() const override
+    {
+        return "Build SVF Alias Analysis";
+    }
+};
+
+llvm::ImmutablePass* createSVFAAWrapperPass();
+llvm::ModulePass* createSVFAABuildPass();
+/// The ExternalAAWrapperPass that adds the SVFAAWrapperPass result to AAResults
+llvm::ImmutablePass* createSVFExternalAAWrapperPass();
+
+} // End namespace SVF
+
+#endif /* SVFALIASANALYSIS_H_ */
@@ -7,6 +7,7 @@
 
 #include "Util/DPItem.h"
 #include "Util/Options.h"
+#include "Util/PhaseProfiler.h"
 #include "MemoryModel/PointerAnalysisImpl.h"
 #include "DDA/DDAPass.h"
 #include "DDA/FlowDDA.h"
@@ -15,6 +16,9 @@
 #include "SVF-FE/PAGBuilder.h"
 #include "RustIsolation/MPKRustIsolation.h"
 #include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/BranchProbabilityInfo.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
 
 #include <sstream>
 #include <limits.h>
@@ -37,6 +41,8 @@ set<const SVFGNode*> UnsafePointers;
 map<Function*,AllocaInst*> IndirectFuncToUnsafeSpaceMap;
 map<CallBase*,CallBase*> IndirectCBMap;
 set<Function*> IndirectlyDefined;
+map<pair<Function*,uint64_t>,Function*> FlagSpecializedMap;
+map<Function*,u32_t> FlagCloneCount;
 
 typedef std::map<const SVFGNode*, std::vector<const Value*>> SVFGNodeValueSetMap;
 typedef std::map<const SVFGNode*, std::set<const SVFGNode*>> SVFGNodeNodeSetMap;
@@ -512,6 +518,155 @@ bool replaceUnsafeCalls(){
     return true;
 }
 
+/// Clone an __mpk_unsafe function with its trailing flag argument fixed to
+/// flag. Pruning while cloning folds the flag tests, so the clone only keeps
+/// the allocation paths taken for this flag. The clone has no flag argument,
+/// so it is named __mpk_flagged<flag> instead of __mpk_unsafe, which the
+/// rewriter takes to mean that the last argument is the flag.
+Function* specializeFlag(Function* F, uint64_t flag){
+    auto key = make_pair(F, flag);
+    auto it = FlagSpecializedMap.find(key);
+    if(it != FlagSpecializedMap.end())
+        return it->second;
+    if(FlagCloneCount[F] >= Options::MpkMaxFlagClones)
+        return nullptr;
+    FlagCloneCount[F]++;
+
+    std::vector<Type*> ArgTypes;
+    for(const Argument &I : F->args())
+        ArgTypes.push_back(I.getType());
+    ArgTypes.pop_back();
+    FunctionType *FTy = FunctionType::get(F->getReturnType(), ArgTypes, F->isVarArg());
+    Function *NewF = Function::Create(FTy, GlobalValue::InternalLinkage, F->getAddressSpace(),
+                                      "__mpk_flagged" + llvm::Twine(flag) +
+                                      F->getName().drop_front(StringRef("__mpk_unsafe").size()), F->getParent());
+
+    llvm::ValueToValueMapTy VMap;
+    Function::arg_iterator DestI = NewF->arg_begin();
+    for(Argument &I : F->args()){
+        if(I.getArgNo() + 1 == F->arg_size()){
+            VMap[&I] = ConstantInt::get(I.getType(), flag);
+        }else{
+            DestI->setName(I.getName());
+            VMap[&I] = &*DestI++;
+        }
+    }
+    SmallVector<ReturnInst*, 8> Returns;
+    llvm::CloneAndPruneFunctionInto(NewF, F, VMap, F->getSubprogram() != nullptr, Returns);
+    NewF->setLinkage(GlobalValue::InternalLinkage);
+    NewF->addFnAttr(llvm::Attribute::InlineHint);
+    /// The profile of F came along with its metadata; the clone only runs for
+    /// the call sites redirected to it, which add their counts later
+    if(F->getEntryCount().hasValue())
+        NewF->setEntryCount(Function::ProfileCount(0, F->getEntryCount().getType()));
+
+    FlagSpecializedMap.insert(make_pair(key, NewF));
+    return NewF;
+}
+
+/// Move count calls from the entry count of the flag-passing function to the
+/// entry count of its clone
+void moveEntryCount(Function* from, Function* to, uint64_t count){
+    Function::ProfileCount fromCount = from->getEntryCount();
+    Function::ProfileCount toCount = to->getEntryCount();
+    if(!fromCount.hasValue() || !toCount.hasValue())
+        return;
+    count = std::min(count, fromCount.getCount());
+    from->setEntryCount(Function::ProfileCount(fromCount.getCount() - count, fromCount.getType()));
+    to->setEntryCount(Function::ProfileCount(toCount.getCount() + count, toCount.getType()));
+}
+
+/// Call the flag-specialized clone, dropping the constant flag argument.
+void redirectToSpecialized(CallBase* CB, Function* specialized){
+    std::vector<Value*> Args(CB->arg_begin(), CB->arg_end() - 1);
+
+    llvm::AttributeList PAL = CB->getAttributes();
+    if(!PAL.isEmpty()){
+        llvm::SmallVector<llvm::AttributeSet,8> ArgAttrs;
+        for(unsigned ArgNo = 0; ArgNo < Args.size(); ++ArgNo)
+            ArgAttrs.push_back(PAL.getParamAttributes(ArgNo));
+        PAL = llvm::AttributeList::get(CB->getContext(), PAL.getFnAttributes(),PAL.getRetAttributes(), ArgAttrs);
+    }
+
+    SmallVector<llvm::OperandBundleDef, 1> OpBundles;
+    CB->getOperandBundlesAsDefs(OpBundles);
+
+    CallBase *NewCB = nullptr;
+    if(InvokeInst* II = llvm::dyn_cast<InvokeInst>(CB)){
+        NewCB = InvokeInst::Create(specialized, II->getNormalDest(), II->getUnwindDest(), Args, OpBundles, "", CB);
+    }else{
+        NewCB = CallInst::Create(specialized, Args, OpBundles, "", CB);
+        llvm::cast<CallInst>(NewCB)->setTailCallKind(llvm::cast<CallInst>(CB)->getTailCallKind());
+    }
+    NewCB->setCallingConv(CB->getCallingConv());
+    NewCB->setAttributes(PAL);
+    NewCB->copyMetadata(*CB,{LLVMContext::MD_prof, LLVMContext::MD_dbg});
+    if(!CB->use_empty())
+        CB->replaceAllUsesWith(NewCB);
+    CB->eraseFromParent();
+}
+
+/// Profile-guided choice between clone and flag: hot call sites passing a
+/// constant flag get a clone specialized for that flag, which is small enough
+/// to inline; cold call sites keep sharing the flag-passing __mpk_unsafe
+/// function. Calls inside a new clone are revisited, since their flags have
+/// become constant as well.
+void specializeHotUnsafeCalls(){
+    set<Function*> flagPassing;
+    for(auto ff: MpkRedefinedMap)
+        if(!ff.second->isDeclaration())
+            flagPassing.insert(ff.second);
+
+    LLVMModuleSet* modSet = LLVMModuleSet::getLLVMModuleSet();
+    for(u32_t i = 0; i < modSet->getModuleNum(); ++i){
+        Module* M = modSet->getModule(i);
+        llvm::ProfileSummaryInfo PSI(*M);
+        if(!PSI.hasProfileSummary())
+            continue;
+
+        std::vector<Function*> worklist;
+        for(Function &F : *M)
+            if(!F.isDeclaration())
+                worklist.push_back(&F);
+
+        while(!worklist.empty()){
+            Function* F = worklist.back();
+            worklist.pop_back();
+
+            std::vector<CallBase*> candidates;
+            for(inst_iterator I = inst_begin(F), E = inst_end(F); I != E; ++I){
+                CallBase* CB = llvm::dyn_cast<CallBase>(&*I);
+                if(!CB || !CB->getCalledFunction() || flagPassing.find(CB->getCalledFunction()) == flagPassing.end())
+                    continue;
+                if(llvm::isa<ConstantInt>(CB->getArgOperand(CB->arg_size() - 1)))
+                    candidates.push_back(CB);
+            }
+            if(candidates.empty())
+                continue;
+
+            llvm::DominatorTree DT(*F);
+            llvm::LoopInfo LI(DT);
+            llvm::BranchProbabilityInfo BPI(*F, LI);
+            llvm::BlockFrequencyInfo BFI(*F, BPI, LI);
+            for(auto CB: candidates){
+                if(!PSI.isHotCallSite(*CB, &BFI))
+                    continue;
+                Function* callee = CB->getCalledFunction();
+                uint64_t flag = llvm::cast<ConstantInt>(CB->getArgOperand(CB->arg_size() - 1))->getZExtValue();
+                bool isNew = FlagSpecializedMap.find(make_pair(callee, flag)) == FlagSpecializedMap.end();
+                Function* specialized = specializeFlag(callee, flag);
+                if(!specialized)
+                    continue;
+                if(isNew)
+                    worklist.push_back(specialized);
+                if(auto count = BFI.getBlockProfileCount(CB->getParent()))
+                    moveEntryCount(callee, specialized, count.getValue());
+                redirectToSpecialized(CB, specialized);
+            }
+        }
+    }
+}
+
 void removeDummyLoads(SVFModule* module){
     set<Instruction*> toRemove;
     for(auto it = module->begin(), eit = module->end(); it != eit; ++it){
@@ -530,6 +685,37 @@ void removeDummyLoads(SVFModule* module){
 }
 
 
+/// Allocation sites can only be moved to the unsafe heap if their callee can
+/// be redefined: defined functions are cloned, external ones need an
+/// __mpk_unsafe variant in the MPK runtime. Objects of other external
+/// functions (library contexts, static buffers) stay where the library put them.
+static bool isRelocatableAlloc(const Function* F){
+    return F != nullptr && (!F->isDeclaration() || ExtAPI::getExtAPI()->has_unsafe_variant(F->getName().str()));
+}
+
+/*!
+ * A top-level pointer is unsafe when it is defined or used by an instruction
+ * marked MPK-Unsafe
+ */
+bool DDAPass::isUnsafePointer(const PAGNode* node){
+    if(!node->isTopLevelPtr() || !node->isPointer() || !node->hasValue())
+        return false;
+    const Value* val = node->getValue();
+    if(val == nullptr)
+        return false;
+    if(const Instruction* inst = llvm::dyn_cast<Instruction>(val)){
+        if(inst->getMetadata("MPK-Unsafe") != nullptr)
+            return true;
+    }
+    for (auto user: val->users()) {
+        if (const Instruction *inst = llvm::dyn_cast<Instruction>(user)) {
+            if (inst->getMetadata("MPK-Unsafe") != nullptr)
+                return true;
+        }
+    }
+    return false;
+}
+
 void DDAPass::findUnsafePointers(PointerAnalysis* pta, SVFG* svfg, PAG* pag, const SVFModule* svfModule){
     
     const set<CxtLocDPItem> heapPaths = ((ContextDDA*)_pta)->getFinalHeapDpms(); 
@@ -549,7 +735,8 @@ void DDAPass::findUnsafePointers(PointerAnalysis* pta, SVFG* svfg, PAG* pag, con
                 const Value* nodeVal = node->getValue();
                 assert(llvm::isa<CallBase>(nodeVal) && "added a non-call node as final?");
                 CallBase* allocCallBase = const_cast<CallBase*>(llvm::cast<CallBase>(nodeVal));
-                if(allocCallBase->getCalledFunction()->getName().startswith("__mpk_unsafe")){
+                if(!isRelocatableAlloc(allocCallBase->getCalledFunction()) ||
+                        allocCallBase->getCalledFunction()->getName().startswith("__mpk_unsafe")){
                     continue;
                 }
                 UnsafeCallBases.insert(allocCallBase);
@@ -640,7 +827,8 @@ void DDAPass::findUnsafePointers(PointerAnalysis* pta, SVFG* svfg, PAG* pag, con
             const SVFGNode* node = dpm.getLoc();
             const Value* val = node->getValue();
             CallBase* allocCallBase = const_cast<CallBase*>(llvm::cast<CallBase>(val));
-            if(allocCallBase->getCalledFunction()->getName().startswith("__mpk_unsafe")){
+            if(!isRelocatableAlloc(allocCallBase->getCalledFunction()) ||
+                    allocCallBase->getCalledFunction()->getName().startswith("__mpk_unsafe")){
                 continue;
             }
             Function* caller = allocCallBase->getParent()->getParent();
@@ -696,41 +884,18 @@ void DDAPass::findUnsafePointers(PointerAnalysis* pta, SVFG* svfg, PAG* pag, con
     
     for(auto id: pag->getAllValidPtrs()){
         PAGNode* node = pag->getPAGNode(id);
-        if(node->isTopLevelPtr() && node->isPointer() && node->hasValue()){
-            const Value* val = node->getValue();
-            bool isUnsafe = false;
-            if(val){
-                if(const Instruction* inst = llvm::dyn_cast<Instruction>(val)){
-                    if(inst->getMetadata("MPK-Unsafe") != nullptr){
-                        isUnsafe = true;
-                    }
-                }
-
-                if(!isUnsafe) {
-                    for (auto user: val->users()) {
-                        if (const Instruction *inst = llvm::dyn_cast<Instruction>(user)) {
-                            if (inst->getMetadata("MPK-Unsafe") != nullptr) {
-                                isUnsafe = true;
-                                break;
-                            }
-                        }
-                    }
-                }
-            }
-            
-            if(isUnsafe){
-                auto pts = pta->getPts(id);
-                const SVFGNode* snode = svfg->getDefSVFGNode(node);
-                UnsafePointers.insert(snode);
-                for(auto pt: pts){
-                    const MemObj* obj = pag->getBaseObj(pt);
-                    if(obj->isStack()){
-                        AllocaInst* AI = const_cast<AllocaInst*>(llvm::cast<AllocaInst>(obj->getRefVal()));
-                        if(AI->getMetadata("MPK-Extern-Move") == nullptr){
-                            auto &cxt = AI->getContext();
-                            MDNode* N = MDNode::get(cxt,MDString::get(cxt,"Unsafe stack object replacement"));
-                            AI->setMetadata("MPK-Extern-Move", N);
-                        }
+        if(isUnsafePointer(node)){
+            auto pts = pta->getPts(id);
+            const SVFGNode* snode = svfg->getDefSVFGNode(node);
+            UnsafePointers.insert(snode);
+            for(auto pt: pts){
+                const MemObj* obj = pag->getBaseObj(pt);
+                if(obj->isStack()){
+                    AllocaInst* AI = const_cast<AllocaInst*>(llvm::cast<AllocaInst>(obj->getRefVal()));
+                    if(AI->getMetadata("MPK-Extern-Move") == nullptr){
+                        auto &cxt = AI->getContext();
+                        MDNode* N = MDNode::get(cxt,MDString::get(cxt,"Unsafe stack object replacement"));
+                        AI->setMetadata("MPK-Extern-Move", N);
                     }
                 }
             }
@@ -747,7 +912,7 @@ void DDAPass::runOnModule(SVFModule* module)
     /// initialization for llvm alias analyzer
     //InitializeAliasAnalysis(this, SymbolTableInfo::getDataLayout(&module));
 
-    
+
     selectClient(module);
 
     for (u32_t i = PointerAnalysis::FlowS_DDA;
@@ -764,15 +929,35 @@ void DDAPass::runOnModule(SVFModule* module)
     //constructAllocFuncCallGraphs(module,pag, callGraph,((ContextDDA*)_pta)->getSVFG());
 
     ///Find and mark unsafe pointers, unsafe alloc entry calls
-    findUnsafePointers(_pta,((ContextDDA*)_pta)->getSVFG(),pag,module);
-
-    traverseUnsafePointerCopies(((ContextDDA*)_pta)->getSVFG(), pag);
+    {
+        PhaseTimer timer("findUnsafePointers");
+        findUnsafePointers(_pta,((ContextDDA*)_pta)->getSVFG(),pag,module);
+    }
+    {
+        PhaseTimer timer("traverseUnsafePointerCopies");
+        traverseUnsafePointerCopies(((ContextDDA*)_pta)->getSVFG(), pag);
+    }
 
     removeDummyLoads(module);
-    std::cout<<"Cloned Functions: "<<MpkRedefinedMap.size()<<std::endl;
-    replaceUnsafeCalls();
+    if (PhaseProfiler::isEnabled())
+        PhaseProfiler::getProfiler()->addStat("Cloned Functions", MpkRedefinedMap.size());
+    {
+        PhaseTimer timer("replaceUnsafeCalls");
+        replaceUnsafeCalls();
+    }
+
+    ///Give hot unsafe allocation paths their own constant-flag clones
+    {
+        PhaseTimer timer("specializeHotUnsafeCalls");
+        specializeHotUnsafeCalls();
+    }
+    if (PhaseProfiler::isEnabled())
+        PhaseProfiler::getProfiler()->addStat("Flag-specialized Functions", FlagSpecializedMap.size());
 
     LLVMModuleSet::getLLVMModuleSet()->dumpModulesToFile(".bc");
+
+    if (PhaseProfiler::isEnabled())
+        PhaseProfiler::getProfiler()->report();
 }
 
 bool DDAPass::runOnModule(Module& module)
@@ -821,6 +1006,7 @@ void DDAPass::selectClient(SVFModule* module)
 /// Create pointer analysis according to specified kind and analyze the module.
 void DDAPass::runPointerAnalysis(SVFModule* module, u32_t kind)
 {
+    PhaseTimer timer(kind == PointerAnalysis::Cxt_DDA ? "ContextDDA" : "FlowDDA");
 
     PAGBuilder builder;
     PAG* pag = builder.build(module);
@@ -855,7 +1041,10 @@ void DDAPass::runPointerAnalysis(SVFModule* module, u32_t kind)
         ///initialize
         _pta->initialize();
         ///compute points-to
-        _client->answerQueries(_pta);
+        {
+            PhaseTimer queryTimer("DDA queries");
+            _client->answerQueries(_pta);
+        }
         ///finalize
         _pta->finalize();
         if(Options::PrintCPts)
@@ -0,0 +1,469 @@
+/*
+ * @file: DDAServer.cpp
+ *
+ * Long-running demand-driven analysis server
+ */
+
+#include "Util/Options.h"
+#include "Util/SVFUtil.h"
+#include "SVF-FE/LLVMUtil.h"
+#include "SVF-FE/PAGBuilder.h"
+#include "DDA/DDAServer.h"
+#include "DDA/DDAPass.h"
+#include "WPA/Andersen.h"
+#include "RustIsolation/IsolationSummary.h"
+#include "Util/NodeIDAllocator.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/IRReader/IRReader.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace SVF;
+using namespace SVFUtil;
+
+DDAServer::DDAServer(const std::vector<std::string>& names) :
+    moduleNames(names), svfModule(nullptr), client(nullptr), dda(nullptr), unsafeObjsBuilt(false)
+{
+    hashModules(functionHashes);
+    build();
+}
+
+DDAServer::~DDAServer()
+{
+    release();
+}
+
+void DDAServer::build()
+{
+    svfModule = LLVMModuleSet::getLLVMModuleSet()->buildSVFModule(moduleNames);
+    PAGBuilder builder;
+    PAG* pag = builder.build(svfModule);
+
+    VFPathCond::setMaxPathLen(Options::MaxPathLen);
+    ContextCond::setMaxCxtLen(Options::MaxContextLen);
+
+    client = new DDAClient(svfModule);
+    dda = new ContextDDA(pag, client);
+    dda->initialize();
+}
+
+void DDAServer::release()
+{
+    ptsCache.clear();
+    unsafeObjs.clear();
+    unsafeObjsBuilt = false;
+
+    delete dda;
+    dda = nullptr;
+    delete client;
+    client = nullptr;
+
+    SVFGBuilder::releaseSVFG();
+    AndersenWaveDiff::releaseAndersenWaveDiff();
+    PAG::releasePAG();
+    SymbolTableInfo::releaseSymbolInfo();
+    NodeIDAllocator::unset();
+    /// the summarized bodies are saved in a module of their own
+    releaseIsolationSummaries();
+    /// also forgets the Rust thread APIs found in the modules
+    LLVMModuleSet::releaseLLVMModuleSet();
+    svfModule = nullptr;
+}
+
+/*!
+ * The analysis rewrites the modules it loads (dummy loads, unsafe marks of
+ * library code), so the fingerprints come from a separate parse
+ */
+bool DDAServer::hashModules(FunctionHashMap& hashes) const
+{
+    LLVMContext cxt;
+    for (const std::string& moduleName : moduleNames)
+    {
+        SMDiagnostic Err;
+        std::unique_ptr<Module> mod = parseIRFile(moduleName, Err, cxt);
+        if (mod == nullptr)
+        {
+            Err.print("DDAServer", SVFUtil::errs());
+            return false;
+        }
+        for (const Function& fun : *mod)
+        {
+            std::string body;
+            llvm::raw_string_ostream os(body);
+            fun.print(os);
+            hashes[fun.getName().str()] = llvm::hash_value(os.str());
+        }
+    }
+    return true;
+}
+
+bool DDAServer::isValidNode(NodeID id) const
+{
+    return dda->getPAG()->hasGNode(id);
+}
+
+/*!
+ * Context-insensitive view of the context-sensitive points-to set, cached
+ * until the next reload
+ */
+const PointsTo& DDAServer::getPts(NodeID id)
+{
+    auto it = ptsCache.find(id);
+    if (it != ptsCache.end())
+        return it->second;
+
+    PAG* pag = dda->getPAG();
+    PointsTo& pts = ptsCache[id];
+    if (pag->isValidTopLevelPtr(pag->getPAGNode(id)))
+    {
+        ContextCond cxt;
+        CxtVar var(cxt, id);
+        pts = dda->getBVPointsTo(dda->computeDDAPts(var, false));
+    }
+    else
+        pts = AndersenWaveDiff::createAndersenWaveDiff(pag)->getPts(id);
+    return pts;
+}
+
+/*!
+ * Objects the unsafe pointers of DDAPass::findUnsafePointers may point to,
+ * with the points-to sets of the DDA
+ */
+const PointsTo& DDAServer::getUnsafeObjs()
+{
+    if (unsafeObjsBuilt)
+        return unsafeObjs;
+
+    PAG* pag = dda->getPAG();
+    for (NodeID id : pag->getAllValidPtrs())
+    {
+        if (DDAPass::isUnsafePointer(pag->getPAGNode(id)))
+            unsafeObjs |= getPts(id);
+    }
+    unsafeObjsBuilt = true;
+    return unsafeObjs;
+}
+
+static inline bool readU32(const std::string& req, size_t pos, u32_t& val)
+{
+    if (req.size() < pos + sizeof(u32_t))
+        return false;
+    memcpy(&val, req.data() + pos, sizeof(u32_t));
+    return true;
+}
+
+static inline void writeU32(std::string& resp, u32_t val)
+{
+    resp.append(reinterpret_cast<const char*>(&val), sizeof(u32_t));
+}
+
+static const Value* lookupValue(const std::string& funName, const std::string& valName)
+{
+    LLVMModuleSet* modSet = LLVMModuleSet::getLLVMModuleSet();
+    for (u32_t i = 0; i < modSet->getModuleNum(); i++)
+    {
+        Module* mod = modSet->getModule(i);
+        if (funName.empty())
+        {
+            if (const GlobalValue* global = mod->getNamedValue(valName))
+                return global;
+            continue;
+        }
+        const Function* fun = mod->getFunction(funName);
+        if (fun == nullptr || fun->isDeclaration())
+            continue;
+        for (const Argument& arg : fun->args())
+            if (arg.getName() == valName)
+                return &arg;
+        for (const BasicBlock& bb : *fun)
+            for (const Instruction& inst : bb)
+                if (inst.getName() == valName)
+                    return &inst;
+    }
+    return nullptr;
+}
+
+bool DDAServer::handle(u32_t op, const std::string& req, u32_t& status, std::string& resp)
+{
+    PAG* pag = dda->getPAG();
+    u32_t id1 = 0, id2 = 0;
+    status = StatusOk;
+
+    switch (op)
+    {
+    case OpLookup:
+    {
+        size_t sep = req.find('\0');
+        const Value* val = sep == std::string::npos ? nullptr : lookupValue(req.substr(0, sep), req.substr(sep + 1));
+        if (val == nullptr || !pag->hasValueNode(val))
+            status = StatusError;
+        else
+            writeU32(resp, pag->getValueNode(val));
+        break;
+    }
+    case OpPointsTo:
+    {
+        if (!readU32(req, 0, id1) || !isValidNode(id1))
+        {
+            status = StatusError;
+            break;
+        }
+        const PointsTo& pts = getPts(id1);
+        writeU32(resp, pts.count());
+        for (NodeID obj : pts)
+            writeU32(resp, obj);
+        break;
+    }
+    case OpAlias:
+    {
+        if (!readU32(req, 0, id1) || !readU32(req, sizeof(u32_t), id2) || !isValidNode(id1) || !isValidNode(id2))
+        {
+            status = StatusError;
+            break;
+        }
+        writeU32(resp, getPts(id1).intersects(getPts(id2)) ? llvm::MayAlias : llvm::NoAlias);
+        break;
+    }
+    case OpUnsafe:
+    {
+        if (!readU32(req, 0, id1) || !isValidNode(id1))
+        {
+            status = StatusError;
+            break;
+        }
+        writeU32(resp, getPts(id1).intersects(getUnsafeObjs()));
+        break;
+    }
+    case OpName:
+    {
+        if (!readU32(req, 0, id1) || !isValidNode(id1))
+        {
+            status = StatusError;
+            break;
+        }
+        PAGNode* node = pag->getPAGNode(id1);
+        if (node->hasValue())
+        {
+            resp = node->getValueName();
+            resp.push_back('\0');
+            resp += getSourceLoc(node->getValue());
+        }
+        break;
+    }
+    case OpReload:
+    {
+        /// only rebuild when a function body actually changed on disk
+        FunctionHashMap hashes;
+        if (!hashModules(hashes))
+        {
+            status = StatusError;
+            break;
+        }
+        u32_t numChanged = 0;
+        for (auto& it : hashes)
+        {
+            auto old = functionHashes.find(it.first);
+            if (old == functionHashes.end() || old->second != it.second)
+                numChanged++;
+        }
+        for (auto& it : functionHashes)
+        {
+            if (hashes.find(it.first) == hashes.end())
+                numChanged++;
+        }
+        if (numChanged > 0)
+        {
+            functionHashes.swap(hashes);
+            release();
+            build();
+        }
+        writeU32(resp, numChanged);
+        break;
+    }
+    case OpShutdown:
+        return false;
+    default:
+        status = StatusError;
+        break;
+    }
+    return true;
+}
+
+static bool readFully(int fd, void* buf, size_t len)
+{
+    char* p = static_cast<char*>(buf);
+    while (len > 0)
+    {
+        ssize_t n = read(fd, p, len);
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool writeFully(int fd, const void* buf, size_t len)
+{
+    const char* p = static_cast<const char*>(buf);
+    while (len > 0)
+    {
+        ssize_t n = write(fd, p, len);
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+/*!
+ * Answer the requests of one client until it disconnects,
+ * returns false on an OpShutdown request
+ */
+bool DDAServer::handleClient(int fd)
+{
+    while (true)
+    {
+        unsigned char op;
+        u32_t len;
+        if (!readFully(fd, &op, 1) || !readFully(fd, &len, sizeof(len)))
+            return true;
+        if (len > MaxRequestLen)
+        {
+            /// the payload is not read, so the stream cannot be resynchronized
+            unsigned char st = StatusError;
+            u32_t respLen = 0;
+            if (writeFully(fd, &st, 1))
+                writeFully(fd, &respLen, sizeof(respLen));
+            return true;
+        }
+        std::string req(len, '\0');
+        if (len > 0 && !readFully(fd, &req[0], len))
+            return true;
+
+        u32_t status;
+        std::string resp;
+        if (!handle(op, req, status, resp))
+            return false;
+
+        unsigned char st = status;
+        u32_t respLen = resp.size();
+        if (!writeFully(fd, &st, 1) || !writeFully(fd, &respLen, sizeof(respLen)) ||
+                !writeFully(fd, resp.data(), resp.size()))
+            return true;
+    }
+}
+
+/*!
+ * $XDG_RUNTIME_DIR/dvf-server.sock, or a private directory under /tmp
+ */
+std::string DDAServer::getDefaultSocketPath()
+{
+    const char* runtimeDir = getenv("XDG_RUNTIME_DIR");
+    if (runtimeDir != nullptr && runtimeDir[0] == '/')
+        return std::string(runtimeDir) + "/dvf-server.sock";
+
+    std::string dir = "/tmp/dvf-server-" + std::to_string(geteuid());
+    if (mkdir(dir.c_str(), 0700) < 0 && errno != EEXIST)
+        return "";
+    /// someone else may have created it first
+    struct stat st;
+    if (lstat(dir.c_str(), &st) < 0 || !S_ISDIR(st.st_mode) || st.st_uid != geteuid() ||
+            (st.st_mode & (S_IRWXG | S_IRWXO)) != 0)
+        return "";
+    return dir + "/dvf-server.sock";
+}
+
+/*!
+ * Remove the socket a previous server left behind; refuses to touch anything
+ * else, or the socket of a server that still answers
+ */
+static bool removeStaleSocket(const std::string& socketPath, const sockaddr_un& addr)
+{
+    struct stat st;
+    if (lstat(socketPath.c_str(), &st) < 0)
+        return errno == ENOENT;
+    if (!S_ISSOCK(st.st_mode) || st.st_uid != geteuid())
+    {
+        errno = EEXIST;
+        return false;
+    }
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe < 0)
+        return false;
+    bool live = connect(probe, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+    close(probe);
+    if (live)
+    {
+        errno = EADDRINUSE;
+        return false;
+    }
+    return unlink(socketPath.c_str()) == 0;
+}
+
+/// Only processes of the server's own user may query it
+static bool isSameUser(int fd)
+{
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+    return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 && cred.uid == geteuid();
+}
+
+bool DDAServer::serve(const std::string& socketPath)
+{
+    sockaddr_un addr;
+    if (socketPath.empty() || socketPath.size() >= sizeof(addr.sun_path))
+    {
+        SVFUtil::errs() << "invalid socket path: '" << socketPath << "'\n";
+        return false;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    bool bound = false;
+    if (sock >= 0 && removeStaleSocket(socketPath, addr))
+    {
+        /// the socket is created with mode 0600
+        mode_t oldMask = umask(0177);
+        bound = bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+        umask(oldMask);
+    }
+    if (!bound || chmod(socketPath.c_str(), 0600) < 0 || listen(sock, 8) < 0)
+    {
+        SVFUtil::errs() << "unable to listen on " << socketPath << ": " << strerror(errno) << "\n";
+        if (sock >= 0)
+            close(sock);
+        if (bound)
+            unlink(socketPath.c_str());
+        return false;
+    }
+
+    SVFUtil::outs() << "serving queries on " << socketPath << "\n";
+    bool running = true;
+    while (running)
+    {
+        int fd = accept(sock, nullptr, nullptr);
+        if (fd < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        if (isSameUser(fd))
+            running = handleClient(fd);
+        close(fd);
+    }
+
+    close(sock);
+    unlink(socketPath.c_str());
+    return true;
+}
@@ -780,6 +780,20 @@ NodeID PAG::getGepObjNode(const MemObj* obj, const LocationSet& ls)
     // Base and first field are the same memory location.
     if (Options::FirstFieldEqBase && newLS.getOffset() == 0) return base;
 
+    // Fast path: plain field offsets are resolved through the per-base direct table,
+    // avoiding hashing/comparing the LocationSet in GepObjNodeMap.
+    if (isPlainFieldOffset(newLS))
+    {
+        GepObjNodeTable::const_iterator tit = gepObjNodeTable.find(base);
+        if (tit != gepObjNodeTable.end() && (u32_t) newLS.getOffset() < tit->second.size())
+        {
+            NodeID gepId = tit->second[newLS.getOffset()];
+            if (gepId != 0)
+                return gepId;
+        }
+        return addGepObjNode(obj, newLS);
+    }
+
     NodeLocationSetMap::iterator iter = GepObjNodeMap.find(std::make_pair(base, newLS));
     if (iter == GepObjNodeMap.end())
         return addGepObjNode(obj, newLS);
@@ -800,6 +814,13 @@ NodeID PAG::addGepObjNode(const MemObj* obj, const LocationSet& ls)
 
     NodeID gepId = NodeIDAllocator::get()->allocateGepObjectId(base, ls.getOffset(), StInfo::getMaxFieldLimit());
     GepObjNodeMap[std::make_pair(base, ls)] = gepId;
+    if (isPlainFieldOffset(ls))
+    {
+        NodeVector& fields = gepObjNodeTable[base];
+        if (fields.size() <= (u32_t) ls.getOffset())
+            fields.resize(ls.getOffset() + 1, 0);
+        fields[ls.getOffset()] = gepId;
+    }
     GepObjPN *node = new GepObjPN(obj, gepId, ls);
     memToFieldsMap[base].set(gepId);
     return addObjNode(obj->getRefVal(), node, gepId);
@@ -136,6 +136,9 @@ void ThreadCallGraph::updateJoinEdge(PointerAnalysis* pta)
                 forkset.insert(*it);
             }
         }
+        /// a Rust JoinHandle may be moved around (e.g., into a Vec) before it is joined
+        if (forkset.empty() && tdAPI->isRustTDAPI((*it)->getCallSite()))
+            continue;
         assert(!forkset.empty() && "Can't find a forksite for this join!!");
         addDirectJoinEdge(*it,forkset);
     }
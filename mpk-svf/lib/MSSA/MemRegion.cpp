@@ -238,12 +238,12 @@ void MRGenerator::collectModRefForCall()
         const CallBlockNode* callBlockNode = pta->getPAG()->getICFG()->getCallBlockNode(cs.getInstruction());
         if(hasRefSideEffectOfCallSite(callBlockNode))
         {
-            NodeBS refs = getRefSideEffectOfCallSite(callBlockNode);
+            PointsTo refs = getRefSideEffectOfCallSite(callBlockNode);
             addCPtsToCallSiteRefs(refs,callBlockNode);
         }
         if(hasModSideEffectOfCallSite(callBlockNode))
         {
-            NodeBS mods = getModSideEffectOfCallSite(callBlockNode);
+            PointsTo mods = getModSideEffectOfCallSite(callBlockNode);
             /// mods are treated as both def and use of memory objects
             addCPtsToCallSiteMods(mods,callBlockNode);
             addCPtsToCallSiteRefs(mods,callBlockNode);
@@ -380,9 +380,9 @@ void MRGenerator::updateAliasMRs()
 /*!
  * Add indirect uses an memory object in the function
  */
-void MRGenerator::addRefSideEffectOfFunction(const SVFFunction* fun, const NodeBS& refs)
+void MRGenerator::addRefSideEffectOfFunction(const SVFFunction* fun, const PointsTo& refs)
 {
-    for(NodeBS::iterator it = refs.begin(), eit = refs.end(); it!=eit; ++it)
+    for(PointsTo::iterator it = refs.begin(), eit = refs.end(); it!=eit; ++it)
     {
         if(isNonLocalObject(*it,fun))
             funToRefsMap[fun].set(*it);
@@ -392,9 +392,9 @@ void MRGenerator::addRefSideEffectOfFunction(const SVFFunction* fun, const NodeB
 /*!
  * Add indirect def an memory object in the function
  */
-void MRGenerator::addModSideEffectOfFunction(const SVFFunction* fun, const NodeBS& mods)
+void MRGenerator::addModSideEffectOfFunction(const SVFFunction* fun, const PointsTo& mods)
 {
-    for(NodeBS::iterator it = mods.begin(), eit = mods.end(); it!=eit; ++it)
+    for(PointsTo::iterator it = mods.begin(), eit = mods.end(); it!=eit; ++it)
     {
         if(isNonLocalObject(*it,fun))
             funToModsMap[fun].set(*it);
@@ -408,8 +408,13 @@ bool MRGenerator::addRefSideEffectOfCallSite(const CallBlockNode* cs, const Node
 {
     if(!refs.empty())
     {
-        NodeBS refset = refs;
-        refset &= getCallSiteArgsPts(cs);
+        const PointsTo& argsPts = getCallSiteArgsPts(cs);
+        PointsTo refset;
+        for(NodeBS::iterator it = refs.begin(), eit = refs.end(); it!=eit; ++it)
+        {
+            if(argsPts.test(*it))
+                refset.set(*it);
+        }
         getEscapObjviaGlobals(refset,refs);
         addRefSideEffectOfFunction(cs->getCaller(),refset);
         return csToRefsMap[cs] |= refset;
@@ -424,8 +429,14 @@ bool MRGenerator::addModSideEffectOfCallSite(const CallBlockNode* cs, const Node
 {
     if(!mods.empty())
     {
-        NodeBS modset = mods;
-        modset &= (getCallSiteArgsPts(cs) | getCallSiteRetPts(cs));
+        const PointsTo& argsPts = getCallSiteArgsPts(cs);
+        const PointsTo& retPts = getCallSiteRetPts(cs);
+        PointsTo modset;
+        for(NodeBS::iterator it = mods.begin(), eit = mods.end(); it!=eit; ++it)
+        {
+            if(argsPts.test(*it) || retPts.test(*it))
+                modset.set(*it);
+        }
         getEscapObjviaGlobals(modset,mods);
         addModSideEffectOfFunction(cs->getCaller(),modset);
         return csToModsMap[cs] |= modset;
@@ -455,7 +466,7 @@ void MRGenerator::getCallGraphSCCRevTopoOrder(WorkList& worklist)
 void MRGenerator::collectCallSitePts(const CallBlockNode* cs)
 {
     /// collect the pts chain of the callsite arguments
-    NodeBS& argsPts = csToCallSiteArgsPtsMap[cs];
+    PointsTo& argsPts = csToCallSiteArgsPtsMap[cs];
     PAG* pag = pta->getPAG();
     CallBlockNode* callBlockNode = pag->getICFG()->getCallBlockNode(cs->getCallSite());
     RetBlockNode* retBlockNode = pag->getICFG()->getRetBlockNode(cs->getCallSite());
@@ -481,7 +492,7 @@ void MRGenerator::collectCallSitePts(const CallBlockNode* cs)
     }
 
     /// collect the pts chain of the return argument
-    NodeBS& retPts = csToCallSiteRetPtsMap[cs];
+    PointsTo& retPts = csToCallSiteRetPtsMap[cs];
 
     if (pta->getPAG()->callsiteHasRet(retBlockNode))
     {
@@ -500,7 +511,7 @@ void MRGenerator::collectCallSitePts(const CallBlockNode* cs)
 /*!
  * Recurisively collect all points-to of the whole struct fields
  */
-NodeBS& MRGenerator::CollectPtsChain(NodeID id)
+PointsTo& MRGenerator::CollectPtsChain(NodeID id)
 {
     NodeID baseId = pta->getPAG()->getBaseObjNode(id);
     NodeToPTSSMap::iterator it = cachedPtsChainMap.find(baseId);
@@ -534,7 +545,7 @@ NodeBS& MRGenerator::CollectPtsChain(NodeID id)
  * Otherwise, the object in callee's modref would not escape through globals
  */
 
-void MRGenerator::getEscapObjviaGlobals(NodeBS& globs, const NodeBS& calleeModRef)
+void MRGenerator::getEscapObjviaGlobals(PointsTo& globs, const NodeBS& calleeModRef)
 {
     for(NodeBS::iterator it = calleeModRef.begin(), eit = calleeModRef.end(); it!=eit; ++it)
     {
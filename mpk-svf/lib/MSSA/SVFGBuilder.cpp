@@ -27,6 +27,7 @@
  *      Author: Yulei Sui
  */
 #include "Util/Options.h"
+#include "Util/PhaseProfiler.h"
 #include "Util/SVFModule.h"
 #include "SVF-FE/LLVMUtil.h"
 #include "MSSA/MemSSA.h"
@@ -76,6 +77,7 @@ void SVFGBuilder::buildSVFG()
 /// Create DDA SVFG
 SVFG* SVFGBuilder::build(BVDataPTAImpl* pta, VFG::VFGK kind)
 {
+    PhaseTimer timer("SVFG");
 
     MemSSA* mssa = buildMSSA(pta, (VFG::PTRONLYSVFG==kind || VFG::PTRONLYSVFG_OPT==kind));
 
@@ -121,6 +123,7 @@ void SVFGBuilder::releaseMemory()
 
 MemSSA* SVFGBuilder::buildMSSA(BVDataPTAImpl* pta, bool ptrOnlyMSSA)
 {
+    PhaseTimer timer("MemSSA");
 
     DBOUT(DGENERAL, outs() << pasMsg("Build Memory SSA \n"));
 
@@ -142,7 +142,7 @@ void MTASVFGBuilder::performRemovingMHPEdges()
             {
                 IndirectSVFGEdge* e = SVFUtil::cast<IndirectSVFGEdge>(edge);
                 const PointsTo& pts = e->getPointsTo();
-                for (NodeBS::iterator o = remove_pts.begin(), eo = remove_pts.end(); o != eo; ++o)
+                for (PointsTo::iterator o = remove_pts.begin(), eo = remove_pts.end(); o != eo; ++o)
                 {
                     if (const_cast<PointsTo&>(pts).test(*o))
                     {
@@ -652,7 +652,7 @@ void MTASVFGBuilder::readPrecision()
                 PointsTo pts = e->getPointsTo();
                 PointsTo remove_pts;
 
-                for (NodeBS::iterator o = pts.begin(), eo = pts.end(); o != eo; ++o)
+                for (PointsTo::iterator o = pts.begin(), eo = pts.end(); o != eo; ++o)
                 {
                     SVFGNodeIDSet succ1 = getSuccNodes(n1, *o);
                     SVFGNodeIDSet succ2 = getSuccNodes(n2, *o);
@@ -12,6 +12,8 @@
 #include "MTA/MTAResultValidator.h"
 #include "Util/SVFUtil.h"
 #include "MemoryModel/PTAStat.h"
+#include <atomic>
+#include <thread>
 
 using namespace SVF;
 using namespace SVFUtil;
@@ -108,62 +110,47 @@ void MHP::analyze()
 
 /*!
  * Analyze thread interleaving
+ *
+ * Facts seeded for a root thread only carry that root's id, so each root is
+ * propagated to its own fixpoint (possibly in parallel) and merged afterwards.
  */
 void MHP::analyzeInterleaving()
 {
+    NodeVector roots;
     for(TCT::const_iterator it = tct->begin(), eit = tct->end(); it!=eit; ++it)
-    {
-        const CxtThread& ct = it->second->getCxtThread();
-        NodeID rootTid = it->first;
-        const Function* routine = tct->getStartRoutineOfCxtThread(ct);
-        CxtThreadStmt rootcts(rootTid,ct.getContext(),&(routine->getEntryBlock().front()));
+        roots.push_back(it->first);
 
-        addInterleavingThread(rootcts,rootTid);
-        updateAncestorThreads(rootTid);
-        updateSiblingThreads(rootTid);
+    u32_t numThreads = std::min((u32_t) Options::MHPThreads, (u32_t) roots.size());
+    if(numThreads > 1)
+    {
+        prepareParallelInterleaving();
 
-        while(!cxtStmtList.empty())
+        std::atomic<u32_t> nextRoot(0);
+        std::mutex mergeMutex;
+        std::vector<std::thread> workers;
+        for(u32_t i = 0; i < numThreads; ++i)
         {
-            CxtThreadStmt cts = popFromCTSWorkList();
-            const Instruction* curInst = cts.getStmt();
-            DBOUT(DMTA,outs() << "-----\nMHP analysis root thread: " << rootTid << " ");
-            DBOUT(DMTA,cts.dump());
-            DBOUT(DMTA,outs() << "current thread interleaving: < ");
-            DBOUT(DMTA,dumpSet(getInterleavingThreads(cts)));
-            DBOUT(DMTA,outs() << " >\n-----\n");
-
-            /// handle non-candidate function
-            if (!tct->isCandidateFun(curInst->getParent()->getParent()))
-            {
-                handleNonCandidateFun(cts);
-            }
-            /// handle candidate function
-            else
+            workers.push_back(std::thread([&]()
             {
-                if(isTDFork(curInst))
-                {
-                    handleFork(cts,rootTid);
-                }
-                else if(isTDJoin(curInst))
-                {
-                    handleJoin(cts,rootTid);
-                }
-                else if(SVFUtil::isa<CallInst>(curInst) && !isExtCall(curInst))
-                {
-                    handleCall(cts,rootTid);
-                    PTACallGraph::FunctionSet callees;
-                    if(!tct->isCandidateFun(getCallee(curInst, callees)))
-                       handleIntra(cts);
-                }
-                else if(SVFUtil::isa<ReturnInst>(curInst))
+                for(u32_t idx = nextRoot++; idx < roots.size(); idx = nextRoot++)
                 {
-                    handleRet(cts);
-                }
-                else
-                {
-                    handleIntra(cts);
+                    RootInterleaving ri(roots[idx]);
+                    analyzeRootInterleaving(ri);
+                    std::lock_guard<std::mutex> guard(mergeMutex);
+                    mergeRootInterleaving(ri);
                 }
-            }
+            }));
+        }
+        for(std::thread& worker : workers)
+            worker.join();
+    }
+    else
+    {
+        for(NodeVector::const_iterator it = roots.begin(), eit = roots.end(); it!=eit; ++it)
+        {
+            RootInterleaving ri(*it);
+            analyzeRootInterleaving(ri);
+            mergeRootInterleaving(ri);
         }
     }
 
@@ -177,6 +164,100 @@ void MHP::analyzeInterleaving()
     validateResults();
 }
 
+/*!
+ * Propagate the interleaving of a root thread
+ */
+void MHP::analyzeRootInterleaving(RootInterleaving& ri)
+{
+    NodeID rootTid = ri.getRootTid();
+    const CxtThread& ct = tct->getTCTNode(rootTid)->getCxtThread();
+    const Function* routine = tct->getStartRoutineOfCxtThread(ct);
+    CxtThreadStmt rootcts(rootTid,ct.getContext(),&(routine->getEntryBlock().front()));
+
+    addInterleavingThread(ri,rootcts,rootTid);
+    updateAncestorThreads(ri);
+    updateSiblingThreads(ri);
+
+    while(!ri.empty())
+    {
+        CxtThreadStmt cts = ri.pop();
+        const Instruction* curInst = cts.getStmt();
+        DBOUT(DMTA,outs() << "-----\nMHP analysis root thread: " << rootTid << " ");
+        DBOUT(DMTA,cts.dump());
+        DBOUT(DMTA,outs() << "current thread interleaving: < " << (ri.hasBit(cts) ? "set" : "unset"));
+        DBOUT(DMTA,outs() << " >\n-----\n");
+
+        /// handle non-candidate function
+        if (!tct->isCandidateFun(curInst->getParent()->getParent()))
+        {
+            handleNonCandidateFun(ri,cts);
+        }
+        /// handle candidate function
+        else
+        {
+            if(isTDFork(curInst))
+            {
+                handleFork(ri,cts);
+            }
+            else if(isTDJoin(curInst))
+            {
+                handleJoin(ri,cts);
+            }
+            else if(SVFUtil::isa<CallInst>(curInst) && !isExtCall(curInst))
+            {
+                handleCall(ri,cts);
+                PTACallGraph::FunctionSet callees;
+                if(!tct->isCandidateFun(getCallee(curInst, callees)))
+                   handleIntra(ri,cts);
+            }
+            else if(SVFUtil::isa<ReturnInst>(curInst))
+            {
+                handleRet(ri,cts);
+            }
+            else
+            {
+                handleIntra(ri,cts);
+            }
+        }
+    }
+}
+
+/*!
+ * Merge the facts of a root thread into the interleaving results
+ */
+void MHP::mergeRootInterleaving(const RootInterleaving& ri)
+{
+    const RootInterleaving::ThreadStmtToBitMap& facts = ri.getFacts();
+    for(RootInterleaving::ThreadStmtToBitMap::const_iterator it = facts.begin(), eit = facts.end(); it!=eit; ++it)
+    {
+        CxtThreadStmt cts = ri.getCxtThreadStmt(it->first);
+        NodeBS& tds = threadStmtToTheadInterLeav[cts];
+        if(it->second)
+            tds.set(ri.getRootTid());
+        instToTSMap[cts.getStmt()].insert(cts);
+    }
+}
+
+/*!
+ * Roots query the ICFG and ExtAPI concurrently; both create entries on first
+ * lookup, so populate them for every function and call site up front.
+ */
+void MHP::prepareParallelInterleaving()
+{
+    SVFModule* module = tct->getSVFModule();
+    for (SVFModule::iterator F = module->begin(), E = module->end(); F != E; ++F)
+    {
+        const SVFFunction* fun = *F;
+        isExtCall(fun);
+        for (inst_iterator II = inst_begin(fun->getLLVMFun()), EE = inst_end(fun->getLLVMFun()); II != EE; ++II)
+        {
+            const Instruction* inst = &*II;
+            if(isNonInstricCallSite(inst))
+                getCBN(inst);
+        }
+    }
+}
+
 /*!
  * Update non-candidate functions' interleaving
  */
@@ -216,7 +297,7 @@ void MHP::updateNonCandidateFunInterleaving()
 /*!
  * Handle call instruction in the current thread scope (excluding any fork site)
  */
-void MHP::handleNonCandidateFun(const CxtThreadStmt& cts)
+void MHP::handleNonCandidateFun(RootInterleaving& ri, const CxtThreadStmt& cts)
 {
     const Instruction* curInst = cts.getStmt();
     const Function* curfun = curInst->getParent()->getParent();
@@ -229,7 +310,7 @@ void MHP::handleNonCandidateFun(const CxtThreadStmt& cts)
         if (!isExtCall(callee))
         {
             CxtThreadStmt newCts(cts.getTid(), curCxt, &(callee->getLLVMFun()->getEntryBlock().front()));
-            addInterleavingThread(newCts, cts);
+            addInterleavingThread(ri,newCts, cts);
         }
     }
 }
@@ -237,7 +318,7 @@ void MHP::handleNonCandidateFun(const CxtThreadStmt& cts)
 /*!
  * Handle fork
  */
-void MHP::handleFork(const CxtThreadStmt& cts, NodeID rootTid)
+void MHP::handleFork(RootInterleaving& ri, const CxtThreadStmt& cts)
 {
 
     const CallInst* call = SVFUtil::cast<CallInst>(cts.getStmt());
@@ -258,16 +339,16 @@ void MHP::handleFork(const CxtThreadStmt& cts, NodeID rootTid)
             const Instruction* stmt = &(routine->getEntryBlock().front());
             CxtThread ct(newCxt,call);
             CxtThreadStmt newcts(tct->getTCTNode(ct)->getId(),ct.getContext(),stmt);
-            addInterleavingThread(newcts,cts);
+            addInterleavingThread(ri,newcts,cts);
         }
     }
-    handleIntra(cts);
+    handleIntra(ri,cts);
 }
 
 /*!
  * Handle join
  */
-void MHP::handleJoin(const CxtThreadStmt& cts, NodeID rootTid)
+void MHP::handleJoin(RootInterleaving& ri, const CxtThreadStmt& cts)
 {
 
     const CallInst* call = SVFUtil::cast<CallInst>(cts.getStmt());
@@ -286,15 +367,15 @@ void MHP::handleJoin(const CxtThreadStmt& cts, NodeID rootTid)
             {
                 BasicBlock* eb = exitbbs.pop_back_val();
                 CxtThreadStmt newCts(cts.getTid(),curCxt,&(eb->front()));
-                addInterleavingThread(newCts,cts);
+                addInterleavingThread(ri,newCts,cts);
                 if(isJoinInSymmetricLoop(curCxt,call))
-                    rmInterleavingThread(newCts,joinedTids,call);
+                    rmInterleavingThread(ri,newCts,joinedTids,call);
             }
         }
         else
         {
-            rmInterleavingThread(cts,joinedTids,call);
-            DBOUT(DMTA,outs() << "\n\t match join site " << *call <<  " for thread " << rootTid << "\n");
+            rmInterleavingThread(ri,cts,joinedTids,call);
+            DBOUT(DMTA,outs() << "\n\t match join site " << *call <<  " for thread " << ri.getRootTid() << "\n");
         }
     }
     /// for the join site in a loop loop which does not join the current thread
@@ -309,17 +390,17 @@ void MHP::handleJoin(const CxtThreadStmt& cts, NodeID rootTid)
             {
                 BasicBlock* eb = exitbbs.pop_back_val();
                 CxtThreadStmt newCts(cts.getTid(),cts.getContext(),&(eb->front()));
-                addInterleavingThread(newCts,cts);
+                addInterleavingThread(ri,newCts,cts);
             }
         }
     }
-    handleIntra(cts);
+    handleIntra(ri,cts);
 }
 
 /*!
  * Handle call instruction in the current thread scope (excluding any fork site)
  */
-void MHP::handleCall(const CxtThreadStmt& cts, NodeID rootTid)
+void MHP::handleCall(RootInterleaving& ri, const CxtThreadStmt& cts)
 {
 
     const CallInst* call = SVFUtil::cast<CallInst>(cts.getStmt());
@@ -338,7 +419,7 @@ void MHP::handleCall(const CxtThreadStmt& cts, NodeID rootTid)
             CallStrCxt newCxt = curCxt;
             pushCxt(newCxt,call,callee);
             CxtThreadStmt newCts(cts.getTid(),newCxt,&(callee->getEntryBlock().front()));
-            addInterleavingThread(newCts,cts);
+            addInterleavingThread(ri,newCts,cts);
         }
     }
 }
@@ -346,7 +427,7 @@ void MHP::handleCall(const CxtThreadStmt& cts, NodeID rootTid)
 /*!
  * Handle return instruction in the current thread scope (excluding any join site)
  */
-void MHP::handleRet(const CxtThreadStmt& cts)
+void MHP::handleRet(RootInterleaving& ri, const CxtThreadStmt& cts)
 {
 
     PTACallGraphNode* curFunNode = tcg->getCallGraphNode(tct->getSVFFun(cts.getStmt()->getParent()->getParent()));
@@ -366,7 +447,7 @@ void MHP::handleRet(const CxtThreadStmt& cts)
                 for(InstVec::const_iterator nit = nextInsts.begin(), enit = nextInsts.end(); nit!=enit; ++nit)
                 {
                     CxtThreadStmt newCts(cts.getTid(),newCxt,*nit);
-                    addInterleavingThread(newCts,cts);
+                    addInterleavingThread(ri,newCts,cts);
                 }
             }
         }
@@ -381,7 +462,7 @@ void MHP::handleRet(const CxtThreadStmt& cts)
                 for(InstVec::const_iterator nit = nextInsts.begin(), enit = nextInsts.end(); nit!=enit; ++nit)
                 {
                     CxtThreadStmt newCts(cts.getTid(),newCxt,*nit);
-                    addInterleavingThread(newCts,cts);
+                    addInterleavingThread(ri,newCts,cts);
                 }
             }
         }
@@ -391,7 +472,7 @@ void MHP::handleRet(const CxtThreadStmt& cts)
 /*!
  * Handling intraprocedural statements (successive statements on the CFG )
  */
-void MHP::handleIntra(const CxtThreadStmt& cts)
+void MHP::handleIntra(RootInterleaving& ri, const CxtThreadStmt& cts)
 {
 
     InstVec nextInsts;
@@ -399,7 +480,7 @@ void MHP::handleIntra(const CxtThreadStmt& cts)
     for(InstVec::const_iterator nit = nextInsts.begin(), enit = nextInsts.end(); nit!=enit; ++nit)
     {
         CxtThreadStmt newCts(cts.getTid(),cts.getContext(),*nit);
-        addInterleavingThread(newCts,cts);
+        addInterleavingThread(ri,newCts,cts);
     }
 }
 
@@ -407,8 +488,9 @@ void MHP::handleIntra(const CxtThreadStmt& cts)
 /*!
  * Update interleavings of ancestor threads according to TCT
  */
-void MHP::updateAncestorThreads(NodeID curTid)
+void MHP::updateAncestorThreads(RootInterleaving& ri)
 {
+    NodeID curTid = ri.getRootTid();
     NodeBS tds = tct->getAncestorThread(curTid);
     DBOUT(DMTA,outs() << "##Ancestor thread of " << curTid << " is : ");
     DBOUT(DMTA,dumpSet(tds));
@@ -426,7 +508,7 @@ void MHP::updateAncestorThreads(NodeID curTid)
             for(InstVec::const_iterator nit = nextInsts.begin(), enit = nextInsts.end(); nit!=enit; ++nit)
             {
                 CxtThreadStmt cts(tct->getParentThread(*it),forkSiteCxt,*nit);
-                addInterleavingThread(cts,curTid);
+                addInterleavingThread(ri,cts,curTid);
             }
         }
     }
@@ -442,8 +524,9 @@ void MHP::updateAncestorThreads(NodeID curTid)
  * or
  * (2) Sibling HB t
  */
-void MHP::updateSiblingThreads(NodeID curTid)
+void MHP::updateSiblingThreads(RootInterleaving& ri)
 {
+    NodeID curTid = ri.getRootTid();
     NodeBS tds = tct->getAncestorThread(curTid);
     tds.set(curTid);
     for(NodeBS::iterator cit = tds.begin(), ecit = tds.end(); cit!=ecit; ++cit)
@@ -459,7 +542,7 @@ void MHP::updateSiblingThreads(NodeID curTid)
             const Function* routine = tct->getStartRoutineOfCxtThread(ct);
             const Instruction* stmt = &(routine->getEntryBlock().front());
             CxtThreadStmt cts(*it,ct.getContext(),stmt);
-            addInterleavingThread(cts,curTid);
+            addInterleavingThread(ri,cts,curTid);
         }
 
         DBOUT(DMTA,outs() << "##Sibling thread of " << curTid << " is : ");
@@ -519,6 +602,7 @@ bool MHP::isMustJoin(NodeID curTid, const Instruction* joinsite)
 NodeBS MHP::getDirAndIndJoinedTid(const CallStrCxt& cxt, const Instruction* call)
 {
     CxtStmt cs(cxt,call);
+    std::lock_guard<std::mutex> guard(joinedTidMutex);
     return fja->getDirAndIndJoinedTid(cs);
 }
 
@@ -345,7 +345,6 @@ void BVDataPTAImpl::onTheFlyCallGraphSolve(const CallSiteToFunPtrMap& callsites,
  */
 void BVDataPTAImpl::normalizePointsTo() {
     PAG::MemObjToFieldsMap &memToFieldsMap = pag->getMemToFieldsMap();
-    PAG::NodeLocationSetMap &GepObjNodeMap = pag->getGepObjNodeMap();
 
     // collect each gep node whose base node has been set as field-insensitive
     NodeBS dropNodes;
@@ -383,7 +382,7 @@ void BVDataPTAImpl::normalizePointsTo() {
         NodeID base = pag->getBaseObjNode(n);
         GepObjPN *gepNode = SVFUtil::dyn_cast<GepObjPN>(pag->getPAGNode(n));
         const LocationSet ls = gepNode->getLocationSet();
-        GepObjNodeMap.erase(std::make_pair(base, ls));
+        pag->removeGepObjNodeEntry(base, ls);
         memToFieldsMap[base].reset(n);
 
         pag->removeGNode(gepNode);
@@ -0,0 +1,675 @@
+#include "RustIsolation/IsolationSummary.h"
+#include "RustIsolation/MPKRustIsolation.h"
+#include "RustIsolation/StructuralHash.h"
+#include "Util/ExtAPI.h"
+#include "Util/PhaseProfiler.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/IR/DebugInfoMetadata.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+#include <fstream>
+#include <sstream>
+
+IsolationSummaryMap LoadedIsolationSummaries;
+
+/// A summarized function, reduced to a declaration, and the copy of its body
+struct SummarizedBody
+{
+    Function* F;
+    Function* saved;
+    GlobalValue::LinkageTypes linkage;
+};
+static std::vector<SummarizedBody> SummarizedBodies;
+
+/// Holds the saved bodies outside the analyzed modules; they refer to
+/// declarations of this module only, so the globals of the analyzed modules
+/// see no users from outside
+static std::unique_ptr<Module> SummarizedBodiesModule;
+/// Declaration in SummarizedBodiesModule -> global of an analyzed module
+static Map<const GlobalValue*, GlobalValue*> SummarizedBodyRefs;
+/// and back
+static Map<const GlobalValue*, GlobalValue*> SummarizedBodyDecls;
+
+namespace
+{
+
+/// What a value may point to: pointees of some parameters, objects (stack or
+/// heap) allocated inside the function and/or memory of unknown origin
+/// (globals, pointers loaded from memory that is not a local object)
+struct Origin
+{
+    u64_t params = 0;
+    bool local = false;
+    bool unknown = false;
+
+    inline bool merge(const Origin& rhs)
+    {
+        bool changed = (params | rhs.params) != params || (rhs.local && !local) || (rhs.unknown && !unknown);
+        params |= rhs.params;
+        local |= rhs.local;
+        unknown |= rhs.unknown;
+        return changed;
+    }
+    inline bool empty() const
+    {
+        return params == 0 && !local && !unknown;
+    }
+};
+
+/*!
+ * Flow-insensitive summary of one function. Values are tracked through
+ * casts, arithmetic, loads and stores into local allocas; everything stored
+ * elsewhere or passed to an unknown callee escapes.
+ */
+class FunctionSummarizer
+{
+public:
+    FunctionSummarizer(const Function& fun, const IsolationSummaryMap& crate)
+        : F(fun), DL(fun.getParent()->getDataLayout()), crateSummaries(crate)
+    {
+    }
+
+    IsolationSummary summarize()
+    {
+        u32_t argNo = 0;
+        for (const Argument& arg : F.args())
+            valOrigins[&arg].params = 1ULL << argNo++;
+
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            for (const BasicBlock& BB : F)
+                for (const Instruction& I : BB)
+                    changed |= visit(I);
+        }
+        if (retLocal && localUnsafe)
+            summary.flags |= IsolationSummary::RetUnsafe;
+        return summary;
+    }
+
+private:
+    const Function& F;
+    const DataLayout& DL;
+    const IsolationSummaryMap& crateSummaries;
+    Map<const Value*, Origin> valOrigins;
+    Map<const Value*, Origin> memOrigins;
+    IsolationSummary summary;
+    bool localUnsafe = false;
+    bool retLocal = false;
+
+    inline Origin getOrigin(const Value* V) const
+    {
+        auto it = valOrigins.find(V);
+        if (it != valOrigins.end())
+            return it->second;
+        Origin o;
+        if (llvm::isa<Constant>(V) && llvm::isa<GlobalVariable>(llvm::GetUnderlyingObject(V, DL)))
+            o.unknown = true;
+        return o;
+    }
+
+    inline const AllocaInst* getLocalObject(const Value* ptr) const
+    {
+        return llvm::dyn_cast<AllocaInst>(llvm::GetUnderlyingObject(ptr, DL));
+    }
+
+    /// Pointers loaded from a local alloca are the ones stored into it, anything
+    /// else loaded through a pointer may point where the pointer does or to
+    /// whatever the caller or a global stored there
+    inline Origin getContents(const Value* ptr, bool mayHoldPointers)
+    {
+        if (const AllocaInst* obj = getLocalObject(ptr))
+            return memOrigins[obj];
+        Origin o = getOrigin(ptr);
+        o.unknown |= mayHoldPointers;
+        return o;
+    }
+
+    const IsolationSummary* getCalleeSummary(const Function* callee) const
+    {
+        auto it = crateSummaries.find(callee->getName().str());
+        if (it != crateSummaries.end())
+            return &it->second;
+        it = LoadedIsolationSummaries.find(callee->getName().str());
+        if (it != LoadedIsolationSummaries.end())
+            return &it->second;
+        return nullptr;
+    }
+
+    void markUnsafe(const Origin& o)
+    {
+        summary.unsafeParams |= o.params;
+        localUnsafe |= o.local;
+        if (o.local)
+            summary.flags |= IsolationSummary::LocalUnsafe;
+        if (o.unknown)
+            summary.flags |= IsolationSummary::UnknownOrigin;
+    }
+
+    void markEscaped(const Origin& o)
+    {
+        summary.storedParams |= o.params;
+        if (o.local)
+            summary.flags |= IsolationSummary::RetAlloc;
+        if (o.unknown)
+            summary.flags |= IsolationSummary::UnknownOrigin;
+    }
+
+    bool storeInto(const Value* ptr, const Origin& o)
+    {
+        if (o.empty())
+            return false;
+        if (const AllocaInst* obj = getLocalObject(ptr))
+            return memOrigins[obj].merge(o);
+        markEscaped(o);
+        return false;
+    }
+
+    bool visitCall(const CallBase& CB)
+    {
+        bool changed = false;
+        Origin result;
+        const Function* callee = CB.getCalledFunction();
+
+        if (const llvm::MemTransferInst* MT = llvm::dyn_cast<llvm::MemTransferInst>(&CB))
+        {
+            return storeInto(MT->getRawDest(), getContents(MT->getRawSource(), true));
+        }
+        else if (llvm::isa<llvm::IntrinsicInst>(&CB))
+            return false;
+        else if (callee == nullptr)
+        {
+            if (!CB.isInlineAsm())
+                summary.flags |= IsolationSummary::IndirectCalls;
+            result.local = true;
+            result.unknown = true;
+            for (const Use& arg : CB.args())
+            {
+                markEscaped(getOrigin(arg.get()));
+                result.merge(getOrigin(arg.get()));
+            }
+        }
+        else if (const IsolationSummary* S = getCalleeSummary(callee))
+        {
+            u32_t argNo = 0;
+            for (const Use& arg : CB.args())
+            {
+                Origin o = getOrigin(arg.get());
+                u64_t bit = argNo < 64 ? 1ULL << argNo : 0;
+                if (bit == 0 || (S->storedParams & bit))
+                    markEscaped(o);
+                if (S->unsafeParams & bit)
+                    markUnsafe(o);
+                if (S->retParams & bit)
+                    result.merge(o);
+                argNo++;
+            }
+            if (S->flags & IsolationSummary::RetAlloc)
+                result.local = true;
+            if (S->flags & IsolationSummary::UnknownOrigin)
+                result.unknown = true;
+            summary.flags |= S->flags & (IsolationSummary::IndirectCalls | IsolationSummary::UnknownOrigin);
+        }
+        else
+        {
+            SVFFunction svfCallee(const_cast<Function*>(callee));
+            ExtAPI::extf_t type = ExtAPI::getExtAPI()->get_type(&svfCallee);
+            if (type == ExtAPI::EFT_ALLOC || type == ExtAPI::EFT_NOSTRUCT_ALLOC || type == ExtAPI::EFT_REALLOC)
+                result.local = true;
+            if (type == ExtAPI::EFT_REALLOC && CB.arg_size() > 0)
+                result.merge(getOrigin(CB.getArgOperand(0)));
+            else if (type == ExtAPI::EFT_OTHER)
+            {
+                /// not modeled or not summarized: arguments escape and may come back through the return value
+                result.local = true;
+                result.unknown = true;
+                for (const Use& arg : CB.args())
+                {
+                    markEscaped(getOrigin(arg.get()));
+                    result.merge(getOrigin(arg.get()));
+                }
+            }
+            else if (ExtAPI::getExtAPI()->has_static(&svfCallee))
+                result.unknown = true;
+            else if (type >= ExtAPI::EFT_L_A0 && type <= ExtAPI::EFT_L_A8)
+            {
+                for (const Use& arg : CB.args())
+                    result.merge(getOrigin(arg.get()));
+            }
+            else if (type != ExtAPI::EFT_NOOP && type != ExtAPI::EFT_FREE && !ExtAPI::getExtAPI()->is_alloc(&svfCallee))
+            {
+                /// copies between the arguments and their pointees: whatever an
+                /// argument points to may be stored through any other argument
+                Origin stored;
+                if (ExtAPI::getExtAPI()->is_arg_alloc(&svfCallee))
+                    stored.local = true;
+                for (const Use& arg : CB.args())
+                {
+                    stored.merge(getOrigin(arg.get()));
+                    result.merge(getOrigin(arg.get()));
+                }
+                for (const Use& arg : CB.args())
+                {
+                    if (arg->getType()->isPointerTy())
+                        changed |= storeInto(arg.get(), stored);
+                }
+            }
+        }
+
+        /// callees may write their results through pointers to local objects (e.g., sret)
+        for (const Use& arg : CB.args())
+        {
+            if (const AllocaInst* obj = getLocalObject(arg.get()))
+                changed |= memOrigins[obj].merge(result);
+        }
+        changed |= valOrigins[&CB].merge(result);
+        return changed;
+    }
+
+    bool visit(const Instruction& I)
+    {
+        bool changed = false;
+        if (I.getMetadata("MPK-Unsafe") != nullptr)
+        {
+            for (const Use& opnd : I.operands())
+                markUnsafe(getOrigin(opnd.get()));
+            if (const Value* ptr = llvm::getLoadStorePointerOperand(&I))
+            {
+                if (getLocalObject(ptr))
+                    markUnsafe(Origin{0, true});
+            }
+        }
+
+        if (const AllocaInst* AI = llvm::dyn_cast<AllocaInst>(&I))
+            changed |= valOrigins[AI].merge(Origin{0, true});
+        else if (const LoadInst* LI = llvm::dyn_cast<LoadInst>(&I))
+        {
+            changed |= valOrigins[LI].merge(getContents(LI->getPointerOperand(), LI->getType()->isPointerTy()));
+        }
+        else if (const StoreInst* SI = llvm::dyn_cast<StoreInst>(&I))
+            changed |= storeInto(SI->getPointerOperand(), getOrigin(SI->getValueOperand()));
+        else if (const CallBase* CB = llvm::dyn_cast<CallBase>(&I))
+            changed |= visitCall(*CB);
+        else if (const ReturnInst* RI = llvm::dyn_cast<ReturnInst>(&I))
+        {
+            if (const Value* ret = RI->getReturnValue())
+            {
+                Origin o = getOrigin(ret);
+                summary.retParams |= o.params;
+                if (o.local)
+                    summary.flags |= IsolationSummary::RetAlloc;
+                if (o.unknown)
+                    summary.flags |= IsolationSummary::UnknownOrigin;
+                retLocal |= o.local;
+            }
+        }
+        else
+        {
+            /// casts, GEPs, phis, selects, aggregates and pointer arithmetic
+            Origin o;
+            for (const Use& opnd : I.operands())
+                o.merge(getOrigin(opnd.get()));
+            if (!o.empty())
+                changed |= valOrigins[&I].merge(o);
+        }
+        return changed;
+    }
+};
+
+} // End anonymous namespace
+
+static inline bool isSummarizable(const Function& F)
+{
+    return !F.isDeclaration() && F.arg_size() <= 64;
+}
+
+void loadIsolationSummaries()
+{
+    std::stringstream files(Options::MpkSummaries);
+    std::string file;
+    while (std::getline(files, file, ','))
+    {
+        std::ifstream in(file);
+        if (!in.is_open())
+        {
+            SVFUtil::errs() << "Unable to read isolation summaries " << file << "\n";
+            continue;
+        }
+        std::string line;
+        while (std::getline(in, line))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+            std::istringstream fields(line);
+            std::string name;
+            IsolationSummary S;
+            fields >> name >> std::hex >> S.unsafeParams >> S.retParams >> S.storedParams >> S.flags;
+            if (fields.fail())
+            {
+                SVFUtil::errs() << "Malformed isolation summary in " << file << ": " << line << "\n";
+                continue;
+            }
+            LoadedIsolationSummaries[name] = S;
+        }
+    }
+}
+
+/*!
+ * Summarize the defined functions of the modules. Callees in the modules start
+ * from the empty summary and the summaries are iterated to a fixpoint. Only the
+ * representative of each structural class is summarized, the other members
+ * get its summary.
+ */
+static void summarizeCrate(const std::vector<std::reference_wrapper<Module>>& modules,
+                           const StructuralClassMap& representatives, IsolationSummaryMap& crate)
+{
+    for (auto& it : representatives)
+        crate[it.first->getName().str()] = IsolationSummary();
+
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (Module& M : modules)
+        {
+            for (const Function& F : M)
+            {
+                auto rep = representatives.find(&F);
+                if (rep == representatives.end())
+                    continue;
+                IsolationSummary S = rep->second == &F ? FunctionSummarizer(F, crate).summarize()
+                                                       : crate[rep->second->getName().str()];
+                IsolationSummary& old = crate[F.getName().str()];
+                if (!(S == old))
+                {
+                    old = S;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+void emitIsolationSummaries(const std::vector<std::reference_wrapper<Module>>& modules)
+{
+    StructuralClassMap representatives;
+    computeStructuralClasses(modules, representatives);
+    IsolationSummaryMap crate;
+    summarizeCrate(modules, representatives, crate);
+
+    std::error_code EC;
+    raw_fd_ostream OS(Options::MpkEmitSummary, EC, llvm::sys::fs::F_None);
+    if (EC)
+    {
+        SVFUtil::errs() << "Unable to write isolation summaries " << Options::MpkEmitSummary << "\n";
+        return;
+    }
+    OS << "# name unsafe-params ret-params stored-params flags\n";
+    u32_t numEmitted = 0;
+    for (Module& M : modules)
+    {
+        for (const Function& F : M)
+        {
+            if (!isSummarizable(F) || F.hasLocalLinkage())
+                continue;
+            const IsolationSummary& S = crate[F.getName().str()];
+            OS << F.getName() << " ";
+            OS.write_hex(S.unsafeParams) << " ";
+            OS.write_hex(S.retParams) << " ";
+            OS.write_hex(S.storedParams) << " ";
+            OS.write_hex(S.flags) << "\n";
+            numEmitted++;
+        }
+    }
+    if (PhaseProfiler::isEnabled())
+        PhaseProfiler::getProfiler()->addStat("Emitted Isolation Summaries", numEmitted);
+}
+
+/*!
+ * Drop the dummy loads/stores added by addDummyLoads, they must not be
+ * written out with the body when it is restored
+ */
+static void removeDummyLoads(Function& F)
+{
+    std::vector<Instruction*> toRemove;
+    for (auto& BB : F)
+        for (auto& I : BB)
+            if (I.getMetadata("MPK-Dummy-Load") != nullptr)
+                toRemove.push_back(&I);
+    while (!toRemove.empty())
+    {
+        toRemove.back()->eraseFromParent();
+        toRemove.pop_back();
+    }
+}
+
+/// Make the pointees of the unsafe parameters visible to the analysis the same
+/// way addDummyLoads does for the arguments of unsafe calls
+static void addSummaryDummyLoads(CallBase* CB, const IsolationSummary& S)
+{
+    LLVMContext &C = CB->getContext();
+    for (u32_t argNo = 0; argNo < CB->arg_size() && argNo < 64; argNo++)
+    {
+        Value* callArg = CB->getArgOperand(argNo);
+        if (!(S.unsafeParams & (1ULL << argNo)) || !callArg->getType()->isPointerTy())
+            continue;
+        BitCastInst *bitCastInst = new BitCastInst(callArg, callArg->getType()->getPointerTo(0),
+                                                   "dummy_bit_cast", CB);
+        LoadInst *dummyLoad = new LoadInst(callArg->getType(), bitCastInst, "", CB);
+        MDNode *N = MDNode::get(C, MDString::get(C, "Dummy Load To help with PTA"));
+        dummyLoad->setMetadata("MPK-Dummy-Load", N);
+        bitCastInst->setMetadata("MPK-Dummy-Load", N);
+        MDNode *NN = MDNode::get(C, MDString::get(C, "Summarized unsafe parameter"));
+        dummyLoad->setMetadata("MPK-Unsafe", NN);
+    }
+}
+
+/// Globals referenced by the body of F, through constant expressions included
+static void collectReferencedGlobals(const Function& F, llvm::SetVector<GlobalValue*>& globals)
+{
+    std::vector<const Constant*> worklist;
+    Set<const Constant*> visited;
+    if (F.hasPersonalityFn())
+        worklist.push_back(F.getPersonalityFn());
+    for (const BasicBlock& BB : F)
+        for (const Instruction& I : BB)
+            for (const Value* op : I.operands())
+                if (const Constant* C = llvm::dyn_cast<Constant>(op))
+                    worklist.push_back(C);
+    while (!worklist.empty())
+    {
+        const Constant* C = worklist.back();
+        worklist.pop_back();
+        if (!visited.insert(C).second)
+            continue;
+        if (const GlobalValue* GV = llvm::dyn_cast<GlobalValue>(C))
+        {
+            globals.insert(const_cast<GlobalValue*>(GV));
+            continue;
+        }
+        for (const Value* op : C->operands())
+            worklist.push_back(llvm::cast<Constant>(op));
+    }
+}
+
+/// Declaration standing for GV in SummarizedBodiesModule
+static GlobalValue* getSummarizedBodyDecl(GlobalValue* GV)
+{
+    GlobalValue*& decl = SummarizedBodyDecls[GV];
+    if (decl)
+        return decl;
+    Module& scratch = *SummarizedBodiesModule;
+    if (FunctionType* FT = llvm::dyn_cast<FunctionType>(GV->getValueType()))
+        decl = Function::Create(FT, GlobalValue::ExternalLinkage,
+                                GV->getAddressSpace(), GV->getName(), &scratch);
+    else
+        decl = new GlobalVariable(scratch, GV->getValueType(), false, GlobalValue::ExternalLinkage,
+                                  nullptr, GV->getName(), nullptr, GlobalValue::NotThreadLocal,
+                                  GV->getAddressSpace());
+    SummarizedBodyRefs[decl] = GV;
+    return decl;
+}
+
+/// Clone the body of F into SummarizedBodiesModule; the attached debug info
+/// is shared, not duplicated
+static SummarizedBody saveBody(Function& F)
+{
+    if (!SummarizedBodiesModule)
+        SummarizedBodiesModule = std::make_unique<Module>("mpk.summarized", F.getContext());
+
+    llvm::ValueToValueMapTy VMap;
+    llvm::SetVector<GlobalValue*> globals;
+    collectReferencedGlobals(F, globals);
+    for (GlobalValue* GV : globals)
+        VMap[GV] = getSummarizedBodyDecl(GV);
+    if (llvm::DISubprogram* SP = F.getSubprogram())
+        VMap.MD()[SP].reset(SP);
+
+    Function* saved = Function::Create(F.getFunctionType(), GlobalValue::ExternalLinkage,
+                                       F.getAddressSpace(), F.getName(), SummarizedBodiesModule.get());
+    for (u32_t argNo = 0; argNo < F.arg_size(); argNo++)
+        VMap[F.getArg(argNo)] = saved->getArg(argNo);
+    SmallVector<ReturnInst*, 8> Returns;
+    CloneFunctionInto(saved, &F, VMap, false, Returns);
+    return SummarizedBody{&F, saved, F.getLinkage()};
+}
+
+/// Clone the saved body back into its function
+static void restoreBody(const SummarizedBody& body)
+{
+    llvm::ValueToValueMapTy VMap;
+    llvm::SetVector<GlobalValue*> globals;
+    collectReferencedGlobals(*body.saved, globals);
+    for (GlobalValue* decl : globals)
+        VMap[decl] = SummarizedBodyRefs[decl];
+    if (llvm::DISubprogram* SP = body.saved->getSubprogram())
+        VMap.MD()[SP].reset(SP);
+
+    for (u32_t argNo = 0; argNo < body.F->arg_size(); argNo++)
+        VMap[body.saved->getArg(argNo)] = body.F->getArg(argNo);
+    SmallVector<ReturnInst*, 8> Returns;
+    CloneFunctionInto(body.F, body.saved, VMap, false, Returns);
+    body.F->setLinkage(body.linkage);
+}
+
+/*!
+ * Add the parameter effects of the summarized functions at their call sites
+ * in M, and reduce those defined in M to declarations; their bodies are saved
+ * outside the analyzed modules
+ */
+static void takeOutSummarizedBodies(Module& M, const Map<const Function*, const IsolationSummary*>& summarized)
+{
+    for (Function& F : M)
+    {
+        if (F.isDeclaration() || summarized.count(&F))
+            continue;
+        for (auto& BB : F)
+        {
+            for (auto& I : BB)
+            {
+                CallBase* CB = llvm::dyn_cast<CallBase>(&I);
+                if (CB == nullptr || CB->getCalledFunction() == nullptr)
+                    continue;
+                auto it = summarized.find(CB->getCalledFunction());
+                if (it != summarized.end() && !isRustLibraryFunc(it->first))
+                    addSummaryDummyLoads(CB, *it->second);
+            }
+        }
+    }
+
+    for (auto& it : summarized)
+    {
+        Function* F = const_cast<Function*>(it.first);
+        if (F->getParent() != &M)
+            continue;
+        removeDummyLoads(*F);
+        SummarizedBodies.push_back(saveBody(*F));
+        F->deleteBody();
+    }
+}
+
+/// Whether the body of F can be replaced by its summary S
+static inline bool canTakeOutBody(const Function& F, const IsolationSummary& S)
+{
+    if (F.getName() == "main" || !S.isSelfContained())
+        return false;
+    /// blockaddress constants would refer to a deleted body
+    for (const BasicBlock& BB : F)
+        if (BB.hasAddressTaken())
+            return false;
+    /// indirect call sites would not get the parameter effects
+    return !(S.unsafeParams && F.hasAddressTaken());
+}
+
+void applyIsolationSummaries(Module& M)
+{
+    if (LoadedIsolationSummaries.empty())
+        return;
+
+    Map<const Function*, const IsolationSummary*> summarized;
+    for (Function& F : M)
+    {
+        if (F.isDeclaration())
+            continue;
+        auto it = LoadedIsolationSummaries.find(F.getName().str());
+        if (it != LoadedIsolationSummaries.end() && canTakeOutBody(F, it->second))
+            summarized[&F] = &it->second;
+    }
+
+    takeOutSummarizedBodies(M, summarized);
+    if (PhaseProfiler::isEnabled())
+        PhaseProfiler::getProfiler()->addStat("Summarized Functions", summarized.size());
+}
+
+void shareStructuralSummaries(const std::vector<std::reference_wrapper<Module>>& modules)
+{
+    PhaseTimer timer("Structural sharing");
+
+    StructuralClassMap representatives;
+    computeStructuralClasses(modules, representatives);
+    IsolationSummaryMap crate;
+    summarizeCrate(modules, representatives, crate);
+
+    /// the representatives stay in the analysis
+    Map<const Function*, const IsolationSummary*> summarized;
+    u32_t numClasses = 0;
+    for (auto& it : representatives)
+    {
+        const Function* F = it.first;
+        if (F == it.second)
+        {
+            numClasses++;
+            continue;
+        }
+        const IsolationSummary& S = crate[F->getName().str()];
+        if (canTakeOutBody(*F, S))
+            summarized[F] = &S;
+    }
+
+    for (Module& M : modules)
+        takeOutSummarizedBodies(M, summarized);
+    if (PhaseProfiler::isEnabled())
+    {
+        PhaseProfiler::getProfiler()->addStat("Structural Classes", numClasses);
+        PhaseProfiler::getProfiler()->addStat("Shared Functions", summarized.size());
+    }
+}
+
+void restoreSummarizedBodies()
+{
+    for (const SummarizedBody& body : SummarizedBodies)
+        restoreBody(body);
+    SummarizedBodies.clear();
+    SummarizedBodyRefs.clear();
+    SummarizedBodyDecls.clear();
+    SummarizedBodiesModule.reset();
+}
+
+void releaseIsolationSummaries()
+{
+    restoreSummarizedBodies();
+    LoadedIsolationSummaries.clear();
+}
@@ -0,0 +1,281 @@
+#include "RustIsolation/StructuralHash.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/IR/InstrTypes.h"
+
+namespace
+{
+
+typedef Map<const Function*, size_t> FunctionHashMap;
+
+/*!
+ * Hash of a function body in which values are named by their position:
+ * arguments by number, instructions and blocks by their order in the body,
+ * callees by their structural class. Types only contribute their kind (no
+ * struct names, integer widths or array lengths), constants only their kind
+ * (no sizes or offsets), globals only that they are globals.
+ */
+class StructuralHasher
+{
+public:
+    StructuralHasher(const Function& fun, const FunctionHashMap& cls) : F(fun), classes(cls)
+    {
+    }
+
+    size_t hash()
+    {
+        u32_t blockNo = 0, instNo = 0;
+        for (const BasicBlock& BB : F)
+        {
+            blockNumbers[&BB] = blockNo++;
+            for (const Instruction& I : BB)
+                instNumbers[&I] = instNo++;
+        }
+
+        llvm::hash_code h = llvm::hash_combine(F.arg_size(), F.isVarArg(), F.getReturnType()->getTypeID());
+        for (const BasicBlock& BB : F)
+        {
+            h = llvm::hash_combine(h, BB.size());
+            for (const Instruction& I : BB)
+                h = llvm::hash_combine(h, hashInstruction(I));
+        }
+        return h;
+    }
+
+private:
+    const Function& F;
+    const FunctionHashMap& classes;
+    Map<const BasicBlock*, u32_t> blockNumbers;
+    Map<const Instruction*, u32_t> instNumbers;
+
+    llvm::hash_code hashInstruction(const Instruction& I)
+    {
+        llvm::hash_code h = llvm::hash_combine(I.getOpcode(), I.getType()->getTypeID(), I.getNumOperands(),
+                                               I.getMetadata("MPK-Unsafe") != nullptr,
+                                               I.getMetadata("MPK-Dummy-Load") != nullptr);
+        if (const CmpInst* cmp = llvm::dyn_cast<CmpInst>(&I))
+            h = llvm::hash_combine(h, cmp->getPredicate());
+        for (const Use& opnd : I.operands())
+            h = llvm::hash_combine(h, hashOperand(opnd.get()));
+        return h;
+    }
+
+    llvm::hash_code hashOperand(const Value* V)
+    {
+        if (const Argument* arg = llvm::dyn_cast<Argument>(V))
+            return llvm::hash_combine(1, arg->getArgNo());
+        if (const Instruction* I = llvm::dyn_cast<Instruction>(V))
+            return llvm::hash_combine(2, instNumbers[I]);
+        if (const BasicBlock* BB = llvm::dyn_cast<BasicBlock>(V))
+            return llvm::hash_combine(3, blockNumbers[BB]);
+        if (const Function* callee = llvm::dyn_cast<Function>(V))
+            return llvm::hash_combine(4, getClass(callee));
+        if (llvm::isa<GlobalValue>(V))
+            return llvm::hash_combine(5, V->getValueID());
+        if (const ConstantExpr* CE = llvm::dyn_cast<ConstantExpr>(V))
+        {
+            llvm::hash_code h = llvm::hash_combine(6, CE->getOpcode());
+            for (const Use& opnd : CE->operands())
+                h = llvm::hash_combine(h, hashOperand(opnd.get()));
+            return h;
+        }
+        return llvm::hash_combine(7, V->getValueID(), V->getType()->getTypeID());
+    }
+
+    /// Functions outside the classes (declarations, functions that are never
+    /// summarized) are told apart by name, as the summaries look them up by name
+    size_t getClass(const Function* callee) const
+    {
+        auto it = classes.find(callee);
+        if (it != classes.end())
+            return it->second;
+        if (callee->isIntrinsic())
+            return llvm::hash_combine(callee->getIntrinsicID());
+        return llvm::hash_value(callee->getName());
+    }
+};
+
+/*!
+ * Compares two function bodies in parallel, with the same leniency as the
+ * hasher: values by position, types and constants only by their kind, callees
+ * by their group.
+ */
+class StructuralComparator
+{
+public:
+    StructuralComparator(const Function& fun1, const Function& fun2, const StructuralClassMap& grps)
+        : F1(fun1), F2(fun2), groups(grps)
+    {
+    }
+
+    bool equal()
+    {
+        if (F1.arg_size() != F2.arg_size() || F1.isVarArg() != F2.isVarArg() ||
+                F1.getReturnType()->getTypeID() != F2.getReturnType()->getTypeID() || F1.size() != F2.size())
+            return false;
+
+        for (auto BB1 = F1.begin(), BB2 = F2.begin(); BB1 != F1.end(); ++BB1, ++BB2)
+        {
+            if (BB1->size() != BB2->size())
+                return false;
+            blocks[&*BB1] = &*BB2;
+            for (auto I1 = BB1->begin(), I2 = BB2->begin(); I1 != BB1->end(); ++I1, ++I2)
+                insts[&*I1] = &*I2;
+        }
+
+        for (auto& it : insts)
+            if (!sameInstruction(*it.first, *it.second))
+                return false;
+        return true;
+    }
+
+private:
+    const Function& F1;
+    const Function& F2;
+    const StructuralClassMap& groups;
+    Map<const BasicBlock*, const BasicBlock*> blocks;
+    Map<const Instruction*, const Instruction*> insts;
+
+    bool sameInstruction(const Instruction& I1, const Instruction& I2) const
+    {
+        if (I1.getOpcode() != I2.getOpcode() || I1.getType()->getTypeID() != I2.getType()->getTypeID() ||
+                I1.getNumOperands() != I2.getNumOperands() ||
+                (I1.getMetadata("MPK-Unsafe") != nullptr) != (I2.getMetadata("MPK-Unsafe") != nullptr) ||
+                (I1.getMetadata("MPK-Dummy-Load") != nullptr) != (I2.getMetadata("MPK-Dummy-Load") != nullptr))
+            return false;
+        if (const CmpInst* cmp = llvm::dyn_cast<CmpInst>(&I1))
+        {
+            if (cmp->getPredicate() != llvm::cast<CmpInst>(I2).getPredicate())
+                return false;
+        }
+        for (u32_t i = 0; i < I1.getNumOperands(); i++)
+            if (!sameOperand(I1.getOperand(i), I2.getOperand(i)))
+                return false;
+        return true;
+    }
+
+    bool sameOperand(const Value* V1, const Value* V2) const
+    {
+        if (const Argument* arg = llvm::dyn_cast<Argument>(V1))
+            return llvm::isa<Argument>(V2) && llvm::cast<Argument>(V2)->getArgNo() == arg->getArgNo();
+        if (const Instruction* I = llvm::dyn_cast<Instruction>(V1))
+        {
+            auto it = insts.find(I);
+            return it != insts.end() && it->second == V2;
+        }
+        if (const BasicBlock* BB = llvm::dyn_cast<BasicBlock>(V1))
+        {
+            auto it = blocks.find(BB);
+            return it != blocks.end() && it->second == V2;
+        }
+        if (const Function* callee = llvm::dyn_cast<Function>(V1))
+            return llvm::isa<Function>(V2) && sameCallee(callee, llvm::cast<Function>(V2));
+        if (llvm::isa<GlobalValue>(V1))
+            return llvm::isa<GlobalValue>(V2) && !llvm::isa<Function>(V2) && V1->getValueID() == V2->getValueID();
+        if (const ConstantExpr* CE1 = llvm::dyn_cast<ConstantExpr>(V1))
+        {
+            const ConstantExpr* CE2 = llvm::dyn_cast<ConstantExpr>(V2);
+            if (CE2 == nullptr || CE1->getOpcode() != CE2->getOpcode() || CE1->getNumOperands() != CE2->getNumOperands())
+                return false;
+            for (u32_t i = 0; i < CE1->getNumOperands(); i++)
+                if (!sameOperand(CE1->getOperand(i), CE2->getOperand(i)))
+                    return false;
+            return true;
+        }
+        if (llvm::isa<Argument>(V2) || llvm::isa<Instruction>(V2) || llvm::isa<BasicBlock>(V2) ||
+                llvm::isa<GlobalValue>(V2) || llvm::isa<ConstantExpr>(V2))
+            return false;
+        return V1->getValueID() == V2->getValueID() && V1->getType()->getTypeID() == V2->getType()->getTypeID();
+    }
+
+    /// Same rules as StructuralHasher::getClass
+    bool sameCallee(const Function* callee1, const Function* callee2) const
+    {
+        auto it1 = groups.find(callee1);
+        auto it2 = groups.find(callee2);
+        if (it1 != groups.end() || it2 != groups.end())
+            return it1 != groups.end() && it2 != groups.end() && it1->second == it2->second;
+        if (callee1->isIntrinsic() || callee2->isIntrinsic())
+            return callee1->getIntrinsicID() == callee2->getIntrinsicID();
+        return callee1->getName() == callee2->getName();
+    }
+};
+
+} // End anonymous namespace
+
+void computeStructuralClasses(const std::vector<std::reference_wrapper<Module>>& modules,
+                              StructuralClassMap& representatives)
+{
+    std::vector<const Function*> functions;
+    FunctionHashMap classes;
+    for (Module& M : modules)
+    {
+        for (const Function& F : M)
+        {
+            if (F.isDeclaration() || F.arg_size() > 64)
+                continue;
+            functions.push_back(&F);
+            classes[&F] = 0;
+        }
+    }
+
+    /// Every round hashes the bodies with the callee classes of the previous
+    /// one, so classes only split; stop when no class splits any more
+    u32_t numClasses = functions.empty() ? 0 : 1;
+    while (true)
+    {
+        FunctionHashMap refined;
+        Set<size_t> distinct;
+        for (const Function* F : functions)
+        {
+            size_t h = llvm::hash_combine(classes[F], StructuralHasher(*F, classes).hash());
+            refined[F] = h;
+            distinct.insert(h);
+        }
+        classes.swap(refined);
+        if (distinct.size() == numClasses)
+            break;
+        numClasses = distinct.size();
+    }
+
+    /// Split the hash classes into groups whose bodies compare equal, callees
+    /// compared by group; splitting a group may split its callers' groups, so
+    /// repeat until no group splits
+    StructuralClassMap groups;
+    Map<size_t, const Function*> firsts;
+    for (const Function* F : functions)
+        groups[F] = firsts.emplace(classes[F], F).first->second;
+    u32_t numGroups = firsts.size();
+    while (true)
+    {
+        StructuralClassMap refined;
+        Map<const Function*, std::vector<const Function*>> splits;
+        for (const Function* F : functions)
+        {
+            std::vector<const Function*>& reps = splits[groups[F]];
+            const Function* rep = nullptr;
+            for (const Function* candidate : reps)
+            {
+                if (StructuralComparator(*F, *candidate, groups).equal())
+                {
+                    rep = candidate;
+                    break;
+                }
+            }
+            if (rep == nullptr)
+            {
+                reps.push_back(F);
+                rep = F;
+            }
+            refined[F] = rep;
+        }
+        u32_t numRefined = 0;
+        for (auto& it : splits)
+            numRefined += it.second.size();
+        groups.swap(refined);
+        if (numRefined == numGroups)
+            break;
+        numGroups = numRefined;
+    }
+    for (const Function* F : functions)
+        representatives[F] = groups[F];
+}
@@ -32,6 +32,8 @@
 #include "SABER/SrcSnkDDA.h"
 #include "Graphs/SVFGStat.h"
 #include "SVF-FE/PAGBuilder.h"
+#include <atomic>
+#include <thread>
 
 using namespace SVF;
 using namespace SVFUtil;
@@ -39,6 +41,9 @@ using namespace SVFUtil;
 /// Initialize analysis
 void SrcSnkDDA::initialize(SVFModule* module)
 {
+    /// the memory SSA built with the SVFG already creates conditions
+    PathCondAllocator::createBddCondManager(module);
+
 	PAGBuilder builder;
 	PAG* pag = builder.build(module);
 
@@ -61,6 +66,13 @@ void SrcSnkDDA::analyze(SVFModule* module)
 
     ContextCond::setMaxCxtLen(Options::CxtLimit);
 
+    if (Options::SaberThreads > 1 && getSources().size() > 1)
+    {
+        analyzeSourcesInParallel(Options::SaberThreads);
+        finalize();
+        return;
+    }
+
     for (SVFGNodeSetIter iter = sourcesBegin(), eiter = sourcesEnd();
             iter != eiter; ++iter)
     {
@@ -181,12 +193,37 @@ void SrcSnkDDA::FWProcessOutgoingEdge(const DPIm& item, SVFGEdge* edge)
     const SVFGNode* dstNode = edge->getDstNode();
     DPIm newItem(dstNode->getId(),item.getContexts());
 
-    /// handle globals here
-    if(isGlobalSVFGNode(dstNode) || getCurSlice()->isReachGlobal())
+    if(propagateForward(getCurSlice(), edge, newItem) == false)
+        return;
+
+    /// whether this dstNode has been visited or not
+    if(forwardVisited(dstNode,newItem))
     {
-        getCurSlice()->setReachGlobal();
+        DBOUT(DSaber,outs() << " node "<< dstNode->getId() <<" has been visited\n");
         return;
     }
+    else
+        addForwardVisited(dstNode, newItem);
+
+    if(pushIntoWorklist(newItem))
+        DBOUT(DSaber,outs() << " --> " << edge->getDstID() << ", cxt size: " << newItem.getContexts().cxtSize() <<")\n");
+
+}
+
+/*!
+ * Match the context of newItem along a value-flow edge.
+ * Return false if newItem should not be propagated (a global is reached or contexts mismatch).
+ */
+bool SrcSnkDDA::propagateForward(ProgSlice* slice, const SVFGEdge* edge, DPIm& newItem)
+{
+    const SVFGNode* dstNode = edge->getDstNode();
+
+    /// handle globals here
+    if(isGlobalSVFGNode(dstNode) || slice->isReachGlobal())
+    {
+        slice->setReachGlobal();
+        return false;
+    }
 
 
     /// perform context sensitive reachability
@@ -214,23 +251,12 @@ void SrcSnkDDA::FWProcessOutgoingEdge(const DPIm& item, SVFGEdge* edge)
         if (newItem.matchContext(csId) == false)
         {
             DBOUT(DSaber, outs() << "-|-\n");
-            return;
+            return false;
         }
         DBOUT(DSaber, outs() << " pop cxt [" << csId << "] ");
     }
 
-    /// whether this dstNode has been visited or not
-    if(forwardVisited(dstNode,newItem))
-    {
-        DBOUT(DSaber,outs() << " node "<< dstNode->getId() <<" has been visited\n");
-        return;
-    }
-    else
-        addForwardVisited(dstNode, newItem);
-
-    if(pushIntoWorklist(newItem))
-        DBOUT(DSaber,outs() << " --> " << edge->getDstID() << ", cxt size: " << newItem.getContexts().cxtSize() <<")\n");
-
+    return true;
 }
 
 /*!
@@ -250,6 +276,116 @@ void SrcSnkDDA::BWProcessIncomingEdge(const DPIm&, SVFGEdge* edge)
     pushIntoWorklist(newItem);
 }
 
+/*!
+ * Check sources with numThreads workers.
+ *
+ * Slicing a source only reads the SVFG, so workers compute the forward and backward
+ * slices of a batch of sources with their own worklists and visited sets. CUDD is not
+ * reentrant, hence the guards of each slice are solved and its bugs are reported on
+ * this thread afterwards, in the same source order as the sequential analysis.
+ */
+void SrcSnkDDA::analyzeSourcesInParallel(u32_t numThreads)
+{
+    std::vector<const SVFGNode*> srcs(sourcesBegin(), sourcesEnd());
+    const u32_t batchSize = numThreads * 16;
+
+    for (u32_t begin = 0; begin < srcs.size(); begin += batchSize)
+    {
+        u32_t end = std::min(begin + batchSize, (u32_t) srcs.size());
+        std::vector<ProgSlice*> slices(end - begin, nullptr);
+
+        std::atomic<u32_t> nextSrc(begin);
+        std::vector<std::thread> workers;
+        for (u32_t i = 0; i < numThreads; ++i)
+        {
+            workers.push_back(std::thread([&]()
+            {
+                for (u32_t idx = nextSrc++; idx < end; idx = nextSrc++)
+                {
+                    ProgSlice* slice = new ProgSlice(srcs[idx], getPathAllocator(), getSVFG());
+                    sliceSource(slice);
+                    slices[idx - begin] = slice;
+                }
+            }));
+        }
+        for (std::thread& worker : workers)
+            worker.join();
+
+        for (ProgSlice* slice : slices)
+        {
+            if (_curSlice != nullptr)
+                delete _curSlice;
+            _curSlice = slice;
+
+            if (slice->isReachGlobal() == false)
+            {
+                if(Options::DumpSlice)
+                    annotateSlice(slice);
+
+                if(slice->AllPathReachableSolve()== true)
+                    slice->setAllReachable();
+            }
+
+            reportBug(slice);
+        }
+    }
+}
+
+/*!
+ * Compute the forward and backward slices of a source without touching the
+ * solver worklist or visited maps of this analysis
+ */
+void SrcSnkDDA::sliceSource(ProgSlice* slice)
+{
+    FIFOWorkList<DPIm> worklist;
+    SVFGNodeToDPItemsMap fwVisited;
+    SVFGNodeSet bwVisited;
+
+    ContextCond cxt;
+    worklist.push(DPIm(slice->getSource()->getId(),cxt));
+    while (!worklist.empty())
+    {
+        DPIm item = worklist.pop();
+        const SVFGNode* node = getNode(item.getCurNodeID());
+        if(isSink(node))
+        {
+            slice->addToSinks(node);
+            slice->addToForwardSlice(node);
+            slice->setPartialReachable();
+        }
+        else
+            slice->addToForwardSlice(node);
+
+        for (SVFGNode::const_iterator it = node->OutEdgeBegin(), eit = node->OutEdgeEnd(); it != eit; ++it)
+        {
+            const SVFGEdge* edge = *it;
+            DPIm newItem(edge->getDstID(),item.getContexts());
+            if(propagateForward(slice, edge, newItem) && fwVisited[edge->getDstNode()].insert(newItem).second)
+                worklist.push(newItem);
+        }
+    }
+
+    if (slice->isReachGlobal())
+        return;
+
+    for (SVFGNodeSetIter sit = slice->sinksBegin(), esit = slice->sinksEnd(); sit != esit; ++sit)
+        worklist.push(DPIm((*sit)->getId(),cxt));
+    while (!worklist.empty())
+    {
+        DPIm item = worklist.pop();
+        const SVFGNode* node = getNode(item.getCurNodeID());
+        if(slice->inForwardSlice(node))
+            slice->addToBackwardSlice(node);
+
+        for (SVFGNode::const_iterator it = node->InEdgeBegin(), eit = node->InEdgeEnd(); it != eit; ++it)
+        {
+            const SVFGNode* srcNode = (*it)->getSrcNode();
+            if(bwVisited.insert(srcNode).second)
+                worklist.push(DPIm(srcNode->getId(),cxt));
+        }
+    }
+}
+
 /// Set current slice
 void SrcSnkDDA::setCurSlice(const SVFGNode* src)
 {
@@ -285,6 +421,5 @@ void SrcSnkDDA::printBDDStat()
 {
 
     outs() << "BDD Mem usage: " << PathCondAllocator::getMemUsage() << "\n";
-    outs() << "BDD Number: " << PathCondAllocator::getCondNum() << "\n";
-    outs() << "BDD max live number: " << PathCondAllocator::getMaxLiveCondNumber() << "\n";
+    getSVFG()->getStat()->bddStat();
 }
@@ -31,10 +31,18 @@
 #include <queue>
 #include "Util/SVFModule.h"
 #include "Util/SVFUtil.h"
+#include "Util/ExtAPI.h"
+#include "Util/PhaseProfiler.h"
 #include "SVF-FE/LLVMUtil.h"
 #include "SVF-FE/SymbolTableInfo.h"
 #include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/ProfileData/InstrProfReader.h"
+#include "llvm/ProfileData/SampleProfReader.h"
+#include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/Instrumentation.h"
 #include "RustIsolation/MPKRustIsolation.h"
+#include "RustIsolation/IsolationSummary.h"
 
 using namespace std;
 using namespace SVF;
@@ -59,8 +67,20 @@ using namespace SVF;
 LLVMModuleSet *LLVMModuleSet::llvmModuleSet = nullptr;
 std::string SVFModule::pagReadFromTxt = "";
 
+/*!
+ * Release the modules, together with the caches keyed by their functions
+ */
+void LLVMModuleSet::releaseLLVMModuleSet()
+{
+    if (llvmModuleSet)
+        delete llvmModuleSet;
+    llvmModuleSet = nullptr;
+    ThreadAPI::getThreadAPI()->releaseRustTDAPIs();
+}
+
 SVFModule* LLVMModuleSet::buildSVFModule(Module &mod)
 {
+    PhaseTimer timer("Module load");
     svfModule = new SVFModule(mod.getModuleIdentifier());
     modules.emplace_back(mod);
 
@@ -92,6 +112,7 @@ SVFModule* LLVMModuleSet::buildSVFModule(const std::vector<std::string> &moduleN
     else
         svfModule = new SVFModule();
 
+    PhaseTimer timer("Module load");
     loadModules(moduleNameVec);
     build();
 
@@ -100,6 +121,7 @@ SVFModule* LLVMModuleSet::buildSVFModule(const std::vector<std::string> &moduleN
 
 void LLVMModuleSet::build()
 {
+    loadProfile();
     initialize();
     buildFunToFunMap();
     buildGlobalDefToRepMap();
@@ -134,7 +156,8 @@ void LLVMModuleSet::loadModules(const std::vector<std::string> &moduleNameVec)
 
     for (const std::string& moduleName : moduleNameVec) {
         SMDiagnostic Err;
-        std::unique_ptr<Module> mod = parseIRFile(moduleName, Err, *cxts);
+        std::unique_ptr<Module> mod = Options::LazyBitcode ? getLazyIRFileModule(moduleName, Err, *cxts)
+                                                           : parseIRFile(moduleName, Err, *cxts);
         if (mod == nullptr)
         {
             SVFUtil::errs() << "load module: " << moduleName << "failed!!\n\n";
@@ -144,7 +167,131 @@ void LLVMModuleSet::loadModules(const std::vector<std::string> &moduleNameVec)
         modules.emplace_back(*mod);
         owned_modules.emplace_back(std::move(mod));
     }
+    if (Options::LazyBitcode)
+        materializeReachableFunctions();
+}
+/*!
+ * Push the functions referenced by a constant (e.g., a global initializer or an instruction operand)
+ */
+static void collectReferencedFunctions(Constant* C, std::vector<Function*>& worklist, Set<const Constant*>& visited)
+{
+    if (visited.insert(C).second == false)
+        return;
+
+    if (Function* fun = SVFUtil::dyn_cast<Function>(C))
+        worklist.push_back(fun);
+    /// initializers of globals and aliasees are collected as roots
+    else if (SVFUtil::isa<GlobalValue>(C) == false)
+    {
+        /// a BlockAddress also has its BasicBlock as operand
+        for (Use& opnd : C->operands())
+        {
+            if (Constant* opndC = SVFUtil::dyn_cast<Constant>(opnd.get()))
+                collectReferencedFunctions(opndC, worklist, visited);
+        }
+    }
 }
+
+/*!
+ * Materialize the function bodies of the lazily loaded modules on demand.
+ * Roots are the functions which can not be dropped when unused (main, exported functions)
+ * and the functions referenced by global initializers (llvm.global_ctors, vtables, ...).
+ * A function is materialized once it is referenced by a root or a materialized function,
+ * in any module: a linkonce_odr function referenced only from another module is reached
+ * through its name, like getDefFunForMultipleModule links declarations to definitions.
+ * Remaining functions are unused and discardable (e.g., unused monomorphized generics),
+ * their bodies are never read and they are turned into declarations.
+ */
+void LLVMModuleSet::materializeReachableFunctions()
+{
+    std::vector<Function*> worklist;
+    Set<const Constant*> visited;
+    Map<std::string, std::vector<Function*>> nameToFuns;
+
+    for (Module& mod : modules)
+    {
+        for (Function& fun : mod)
+        {
+            if (fun.hasLocalLinkage() == false)
+                nameToFuns[fun.getName().str()].push_back(&fun);
+            if (GlobalValue::isDiscardableIfUnused(fun.getLinkage()) == false)
+                collectReferencedFunctions(&fun, worklist, visited);
+        }
+        for (GlobalVariable& global : mod.globals())
+        {
+            if (global.hasInitializer())
+                collectReferencedFunctions(global.getInitializer(), worklist, visited);
+        }
+        for (GlobalAlias& alias : mod.aliases())
+            collectReferencedFunctions(alias.getAliasee(), worklist, visited);
+    }
+
+    while (!worklist.empty())
+    {
+        Function* fun = worklist.back();
+        worklist.pop_back();
+
+        /// the same function in the other modules, e.g., the definition of a declaration
+        if (fun->hasLocalLinkage() == false)
+        {
+            Map<std::string, std::vector<Function*>>::const_iterator it = nameToFuns.find(fun->getName().str());
+            if (it != nameToFuns.end())
+            {
+                for (Function* other : it->second)
+                {
+                    if (other != fun)
+                        collectReferencedFunctions(other, worklist, visited);
+                }
+            }
+        }
+
+        if (fun->isMaterializable() == false)
+            continue;
+
+        if (llvm::Error err = fun->materialize())
+        {
+            llvm::logAllUnhandledErrors(std::move(err), SVFUtil::errs(), "materialize " + fun->getName().str() + ": ");
+            continue;
+        }
+
+        if (fun->hasPersonalityFn())
+            collectReferencedFunctions(fun->getPersonalityFn(), worklist, visited);
+        for (BasicBlock& bb : *fun)
+        {
+            for (Instruction& inst : bb)
+            {
+                for (Use& opnd : inst.operands())
+                {
+                    if (Constant* C = SVFUtil::dyn_cast<Constant>(opnd.get()))
+                        collectReferencedFunctions(C, worklist, visited);
+                }
+            }
+        }
+    }
+
+    for (Module& mod : modules)
+    {
+        u32_t numUnreached = 0;
+        for (Function& fun : mod)
+        {
+            if (fun.isMaterializable())
+            {
+                /// as llvm::convertToDeclaration, a declaration may not keep its comdat or metadata
+                fun.deleteBody();
+                fun.clearMetadata();
+                fun.setComdat(nullptr);
+                numUnreached++;
+            }
+        }
+        DBOUT(DGENERAL, SVFUtil::outs() << SVFUtil::pasMsg("lazy loading " + mod.getModuleIdentifier() + ": "
+                + std::to_string(numUnreached) + " unreachable functions not materialized\n"));
+
+        /// finish reading the module (metadata, intrinsic upgrades) and release the bitcode reader
+        if (llvm::Error err = mod.materializeAll())
+            llvm::logAllUnhandledErrors(std::move(err), SVFUtil::errs(), "materialize " + mod.getModuleIdentifier() + ": ");
+    }
+}
+
 /*!
  * Transform ExtractValue instructions to suitable load/gep instructions
  * @param M
@@ -414,7 +561,13 @@ bool addDummyLoads(Module& M){
                         }
                 }else if(CallBase* CB = llvm::dyn_cast<CallBase>(&I)){
                     if(CB->getMetadata("MPK-Unsafe") != nullptr){
+                        const Function* callee = CB->getCalledFunction();
                         for(auto &callArg: CB->args()){
+                            ///a summarized C function only touches the bytes of this pointee
+                            if(callee && callee->isDeclaration() &&
+                                    ExtAPI::getExtAPI()->is_nofollow_arg(callee->getName().str(), callArg.getOperandNo())){
+                                continue;
+                            }
                             if(callArg->getType()->isPointerTy()){
                                 BitCastInst *bitCastInst = new BitCastInst(callArg, callArg->getType()->getPointerTo(0),
                                                                            "dummy_bit_cast", &I);
@@ -436,6 +589,66 @@ bool addDummyLoads(Module& M){
     return true;
 }
 
+static bool isSampleProfile(const llvm::MemoryBuffer& buf)
+{
+    using namespace llvm::sampleprof;
+    return SampleProfileReaderRawBinary::hasFormat(buf) || SampleProfileReaderExtBinary::hasFormat(buf)
+           || SampleProfileReaderCompactBinary::hasFormat(buf) || SampleProfileReaderGCC::hasFormat(buf)
+           || SampleProfileReaderText::hasFormat(buf);
+}
+
+/*!
+ * Annotate the modules with the -mpk-profile counts, which the DDA rewriter
+ * uses to specialize hot unsafe allocation paths. This runs before anything
+ * else looks at the IR, since applying an instrumentation profile may split
+ * critical edges. Bitcode built with -Cprofile-use already carries the counts.
+ *
+ * An instrumentation profile only applies to functions whose CFG hash matches
+ * the instrumented build, so it has to come from a build of the same
+ * (unoptimized) bitcode; mismatching functions silently get no counts.
+ */
+void LLVMModuleSet::loadProfile()
+{
+    if (Options::MpkProfile.empty())
+        return;
+
+    auto bufOrErr = llvm::MemoryBuffer::getFile(Options::MpkProfile);
+    if (!bufOrErr)
+    {
+        SVFUtil::errs() << "Unable to read profile " << Options::MpkProfile << "\n";
+        exit(1);
+    }
+    bool isInstrProfile = llvm::IndexedInstrProfReader::hasFormat(**bufOrErr);
+    if (!isInstrProfile && !isSampleProfile(**bufOrErr))
+    {
+        SVFUtil::errs() << "Unknown profile format of " << Options::MpkProfile
+                        << ", expected an indexed instrumentation (.profdata) or a sample profile\n";
+        exit(1);
+    }
+
+    u32_t numDefined = 0, numProfiled = 0;
+    for (Module& mod : modules)
+    {
+        llvm::legacy::PassManager PM;
+        if (isInstrProfile)
+            PM.add(llvm::createPGOInstrumentationUseLegacyPass(Options::MpkProfile));
+        else
+            PM.add(llvm::createSampleProfileLoaderPass(Options::MpkProfile));
+        PM.run(mod);
+
+        for (const Function& fun : mod)
+        {
+            if (fun.isDeclaration())
+                continue;
+            numDefined++;
+            if (fun.getEntryCount().hasValue())
+                numProfiled++;
+        }
+    }
+    if (numDefined != 0 && numProfiled == 0)
+        SVFUtil::writeWrnMsg("profile " + Options::MpkProfile.getValue() + " matched no function, was it collected from this bitcode?");
+}
+
 void LLVMModuleSet::initialize()
 {
     if (Options::SVFMain)
@@ -445,6 +658,23 @@ void LLVMModuleSet::initialize()
         addDummyLoads(M);
     }
 
+    ///Summaries of a library crate describe its code as the final analysis sees it
+    if (!Options::MpkEmitSummary.empty())
+        emitIsolationSummaries(modules);
+
+    ///Skip the bodies the dependency crate summaries fully describe
+    if (!Options::MpkSummaries.empty())
+    {
+        loadIsolationSummaries();
+        for(Module& M: modules){
+            applyIsolationSummaries(M);
+        }
+    }
+
+    ///Analyze one body of each set of monomorphized copies
+    if (Options::MpkShareGenerics)
+        shareStructuralSummaries(modules);
+
     for (Module& mod : modules)
     {
         /// Function
@@ -704,6 +934,8 @@ void LLVMModuleSet::buildGlobalDefToRepMap()
 // Dump modules to files
 void LLVMModuleSet::dumpModulesToFile(const std::string suffix)
 {
+    PhaseTimer timer("Bitcode dump");
+    restoreSummarizedBodies();
     for (Module& mod : modules)
     {
         std::string moduleName = mod.getName().str();
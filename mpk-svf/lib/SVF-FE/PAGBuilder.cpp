@@ -35,6 +35,7 @@
 #include "Graphs/ExternalPAG.h"
 #include "Util/BasicTypes.h"
 #include "MemoryModel/PAGBuilderFromFile.h"
+#include "Util/PhaseProfiler.h"
 
 using namespace std;
 using namespace SVF;
@@ -46,6 +47,7 @@ using namespace SVFUtil;
  */
 PAG* PAGBuilder::build(SVFModule* svfModule)
 {
+    PhaseTimer timer("PAG");
 
     // We read PAG from a user-defined txt instead of parsing PAG from LLVM IR
     if (SVFModule::pagReadFromTXT())
@@ -727,6 +729,9 @@ void PAGBuilder::visitCallSite(CallSite cs)
         else
         {
             handleDirectCall(cs, callee);
+            /// Rust spawn APIs are defined functions, their fork edges are added here
+            if(isThreadForkCall(cs.getInstruction()))
+                handleForkCall(cs.getInstruction());
         }
     }
     else
@@ -860,6 +865,45 @@ void PAGBuilder::visitFreezeInst(FreezeInst &inst){
 }
 
 
+/*!
+ * Create the inter-procedural PAG edges of a thread fork. Rust spawn APIs are
+ * defined (monomorphized) functions, so they come here from the direct-call
+ * path of visitCallSite while pthread_create and friends come from handleExtCall.
+ */
+void PAGBuilder::handleForkCall(const Instruction* inst)
+{
+    if(const Function* forkedFun = getLLVMFunction(getForkedFun(inst)) )
+    {
+        forkedFun = getDefFunForMultipleModule(forkedFun)->getLLVMFun();
+        const Value* actualParm = getActualParmAtForkSite(inst);
+        /// pthread_create has 1 arg.
+        /// apr_thread_create has 2 arg.
+        /// a Rust closure may take its captured values as separate args, only its environment is connected.
+        bool isRustFork = ThreadAPI::getThreadAPI()->isRustTDAPI(inst);
+        assert((forkedFun->arg_size() <= 2 || isRustFork) && "Size of formal parameter of start routine should be one");
+        if(actualParm && (forkedFun->arg_size() <= 2 || isRustFork) && forkedFun->arg_size() >= 1)
+        {
+            const Argument* formalParm = &(*forkedFun->arg_begin());
+            /// Connect actual parameter to formal parameter of the start routine
+            if(SVFUtil::isa<PointerType>(actualParm->getType()) && SVFUtil::isa<PointerType>(formalParm->getType()) )
+            {
+                CallBlockNode* icfgNode = pag->getICFG()->getCallBlockNode(inst);
+                addThreadForkEdge(pag->getValueNode(actualParm), pag->getValueNode(formalParm),icfgNode);
+            }
+        }
+    }
+    else
+    {
+        /// handle indirect calls at pthread create APIs e.g., pthread_create(&t1, nullptr, fp, ...);
+        ///const Value* fun = ThreadAPI::getThreadAPI()->getForkedFun(inst);
+        ///if(!SVFUtil::isa<Function>(fun))
+        ///    pag->addIndirectCallsites(cs,pag->getValueNode(fun));
+    }
+    /// If forkedFun does not pass to spawnee as function type but as void pointer
+    /// remember to update inter-procedural callgraph/PAG/SVFG etc. when indirect call targets are resolved
+    /// We don't connect the callgraph here, further investigation is need to hanle mod-ref during SVFG construction.
+}
+
 /*!
  * Add the constraints for a direct, non-external call.
  */
@@ -1119,6 +1163,14 @@ void PAGBuilder::handleExtCall(CallSite cs, const SVFFunction *callee)
                 if(vnD && vnS)
                     addStoreEdge(vnS,vnD);
                 break;
+            }
+            case ExtAPI::EFT_A0R_A1:
+            {
+                NodeID vnD= getValueNode(cs.getArgument(0));
+                NodeID vnS= getValueNode(cs.getArgument(1));
+                if(vnD && vnS)
+                    addStoreEdge(vnS,vnD);
+                break;
             }
 			case ExtAPI::EFT_L_A0__A1_A0:
 			{
@@ -1312,37 +1364,7 @@ void PAGBuilder::handleExtCall(CallSite cs, const SVFFunction *callee)
 
         /// create inter-procedural PAG edges for thread forks
         if(isThreadForkCall(inst))
-        {
-            if(const Function* forkedFun = getLLVMFunction(getForkedFun(inst)) )
-            {
-                forkedFun = getDefFunForMultipleModule(forkedFun)->getLLVMFun();
-                const Value* actualParm = getActualParmAtForkSite(inst);
-                /// pthread_create has 1 arg.
-                /// apr_thread_create has 2 arg.
-                assert((forkedFun->arg_size() <= 2) && "Size of formal parameter of start routine should be one");
-                if(forkedFun->arg_size() <= 2 && forkedFun->arg_size() >= 1)
-                {
-                    const Argument* formalParm = &(*forkedFun->arg_begin());
-                    /// Connect actual parameter to formal parameter of the start routine
-                    if(SVFUtil::isa<PointerType>(actualParm->getType()) && SVFUtil::isa<PointerType>(formalParm->getType()) )
-                    {
-                        CallBlockNode* icfgNode = pag->getICFG()->getCallBlockNode(inst);
-                        addThreadForkEdge(pag->getValueNode(actualParm), pag->getValueNode(formalParm),icfgNode);
-                    }
-                }
-            }
-            else
-            {
-                /// handle indirect calls at pthread create APIs e.g., pthread_create(&t1, nullptr, fp, ...);
-                ///const Value* fun = ThreadAPI::getThreadAPI()->getForkedFun(inst);
-                ///if(!SVFUtil::isa<Function>(fun))
-                ///    pag->addIndirectCallsites(cs,pag->getValueNode(fun));
-            }
-            /// If forkedFun does not pass to spawnee as function type but as void pointer
-            /// remember to update inter-procedural callgraph/PAG/SVFG etc. when indirect call targets are resolved
-            /// We don't connect the callgraph here, further investigation is need to hanle mod-ref during SVFG construction.
-        }
-
+            handleForkCall(inst);
         /// create inter-procedural PAG edges for hare_parallel_for calls
         else if(isHareParForCall(inst))
         {
@@ -287,7 +287,7 @@ bool SymbolTableInfo::computeGepOffset(const User *V, LocationSet& ls)
             // Handling struct here
             if (const StructType *ST = SVFUtil::dyn_cast<StructType>(*gi)) {
                 assert(op && "non-const struct index in GEP");
-                const vector<u32_t> &so = SymbolTableInfo::SymbolInfo()->getFattenFieldIdxVec(ST);
+                const vector<u32_t> &so = getFattenFieldIdxVec(ST);
                 if ((unsigned) idx >= so.size()) {
                     outs() << "!! Struct index out of bounds" << idx << "\n";
                     assert(0);
@@ -297,23 +297,23 @@ bool SymbolTableInfo::computeGepOffset(const User *V, LocationSet& ls)
             }
         }
     }else if(const ExtractValueInst *EVInst = SVFUtil::dyn_cast<ExtractValueInst>(V)){
-        vector<FieldInfo> fieldInfoVec = SymbolTableInfo::SymbolInfo()->getFlattenFieldInfoVec(EVInst->getAggregateOperand()->getType());
+        const vector<FieldInfo>* fieldInfoVec = &getFlattenFieldInfoVec(EVInst->getAggregateOperand()->getType());
         for(ExtractValueInst::idx_iterator II = EVInst->idx_begin(), EI = EVInst->idx_end(); II != EI; ++II){
-            FieldInfo fI = fieldInfoVec[*II];
+            const FieldInfo& fI = (*fieldInfoVec)[*II];
             ls.setFldIdx(ls.getOffset()+fI.getFlattenFldIdx());
             ls.setByteOffset(ls.getByteOffset()+fI.getFlattenByteOffset());
             if(fI.getFlattenElemTy()->isAggregateType()){
-                fieldInfoVec = SymbolTableInfo::SymbolInfo()->getFlattenFieldInfoVec(fI.getFlattenElemTy());
+                fieldInfoVec = &getFlattenFieldInfoVec(fI.getFlattenElemTy());
             }
         }
     }else if(const InsertValueInst *IVInst = SVFUtil::dyn_cast<InsertValueInst>(V)){
-        vector<FieldInfo> fieldInfoVec = SymbolTableInfo::SymbolInfo()->getFlattenFieldInfoVec(IVInst->getAggregateOperand()->getType());
+        const vector<FieldInfo>* fieldInfoVec = &getFlattenFieldInfoVec(IVInst->getAggregateOperand()->getType());
         for(InsertValueInst::idx_iterator II = IVInst->idx_begin(), EI = IVInst->idx_end(); II != EI; ++II){
-            FieldInfo fI = fieldInfoVec[*II];
+            const FieldInfo& fI = (*fieldInfoVec)[*II];
             ls.setFldIdx(ls.getOffset()+fI.getFlattenFldIdx());
             ls.setByteOffset(ls.getByteOffset()+fI.getFlattenByteOffset());
             if(fI.getFlattenElemTy()->isAggregateType()){
-                fieldInfoVec = SymbolTableInfo::SymbolInfo()->getFlattenFieldInfoVec(fI.getFlattenElemTy());
+                fieldInfoVec = &getFlattenFieldInfoVec(fI.getFlattenElemTy());
             }
         }
     }
@@ -624,6 +624,8 @@ void SymbolTableInfo::destroy()
         if (iter->second)
             delete iter->second;
     }
+    typeToFieldInfo.clear();
+    stInfoCache.clear();
 }
 
 /*!
@@ -34,6 +34,22 @@
 
 using namespace SVF;
 
+/*!
+ * Constructor
+ *
+ * Sifting is triggered once the live node count reaches -bdd-reorder-threshold,
+ * and CUDD doubles the threshold after every reordering.
+ */
+BddCondManager::BddCondManager(u32_t numVars, u32_t cacheSlots)
+{
+    m_bdd_mgr = Cudd_Init(numVars, 0, CUDD_UNIQUE_SLOTS, cacheSlots, 0);
+    if (Options::BddReorder)
+    {
+        Cudd_AutodynEnable(m_bdd_mgr, CUDD_REORDER_SIFT);
+        Cudd_SetNextReordering(m_bdd_mgr, Options::BddReorderThreshold);
+    }
+}
+
 /// Operations on conditions.
 //@{
 /// use Cudd_bddAndLimit interface to avoid bdds blow up
@@ -0,0 +1,301 @@
+//===- DensePointsTo.cpp -- Word kernels of DensePointsTo ---------------------//
+
+/*
+ * DensePointsTo.cpp
+ *
+ * Scalar, SSE4.1 and AVX2 word kernels of DensePointsTo. The vector versions
+ * are compiled with target attributes and only picked when the host supports
+ * them, so the library itself needs no -msse4.1 or -mavx2.
+ */
+
+#include "Util/DensePointsTo.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define SVF_DENSE_PTS_X86 1
+#endif
+
+using namespace SVF;
+
+typedef DensePointsTo::Word Word;
+
+static bool orWordsScalar(Word* dst, const Word* src, unsigned n)
+{
+    Word changed = 0;
+    for (unsigned i = 0; i < n; i++)
+    {
+        changed |= src[i] & ~dst[i];
+        dst[i] |= src[i];
+    }
+    return changed != 0;
+}
+
+static bool andWordsScalar(Word* dst, const Word* src, unsigned n)
+{
+    Word changed = 0;
+    for (unsigned i = 0; i < n; i++)
+    {
+        changed |= dst[i] & ~src[i];
+        dst[i] &= src[i];
+    }
+    return changed != 0;
+}
+
+static bool andNotWordsScalar(Word* dst, const Word* src, unsigned n)
+{
+    Word changed = 0;
+    for (unsigned i = 0; i < n; i++)
+    {
+        changed |= dst[i] & src[i];
+        dst[i] &= ~src[i];
+    }
+    return changed != 0;
+}
+
+static bool intersectWordsScalar(const Word* a, const Word* b, unsigned n)
+{
+    for (unsigned i = 0; i < n; i++)
+        if (a[i] & b[i])
+            return true;
+    return false;
+}
+
+static bool subsetWordsScalar(const Word* sub, const Word* super, unsigned n)
+{
+    for (unsigned i = 0; i < n; i++)
+        if (sub[i] & ~super[i])
+            return false;
+    return true;
+}
+
+static unsigned popcountWordsScalar(const Word* a, unsigned n)
+{
+    unsigned count = 0;
+    for (unsigned i = 0; i < n; i++)
+        count += __builtin_popcountll(a[i]);
+    return count;
+}
+
+#ifdef SVF_DENSE_PTS_X86
+
+/// Two words per step, the tail is left to the scalar kernels; SSE4.1 brings
+/// ptest for the emptiness and subset checks
+#define SVF_SSE __attribute__((target("sse4.1,popcnt")))
+
+SVF_SSE static bool orWordsSSE(Word* dst, const Word* src, unsigned n)
+{
+    __m128i changed = _mm_setzero_si128();
+    unsigned i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        changed = _mm_or_si128(changed, _mm_andnot_si128(d, s));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(d, s));
+    }
+    bool tail = orWordsScalar(dst + i, src + i, n - i);
+    return !_mm_testz_si128(changed, changed) || tail;
+}
+
+SVF_SSE static bool andWordsSSE(Word* dst, const Word* src, unsigned n)
+{
+    __m128i changed = _mm_setzero_si128();
+    unsigned i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        changed = _mm_or_si128(changed, _mm_andnot_si128(s, d));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_and_si128(d, s));
+    }
+    bool tail = andWordsScalar(dst + i, src + i, n - i);
+    return !_mm_testz_si128(changed, changed) || tail;
+}
+
+SVF_SSE static bool andNotWordsSSE(Word* dst, const Word* src, unsigned n)
+{
+    __m128i changed = _mm_setzero_si128();
+    unsigned i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        changed = _mm_or_si128(changed, _mm_and_si128(d, s));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_andnot_si128(s, d));
+    }
+    bool tail = andNotWordsScalar(dst + i, src + i, n - i);
+    return !_mm_testz_si128(changed, changed) || tail;
+}
+
+SVF_SSE static bool intersectWordsSSE(const Word* a, const Word* b, unsigned n)
+{
+    unsigned i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        if (!_mm_testz_si128(va, vb))
+            return true;
+    }
+    return intersectWordsScalar(a + i, b + i, n - i);
+}
+
+SVF_SSE static bool subsetWordsSSE(const Word* sub, const Word* super, unsigned n)
+{
+    unsigned i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        __m128i vsub = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sub + i));
+        __m128i vsuper = _mm_loadu_si128(reinterpret_cast<const __m128i*>(super + i));
+        /// testc: (~vsuper & vsub) == 0
+        if (!_mm_testc_si128(vsuper, vsub))
+            return false;
+    }
+    return subsetWordsScalar(sub + i, super + i, n - i);
+}
+
+SVF_SSE static unsigned popcountWordsSSE(const Word* a, unsigned n)
+{
+    unsigned c0 = 0, c1 = 0;
+    unsigned i = 0;
+    for (; i + 2 <= n; i += 2)
+    {
+        c0 += _mm_popcnt_u64(a[i]);
+        c1 += _mm_popcnt_u64(a[i + 1]);
+    }
+    for (; i < n; i++)
+        c0 += _mm_popcnt_u64(a[i]);
+    return c0 + c1;
+}
+
+/// Four words per step, the tail is left to the scalar kernels
+#define SVF_AVX2 __attribute__((target("avx2,popcnt")))
+
+SVF_AVX2 static bool orWordsAVX2(Word* dst, const Word* src, unsigned n)
+{
+    __m256i changed = _mm256_setzero_si256();
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        changed = _mm256_or_si256(changed, _mm256_andnot_si256(d, s));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_or_si256(d, s));
+    }
+    bool tail = orWordsScalar(dst + i, src + i, n - i);
+    return !_mm256_testz_si256(changed, changed) || tail;
+}
+
+SVF_AVX2 static bool andWordsAVX2(Word* dst, const Word* src, unsigned n)
+{
+    __m256i changed = _mm256_setzero_si256();
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        changed = _mm256_or_si256(changed, _mm256_andnot_si256(s, d));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_and_si256(d, s));
+    }
+    bool tail = andWordsScalar(dst + i, src + i, n - i);
+    return !_mm256_testz_si256(changed, changed) || tail;
+}
+
+SVF_AVX2 static bool andNotWordsAVX2(Word* dst, const Word* src, unsigned n)
+{
+    __m256i changed = _mm256_setzero_si256();
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        changed = _mm256_or_si256(changed, _mm256_and_si256(d, s));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_andnot_si256(s, d));
+    }
+    bool tail = andNotWordsScalar(dst + i, src + i, n - i);
+    return !_mm256_testz_si256(changed, changed) || tail;
+}
+
+SVF_AVX2 static bool intersectWordsAVX2(const Word* a, const Word* b, unsigned n)
+{
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        if (!_mm256_testz_si256(va, vb))
+            return true;
+    }
+    return intersectWordsScalar(a + i, b + i, n - i);
+}
+
+SVF_AVX2 static bool subsetWordsAVX2(const Word* sub, const Word* super, unsigned n)
+{
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        __m256i vsub = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sub + i));
+        __m256i vsuper = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(super + i));
+        /// testc: (~vsuper & vsub) == 0
+        if (!_mm256_testc_si256(vsuper, vsub))
+            return false;
+    }
+    return subsetWordsScalar(sub + i, super + i, n - i);
+}
+
+/// AVX2 has no vector popcount, the popcnt instruction does four words per step
+SVF_AVX2 static unsigned popcountWordsAVX2(const Word* a, unsigned n)
+{
+    unsigned c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+    unsigned i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        c0 += _mm_popcnt_u64(a[i]);
+        c1 += _mm_popcnt_u64(a[i + 1]);
+        c2 += _mm_popcnt_u64(a[i + 2]);
+        c3 += _mm_popcnt_u64(a[i + 3]);
+    }
+    for (; i < n; i++)
+        c0 += _mm_popcnt_u64(a[i]);
+    return c0 + c1 + c2 + c3;
+}
+
+#endif
+
+const DensePointsTo::Kernels* DensePointsTo::getKernels(KernelTier tier)
+{
+    static const Kernels scalar =
+    {
+        orWordsScalar, andWordsScalar, andNotWordsScalar,
+        intersectWordsScalar, subsetWordsScalar, popcountWordsScalar
+    };
+    if (tier == ScalarKernels)
+        return &scalar;
+#ifdef SVF_DENSE_PTS_X86
+    static const Kernels sse =
+    {
+        orWordsSSE, andWordsSSE, andNotWordsSSE,
+        intersectWordsSSE, subsetWordsSSE, popcountWordsSSE
+    };
+    static const Kernels avx2 =
+    {
+        orWordsAVX2, andWordsAVX2, andNotWordsAVX2,
+        intersectWordsAVX2, subsetWordsAVX2, popcountWordsAVX2
+    };
+    if (!__builtin_cpu_supports("popcnt"))
+        return nullptr;
+    if (tier == SSEKernels && __builtin_cpu_supports("sse4.1"))
+        return &sse;
+    if (tier == AVX2Kernels && __builtin_cpu_supports("avx2"))
+        return &avx2;
+#endif
+    return nullptr;
+}
+
+const DensePointsTo::Kernels& DensePointsTo::getKernels()
+{
+    static const Kernels* selected = getKernels(AVX2Kernels) ? getKernels(AVX2Kernels) :
+                                     getKernels(SSEKernels) ? getKernels(SSEKernels) :
+                                     getKernels(ScalarKernels);
+    return *selected;
+}
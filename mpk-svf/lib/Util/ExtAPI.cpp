@@ -8,7 +8,11 @@
 */
 
 #include "Util/ExtAPI.h"
+#include "Util/Options.h"
+#include "Util/SVFUtil.h"
 #include <stdio.h>
+#include <fstream>
+#include <sstream>
 
 using namespace std;
 using namespace SVF;
@@ -445,6 +449,7 @@ static const ei_pair ei_pairs[]=
     {"__mpk_unsafe__rdl_alloc",ExtAPI::EFT_ALLOC},
     {"__mpk_unsafe__rust_alloc",ExtAPI::EFT_ALLOC},
     {"__mpk_unsafe__rust_alloc_zeroed",ExtAPI::EFT_ALLOC},
+    {"__mpk_unsafe__rdl_alloc_zeroed",ExtAPI::EFT_ALLOC},
 
     {"\01_fopen", ExtAPI::EFT_ALLOC},
     {"\01fopen64", ExtAPI::EFT_ALLOC},
@@ -890,5 +895,126 @@ void ExtAPI::init()
         }
         info[p->n]= p->t;
     }
+
+    std::stringstream files(Options::ExtSummaries);
+    std::string file;
+    while (std::getline(files, file, ','))
+    {
+        if (!file.empty())
+            loadSummaries(file);
+    }
 }
 
+namespace {
+
+struct es_pair
+{
+    const char *n;
+    ExtAPI::extf_t t;
+    int dst;    //argument written through, -1 if none
+};
+
+} // End anonymous namespace
+
+//Effect names of a summary file and the argument each writes through.
+static const es_pair es_pairs[]=
+{
+    {"noop", ExtAPI::EFT_NOOP, -1},
+    {"alloc", ExtAPI::EFT_ALLOC, -1},
+    {"nostruct_alloc", ExtAPI::EFT_NOSTRUCT_ALLOC, -1},
+    {"realloc", ExtAPI::EFT_REALLOC, -1},
+    {"free", ExtAPI::EFT_FREE, -1},
+    {"static", ExtAPI::EFT_STAT, -1},
+    {"static2", ExtAPI::EFT_STAT2, -1},
+    {"ret_arg0", ExtAPI::EFT_L_A0, -1},
+    {"ret_arg1", ExtAPI::EFT_L_A1, -1},
+    {"ret_arg2", ExtAPI::EFT_L_A2, -1},
+    {"ret_arg8", ExtAPI::EFT_L_A8, -1},
+    {"store_arg1_in_arg0", ExtAPI::EFT_A0R_A1, 0},
+    {"store_arg0_in_arg1", ExtAPI::EFT_A1R_A0, 1},
+    {"store_arg1_in_arg2", ExtAPI::EFT_A2R_A1, 2},
+    {"store_arg1_in_arg4", ExtAPI::EFT_A4R_A1, 4},
+    {"copy_arg1_to_arg0", ExtAPI::EFT_L_A0__A0R_A1R, 0},
+    {"copy_arg0_to_arg1", ExtAPI::EFT_A1R_A0R, 1},
+    {"new_in_arg0", ExtAPI::EFT_A0R_NEW, 0},
+    {"new_in_arg1", ExtAPI::EFT_A1R_NEW, 1},
+    {"new_in_arg2", ExtAPI::EFT_A2R_NEW, 2},
+    {"new_in_arg4", ExtAPI::EFT_A4R_NEW, 4},
+    {0, ExtAPI::EFT_NOOP, -1}
+};
+
+/*!
+ * Each line of a summary file is
+ *     <function> <effect> [arg<N>:<flag>[,<flag>]]...
+ * e.g. "compress noop arg0:nofollow arg2:readonly,nofollow".
+ * A summary replaces the built-in entry of the same function.
+ */
+bool ExtAPI::loadSummaries(const std::string& file)
+{
+    std::ifstream in(file);
+    if (!in.is_open())
+    {
+        SVFUtil::errs() << "Unable to read external function summaries " << file << "\n";
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string name, effect;
+        fields >> name;
+        if (name.empty() || name[0] == '#')
+            continue;
+        fields >> effect;
+
+        const es_pair *e= es_pairs;
+        while (e->n && effect != e->n)
+            ++e;
+        if (!e->n)
+        {
+            SVFUtil::errs() << "Unknown effect in " << file << ": " << line << "\n";
+            continue;
+        }
+
+        std::vector<u32_t> flags;
+        std::string arg;
+        bool malformed = false;
+        while (fields >> arg && arg[0] != '#')
+        {
+            u32_t argNo;
+            char colon;
+            std::istringstream argFields(arg.compare(0, 3, "arg") ? "" : arg.substr(3));
+            if (!(argFields >> argNo >> colon) || colon != ':' || argNo > 64)
+            {
+                malformed = true;
+                break;
+            }
+            if (flags.size() <= argNo)
+                flags.resize(argNo + 1, 0);
+            std::string flag;
+            while (std::getline(argFields, flag, ','))
+            {
+                if (flag == "readonly")
+                    flags[argNo] |= EXTARG_READONLY;
+                else if (flag == "nofollow")
+                    flags[argNo] |= EXTARG_NOFOLLOW;
+                else
+                    malformed = true;
+            }
+        }
+        if (!malformed && e->dst >= 0 && (u32_t)e->dst < flags.size() && (flags[e->dst] & EXTARG_READONLY))
+            malformed = true;
+        if (malformed)
+        {
+            SVFUtil::errs() << "Malformed external function summary in " << file << ": " << line << "\n";
+            continue;
+        }
+
+        info[name]= e->t;
+        if (flags.empty())
+            argInfo.erase(name);
+        else
+            argInfo[name]= flags;
+    }
+    return true;
+}
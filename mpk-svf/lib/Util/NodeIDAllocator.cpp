@@ -27,6 +27,7 @@ namespace SVF
         if (allocator != nullptr)
         {
             delete allocator;
+            allocator = nullptr;
         }
     }
 
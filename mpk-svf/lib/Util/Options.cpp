@@ -165,6 +165,12 @@ namespace SVF
             clEnumValN(PointerAnalysis::Cxt_DDA, "cxt", "Demand-driven context- flow- sensitive analysis")
     ));
 
+    const llvm::cl::opt<unsigned> Options::MpkMaxFlagClones(
+        "mpk-max-flag-clones",
+        llvm::cl::init(4),
+        llvm::cl::desc("Maximum number of constant-flag clones per __mpk_unsafe function")
+    );
+
     // FlowDDA.cpp
     const llvm::cl::opt<unsigned long long> Options::FlowBudget(
         "flow-bg",  
@@ -436,6 +442,12 @@ namespace SVF
         llvm::cl::desc("Run Lock Analysis")
     );
 
+    const llvm::cl::opt<unsigned> Options::MHPThreads(
+        "mhp-threads",
+        llvm::cl::init(1),
+        llvm::cl::desc("Number of threads propagating per-root thread interleavings (1 analyzes sequentially)")
+    );
+
 
     // MTA.cpp
     const llvm::cl::opt<bool> Options::AndersenAnno(
@@ -517,6 +529,12 @@ namespace SVF
         llvm::cl::desc("Source-Sink Analysis Contexts Limit")
     );
 
+    const llvm::cl::opt<unsigned> Options::SaberThreads(
+        "saber-threads",
+        llvm::cl::init(1),
+        llvm::cl::desc("Number of threads slicing sources in source-sink analysis (1 analyzes sequentially)")
+    );
+
     
     // CHG.cpp
     const llvm::cl::opt<bool> Options::DumpCHA(
@@ -547,6 +565,36 @@ namespace SVF
         llvm::cl::desc("add svf.main()")
     );
 
+    const llvm::cl::opt<bool> Options::LazyBitcode(
+        "lazy-bc",
+        llvm::cl::init(false),
+        llvm::cl::desc("Lazily load bitcode files and only materialize the functions reachable from the program roots")
+    );
+
+    const llvm::cl::opt<std::string> Options::MpkProfile(
+        "mpk-profile",
+        llvm::cl::init(""),
+        llvm::cl::desc("Indexed instrumentation (.profdata) or sample profile used to specialize hot unsafe allocation paths")
+    );
+
+    const llvm::cl::opt<std::string> Options::MpkEmitSummary(
+        "mpk-emit-summary",
+        llvm::cl::init(""),
+        llvm::cl::desc("Write the isolation summaries of the exported functions of a library crate to this file")
+    );
+
+    const llvm::cl::opt<std::string> Options::MpkSummaries(
+        "mpk-summaries",
+        llvm::cl::init(""),
+        llvm::cl::desc("Comma separated isolation summary files of the dependency crates")
+    );
+
+    const llvm::cl::opt<bool> Options::MpkShareGenerics(
+        "mpk-share-generics",
+        llvm::cl::init(false),
+        llvm::cl::desc("Analyze one of each set of structurally equal functions (e.g., instantiations of a generic) and summarize the others")
+    );
+
     
     // SymbolTableInfo.cpp
     const llvm::cl::opt<bool> Options::LocMemModel(
@@ -574,6 +622,18 @@ namespace SVF
         llvm::cl::desc("Maximum context limit for DDA")
     );
 
+    const llvm::cl::opt<bool> Options::BddReorder(
+        "bdd-reorder",
+        llvm::cl::init(false),
+        llvm::cl::desc("Enable dynamic BDD variable reordering (sifting)")
+    );
+
+    const llvm::cl::opt<unsigned> Options::BddReorderThreshold(
+        "bdd-reorder-threshold",
+        llvm::cl::init(100000),
+        llvm::cl::desc("Number of live BDD nodes triggering the first reordering")
+    );
+
     
     // PathCondAllocator.cpp
     const llvm::cl::opt<bool> Options::PrintPathCond(
@@ -582,6 +642,12 @@ namespace SVF
         llvm::cl::desc("Print out path condition")
     );
 
+    const llvm::cl::opt<bool> Options::BddAutoSize(
+        "bdd-auto-size",
+        llvm::cl::init(true),
+        llvm::cl::desc("Size the BDD unique table and cache from the number of branch conditions")
+    );
+
 
     // SVFUtil.cpp
     const llvm::cl::opt<bool> Options::DisableWarn(
@@ -590,6 +656,33 @@ namespace SVF
         llvm::cl::desc("Disable warning")
     );
 
+    // ExtAPI.cpp
+    const llvm::cl::opt<std::string> Options::ExtSummaries(
+        "ext-summaries",
+        llvm::cl::init(""),
+        llvm::cl::desc("Comma separated summary files of external C functions (see mpk-svf/ext-summaries)")
+    );
+
+    // PhaseProfiler.cpp
+    const llvm::cl::opt<std::string> Options::PhaseTrace(
+        "phase-trace",
+        llvm::cl::init(""),
+        llvm::cl::desc("Write nested analysis phase timings as Chrome trace JSON to this file")
+    );
+
+    const llvm::cl::opt<bool> Options::PhaseStat(
+        "phase-stat",
+        llvm::cl::init(false),
+        llvm::cl::desc("Print a summary table of nested analysis phase timings")
+    );
+
+    // SVFAliasAnalysis.cpp
+    const llvm::cl::opt<bool> Options::SVFAAUseDDA(
+        "svf-aa-dda",
+        llvm::cl::init(false),
+        llvm::cl::desc("Answer the alias queries of the SVF alias analysis with ContextDDA instead of Andersen's")
+    );
+
     
     // Andersen.cpp
     const llvm::cl::opt<bool> Options::ConsCGDotGraph(
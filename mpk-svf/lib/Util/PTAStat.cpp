@@ -32,6 +32,7 @@
 #include "MemoryModel/PTAStat.h"
 #include "MemoryModel/PointerAnalysisImpl.h"
 #include "Graphs/PAG.h"
+#include "Util/PathCondAllocator.h"
 
 using namespace SVF;
 
@@ -104,6 +105,15 @@ const char* PTAStat:: MaxNumOfNodesInSCC = "MaxNodesInSCC";	///< max Number of n
 
 const char* PTAStat:: NumOfNullPointer = "NullPointer";	///< Number of pointers points-to null
 
+const char* PTAStat:: NumOfBddVars = "BddVars";	///< Number of BDD variables (branch conditions)
+const char* PTAStat:: NumOfBddNodes = "BddNodes";	///< Number of BDD nodes
+const char* PTAStat:: MaxNumOfLiveBddNodes = "MaxLiveBddNodes";	///< Peak number of live BDD nodes
+const char* PTAStat:: NumOfBddCacheSlots = "BddCacheSlots";	///< Number of BDD computed table slots
+const char* PTAStat:: NumOfBddGC = "BddGCNum";	///< Number of BDD garbage collections
+const char* PTAStat:: NumOfBddReorder = "BddReorderNum";	///< Number of BDD variable reorderings
+const char* PTAStat:: BddGCTime = "BddGCTime";	///< Time of BDD garbage collections
+const char* PTAStat:: BddReorderTime = "BddReorderTime";	///< Time of BDD variable reorderings
+
 PTAStat::PTAStat(PointerAnalysis* p) : startTime(0), endTime(0), pta(p)
 {
 
@@ -267,6 +277,26 @@ void PTAStat::callgraphStat()
     delete callgraphSCC;
 }
 
+/*!
+ * Statistics of the BDD manager behind path conditions
+ */
+void PTAStat::bddStat()
+{
+    if(PathCondAllocator::hasBddCondManager() == false)
+        return;
+
+    PTNumStatMap[NumOfBddVars] = PathCondAllocator::getVarNum();
+    PTNumStatMap[NumOfBddNodes] = PathCondAllocator::getCondNum();
+    PTNumStatMap[MaxNumOfLiveBddNodes] = PathCondAllocator::getMaxLiveCondNumber();
+    PTNumStatMap[NumOfBddCacheSlots] = PathCondAllocator::getCacheSlots();
+    PTNumStatMap[NumOfBddGC] = PathCondAllocator::getGCNum();
+    PTNumStatMap[NumOfBddReorder] = PathCondAllocator::getReorderNum();
+    timeStatMap[BddGCTime] = PathCondAllocator::getGCTime() / TIMEINTERVAL;
+    timeStatMap[BddReorderTime] = PathCondAllocator::getReorderTime() / TIMEINTERVAL;
+
+    PTAStat::printStat("BDD Stats");
+}
+
 void PTAStat::printStat(string statname)
 {
 
@@ -74,6 +74,51 @@ void PathCondAllocator::allocate(const SVFModule* M)
     DBOUT(DGENERAL,outs() << pasMsg("path condition allocation ends\n"));
 }
 
+/*!
+ * Create the BDD manager, sized from the number of decision variables of a module.
+ *
+ * The default manager starts with a 256K-entry computed table and grows its
+ * unique table one variable at a time, which keeps CUDD collecting garbage on
+ * large modules. Conditions (e.g. the true condition of every MSSA mu/chi) live
+ * in the manager, so it is created once, before the memory SSA is built, and
+ * never replaced; a manager created earlier is kept as it is.
+ */
+void PathCondAllocator::createBddCondManager(const SVFModule* M)
+{
+    if(bddCondMgr != nullptr)
+        return;
+
+    if(Options::BddAutoSize == false)
+    {
+        bddCondMgr = new BddCondManager();
+        return;
+    }
+
+    u32_t numVars = 0;
+    for (SVFModule::const_iterator fit = M->begin(); fit != M->end(); ++fit)
+    {
+        const SVFFunction * func = *fit;
+        if (SVFUtil::isExtCall(func))
+            continue;
+        for (Function::const_iterator bit = func->getLLVMFun()->begin(), ebit = func->getLLVMFun()->end(); bit != ebit; ++bit)
+        {
+            u32_t succ_number = getBBSuccessorNum(&*bit);
+            if(succ_number > 1)
+                numVars += (u32_t)ceil(log(succ_number)/log(2));
+        }
+    }
+
+    /// 32 computed-table entries per variable, kept a power of two
+    const u32_t maxCacheSlots = 1 << 22;
+    u32_t cacheSlots = CUDD_CACHE_SLOTS;
+    while(cacheSlots < maxCacheSlots && cacheSlots < (u64_t) numVars * 32)
+        cacheSlots <<= 1;
+
+    bddCondMgr = new BddCondManager(numVars, cacheSlots);
+
+    DBOUT(DGENERAL,outs() << pasMsg("BDD manager sized for ") << numVars << " variables, " << cacheSlots << " cache slots\n");
+}
+
 /*!
  * Allocate conditions for a basic block and propagate its condition to its successors.
  */
@@ -0,0 +1,226 @@
+//===- PhaseProfiler.cpp -- Nested phase timers for the SVF pipeline --------//
+
+/*
+ * PhaseProfiler.cpp
+ *
+ * Phases are kept in begin order. Each thread keeps its own stack of open
+ * phases, so worker threads get their own rows in the trace and their own
+ * nesting in the summary.
+ */
+
+#include "Util/PhaseProfiler.h"
+#include "Util/SVFUtil.h"
+#include "Util/Options.h"
+
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Format.h>
+
+#include <atomic>
+#include <ctime>
+
+using namespace SVF;
+
+PhaseProfiler* PhaseProfiler::profiler = nullptr;
+
+namespace
+{
+/// Open phases of the calling thread, innermost last
+thread_local std::vector<u32_t> openPhases;
+thread_local u32_t phaseTid = 0;
+std::atomic<u32_t> nextPhaseTid(1);
+
+s32_t currentRssKB()
+{
+    u32_t vmrss = 0, vmsize = 0;
+    if (SVFUtil::getMemoryUsageKB(&vmrss, &vmsize))
+        return vmrss;
+    return 0;
+}
+
+double cpuMs()
+{
+    return (double)clock() * 1000.0 / CLOCKS_PER_SEC;
+}
+
+std::string escapeJSON(const std::string& s)
+{
+    std::string res;
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            res += '\\';
+        if ((unsigned char)c < 0x20)
+            res += ' ';
+        else
+            res += c;
+    }
+    return res;
+}
+}
+
+PhaseProfiler::PhaseProfiler() : origin(Clock::now())
+{
+}
+
+PhaseProfiler* PhaseProfiler::getProfiler()
+{
+    static std::once_flag created;
+    std::call_once(created, []() { profiler = new PhaseProfiler(); });
+    return profiler;
+}
+
+bool PhaseProfiler::isEnabled()
+{
+    return Options::PhaseStat || !Options::PhaseTrace.empty();
+}
+
+u32_t PhaseProfiler::begin(const std::string& name)
+{
+    if (phaseTid == 0)
+        phaseTid = nextPhaseTid++;
+
+    Phase phase;
+    phase.name = name;
+    phase.tid = phaseTid;
+    phase.depth = openPhases.size();
+    phase.wallUs = -1;
+    phase.rssStartKB = currentRssKB();
+    phase.rssDeltaKB = 0;
+    phase.cpuMs = cpuMs();
+    phase.startUs = std::chrono::duration<double, std::micro>(Clock::now() - origin).count();
+
+    std::lock_guard<std::mutex> lock(phaseMutex);
+    if (!openPhases.empty())
+    {
+        const Phase& outer = phases[openPhases.back()];
+        phase.parent = outer.parent.empty() ? outer.name : outer.parent + "/" + outer.name;
+    }
+    u32_t idx = phases.size();
+    phases.push_back(phase);
+    openPhases.push_back(idx);
+    return idx;
+}
+
+void PhaseProfiler::end(u32_t idx)
+{
+    double nowUs = std::chrono::duration<double, std::micro>(Clock::now() - origin).count();
+    double nowCpu = cpuMs();
+    s32_t rss = currentRssKB();
+
+    std::lock_guard<std::mutex> lock(phaseMutex);
+    assert(!openPhases.empty() && openPhases.back() == idx && "phases must close in LIFO order");
+    openPhases.pop_back();
+    Phase& phase = phases[idx];
+    phase.wallUs = nowUs - phase.startUs;
+    phase.cpuMs = nowCpu - phase.cpuMs;
+    phase.rssDeltaKB = rss - phase.rssStartKB;
+}
+
+void PhaseProfiler::addStat(const std::string& name, u64_t value)
+{
+    std::lock_guard<std::mutex> lock(phaseMutex);
+    for (auto& stat : stats)
+    {
+        if (stat.first == name)
+        {
+            stat.second += value;
+            return;
+        }
+    }
+    stats.push_back(std::make_pair(name, value));
+}
+
+void PhaseProfiler::report()
+{
+    if (!Options::PhaseTrace.empty())
+        writeChromeTrace(Options::PhaseTrace);
+    if (Options::PhaseStat)
+        printSummary(SVFUtil::outs());
+}
+
+/*!
+ * Complete ("X") events, one per closed phase, in the Chrome trace event format
+ */
+void PhaseProfiler::writeChromeTrace(const std::string& file) const
+{
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(file, EC, llvm::sys::fs::F_None);
+    if (EC)
+    {
+        SVFUtil::errs() << "cannot write phase trace " << file << ": " << EC.message() << "\n";
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(phaseMutex);
+    OS << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const Phase& phase : phases)
+    {
+        if (phase.wallUs < 0)
+            continue;
+        if (!first)
+            OS << ",\n";
+        first = false;
+        OS << "{\"name\":\"" << escapeJSON(phase.name) << "\",\"cat\":\"svf\",\"ph\":\"X\""
+           << ",\"pid\":1,\"tid\":" << phase.tid
+           << ",\"ts\":" << llvm::format("%.3f", phase.startUs)
+           << ",\"dur\":" << llvm::format("%.3f", phase.wallUs)
+           << ",\"args\":{\"cpu_ms\":" << llvm::format("%.3f", phase.cpuMs)
+           << ",\"rss_kb\":" << phase.rssStartKB + phase.rssDeltaKB
+           << ",\"rss_delta_kb\":" << phase.rssDeltaKB << "}}";
+    }
+    OS << "\n]}\n";
+}
+
+/*!
+ * Phases with the same name under the same parents are folded into one row,
+ * rows are indented by nesting depth and kept in order of first appearance
+ */
+void PhaseProfiler::printSummary(llvm::raw_ostream& O) const
+{
+    struct Row
+    {
+        std::string name;
+        u32_t depth;
+        u32_t calls;
+        double wallMs;
+        double cpuMs;
+        s32_t rssDeltaKB;
+    };
+    std::vector<Row> rows;
+    Map<std::string, u32_t> rowIdx;
+
+    std::lock_guard<std::mutex> lock(phaseMutex);
+    for (const Phase& phase : phases)
+    {
+        if (phase.wallUs < 0)
+            continue;
+        std::string key = std::to_string(phase.tid) + ":" + phase.parent + "/" + phase.name;
+        auto it = rowIdx.find(key);
+        if (it == rowIdx.end())
+        {
+            it = rowIdx.emplace(key, rows.size()).first;
+            rows.push_back({phase.name, phase.depth, 0, 0, 0, 0});
+        }
+        Row& row = rows[it->second];
+        row.calls++;
+        row.wallMs += phase.wallUs / 1000.0;
+        row.cpuMs += phase.cpuMs;
+        row.rssDeltaKB += phase.rssDeltaKB;
+    }
+
+    O << "\n****Phase Profile****\n";
+    O << llvm::format("%-40s %8s %12s %12s %14s\n", "Phase", "Calls", "Wall(ms)", "CPU(ms)", "RSS delta(KB)");
+    for (const Row& row : rows)
+    {
+        std::string name = std::string(row.depth * 2, ' ') + row.name;
+        O << llvm::format("%-40s %8u %12.1f %12.1f %14d\n", name.c_str(), row.calls,
+                          row.wallMs, row.cpuMs, row.rssDeltaKB);
+    }
+    if (!stats.empty())
+        O << "\n";
+    for (const auto& stat : stats)
+        O << llvm::format("%-40s %8llu\n", stat.first.c_str(), stat.second);
+    O << "#######################################################\n";
+    O.flush();
+}
@@ -32,6 +32,8 @@
 
 #include "Util/ThreadAPI.h"
 #include "Util/SVFUtil.h"
+#include "SVF-FE/LLVMModule.h"
+#include "RustIsolation/RustDemangle.h"
 
 #include <iostream>		/// std output
 #include <stdio.h>
@@ -95,6 +97,284 @@ static const ei_pair ei_pairs[]=
     {0, ThreadAPI::TD_DUMMY}
 };
 
+/// Rust thread APIs, matched against demangled paths without generic arguments and hash.
+/// std::thread::scope itself runs its closure in the current thread, threads spawned in a scope
+/// are modeled by Scope::spawn and ScopedJoinHandle::join.
+static const char* rust_fork_apis[] =
+{
+    "std::thread::spawn",
+    "std::thread::Builder::spawn",
+    "std::thread::Builder::spawn_scoped",
+    "std::thread::Scope::spawn",
+    "std::thread::scoped::Scope::spawn",
+    "tokio::task::spawn_blocking",
+    "tokio::task::blocking::spawn_blocking",
+    "tokio::runtime::Handle::spawn_blocking",
+    "tokio::runtime::handle::Handle::spawn_blocking",
+    "tokio::runtime::Runtime::spawn_blocking",
+    "tokio::runtime::runtime::Runtime::spawn_blocking",
+    0
+};
+
+static const char* rust_join_apis[] =
+{
+    "std::thread::JoinHandle::join",
+    "std::thread::ScopedJoinHandle::join",
+    "std::thread::scoped::ScopedJoinHandle::join",
+    0
+};
+
+/// Functions under these paths implement the thread runtime of std and tokio
+static const char* rust_runtime_prefixes[] =
+{
+    "std::thread::",
+    "std::sys::",
+    "std::sys_common::",
+    "tokio::runtime::",
+    "tokio::task::",
+    0
+};
+
+/// The closure of a spawn API is searched through the functions of these crates
+static const char* rust_library_prefixes[] =
+{
+    "std::",
+    "core::",
+    "alloc::",
+    "tokio::",
+    0
+};
+
+static bool hasRustPathPrefix(const std::string& path, const char** prefixes)
+{
+    for (const char** p = prefixes; *p; ++p)
+    {
+        if (path.compare(0, strlen(*p), *p) == 0)
+            return true;
+    }
+    return false;
+}
+
+static bool isRustPathIn(const std::string& path, const char** paths)
+{
+    for (const char** p = paths; *p; ++p)
+    {
+        if (path == *p)
+            return true;
+    }
+    return false;
+}
+
+/*!
+ * Return the demangled path of a Rust function without generic arguments and hash, e.g.,
+ * "<std::thread::JoinHandle<T>>::join::h0123456789abcdef" --> "std::thread::JoinHandle::join"
+ * Return an empty string if it is not a Rust function
+ */
+static std::string getRustPath(const Function* fun)
+{
+    std::string name = fun->getName().str();
+    if (name.compare(0, 3, "_ZN") != 0 && name.compare(0, 2, "_R") != 0)
+        return "";
+
+    std::vector<char> demangled(4096, 0);
+    if (demangle_func_name((char*) name.c_str(), demangled.data(), demangled.size()) != 0)
+        return "";
+
+    std::string path;
+    u32_t depth = 0;
+    for (const char* c = demangled.data(); *c; ++c)
+    {
+        /// a leading '<' opens a qualified path (<Type>::f or <Type as Trait>::f), not generic arguments
+        if (*c == '<' && c != demangled.data())
+            depth++;
+        else if (*c == '>' && *(c - 1) != '-')
+        {
+            if (depth > 0)
+                depth--;
+        }
+        else if (depth == 0 && *c != '<')
+            path += *c;
+    }
+
+    /// legacy symbols end with "::h" followed by a 16-digit hash
+    size_t pos = path.rfind("::h");
+    if (pos != std::string::npos && path.size() - pos == 19)
+        path.erase(pos);
+    return path;
+}
+
+/*!
+ * Push the functions referenced by a constant, including those in vtables
+ */
+static void collectReferencedFunctions(const Constant* C, std::vector<const Function*>& worklist, Set<const Constant*>& visited)
+{
+    if (visited.insert(C).second == false)
+        return;
+
+    if (const Function* fun = SVFUtil::dyn_cast<Function>(C))
+        worklist.push_back(fun);
+    else if (const GlobalVariable* global = SVFUtil::dyn_cast<GlobalVariable>(C))
+    {
+        if (global->hasInitializer())
+            collectReferencedFunctions(global->getInitializer(), worklist, visited);
+    }
+    else
+    {
+        /// A BlockAddress has its BasicBlock as an operand
+        for (const Use& opnd : C->operands())
+            if (const Constant* opndC = SVFUtil::dyn_cast<Constant>(opnd.get()))
+                collectReferencedFunctions(opndC, worklist, visited);
+    }
+}
+
+/*!
+ * Find the closure run by an instance of a Rust spawn API.
+ * The closure is boxed into a Box<dyn FnOnce> by std, so we search the functions referenced
+ * (called, or put into vtables) by the instance and the library functions reachable from it,
+ * the first function outside of the Rust libraries is the closure.
+ */
+static const Function* findRustSpawnee(const Function* api, Map<const Function*, std::string>& rustPaths)
+{
+    std::vector<const Function*> worklist;
+    Set<const Constant*> visited;
+    collectReferencedFunctions(api, worklist, visited);
+
+    for (u32_t i = 0; i < worklist.size(); ++i)
+    {
+        const Function* fun = worklist[i];
+        if (fun->isDeclaration())
+            continue;
+
+        Map<const Function*, std::string>::iterator it = rustPaths.find(fun);
+        if (it == rustPaths.end())
+            it = rustPaths.insert(std::make_pair(fun, getRustPath(fun))).first;
+        const std::string& path = it->second;
+        if (path.empty())
+            continue;
+
+        /// drop glue and other trait impls (Drop, Debug, ...) of the captured values are not the closure,
+        /// while FnOnce shims of the closure lead to it
+        bool isFnShim = path.find(" as core::ops::function::Fn") != std::string::npos;
+        if (isFnShim == false && (path.find(" as core::") != std::string::npos || path.rfind("core::ptr::drop_in_place", 0) == 0))
+            continue;
+
+        if (fun != api && isFnShim == false && hasRustPathPrefix(path, rust_library_prefixes) == false)
+            return fun;
+
+        for (const BasicBlock& bb : *fun)
+        {
+            for (const Instruction& inst : bb)
+            {
+                for (const Use& opnd : inst.operands())
+                {
+                    if (const Constant* C = SVFUtil::dyn_cast<Constant>(opnd.get()))
+                        collectReferencedFunctions(C, worklist, visited);
+                }
+            }
+        }
+    }
+    return nullptr;
+}
+
+/*!
+ * Collect the instances of Rust thread APIs and the functions of the Rust thread runtime
+ */
+void ThreadAPI::initRustTDAPIs() const
+{
+    SVFModule* svfModule = LLVMModuleSet::getLLVMModuleSet()->getSVFModule();
+    Map<const Function*, std::string> rustPaths;
+
+    for (SVFModule::llvm_const_iterator it = svfModule->llvmFunBegin(), eit = svfModule->llvmFunEnd(); it != eit; ++it)
+    {
+        const Function* fun = *it;
+        if (fun->isDeclaration())
+            continue;
+        StringRef name = fun->getName();
+        if (name.contains("thread") == false && name.contains("tokio") == false)
+            continue;
+
+        std::string path = getRustPath(fun);
+        rustPaths[fun] = path;
+        if (path.empty())
+            continue;
+
+        if (hasRustPathPrefix(path, rust_runtime_prefixes))
+            rustRuntimeFuns.insert(fun);
+
+        const SVFFunction* svfFun = LLVMModuleSet::getLLVMModuleSet()->getSVFFunction(fun);
+        if (isRustPathIn(path, rust_fork_apis))
+        {
+            if (const Function* spawnee = findRustSpawnee(fun, rustPaths))
+            {
+                rustTDAPIMap[svfFun] = TD_FORK;
+                rustSpawneeMap[svfFun] = spawnee;
+            }
+            else
+                SVFUtil::writeWrnMsg("closure not found for Rust thread API " + path);
+        }
+        else if (isRustPathIn(path, rust_join_apis))
+        {
+            /// the JoinHandle is passed by reference
+            for (const Argument& arg : fun->args())
+            {
+                if (arg.hasStructRetAttr() == false && SVFUtil::isa<PointerType>(arg.getType()))
+                {
+                    rustTDAPIMap[svfFun] = TD_JOIN;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/*!
+ * The JoinHandle returned by a Rust spawn API, it is either returned through
+ * a struct-return pointer or returned directly (e.g., tokio's JoinHandle is a pointer)
+ */
+const Value* ThreadAPI::getRustForkedThread(const Instruction *inst) const
+{
+    CallSite cs = getLLVMCallSite(inst);
+    if (cs.arg_size() > 0 && cs.paramHasAttr(0, llvm::Attribute::StructRet))
+        return cs.getArgument(0);
+    return inst;
+}
+
+/*!
+ * The closure passed to a Rust spawn API, which is the argument having the type of the
+ * first parameter of the closure, or nullptr if the closure captures nothing
+ */
+const Value* ThreadAPI::getRustActualParmAtForkSite(const Instruction *inst) const
+{
+    const Function* spawnee = rustSpawneeMap.at(getCallee(inst));
+    if (spawnee->arg_size() == 0)
+        return nullptr;
+
+    Type* closureTy = spawnee->arg_begin()->getType();
+    CallSite cs = getLLVMCallSite(inst);
+    for (u32_t i = cs.arg_size(); i > 0; --i)
+    {
+        if (cs.paramHasAttr(i - 1, llvm::Attribute::StructRet))
+            continue;
+        if (cs.getArgument(i - 1)->getType() == closureTy)
+            return cs.getArgument(i - 1);
+    }
+    return nullptr;
+}
+
+/*!
+ * The JoinHandle joined by a Rust join API, it is the first non-struct-return pointer argument
+ */
+const Value* ThreadAPI::getRustJoinedThread(const Instruction *inst) const
+{
+    CallSite cs = getLLVMCallSite(inst);
+    for (u32_t i = 0; i < cs.arg_size(); ++i)
+    {
+        if (cs.paramHasAttr(i, llvm::Attribute::StructRet) == false && SVFUtil::isa<PointerType>(cs.getArgument(i)->getType()))
+            return cs.getArgument(i);
+    }
+    return nullptr;
+}
+
 /*!
  * initialize the map
  */
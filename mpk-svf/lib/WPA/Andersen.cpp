@@ -28,6 +28,7 @@
  */
 
 #include "Util/Options.h"
+#include "Util/PhaseProfiler.h"
 #include "SVF-FE/LLVMUtil.h"
 #include "WPA/Andersen.h"
 
@@ -90,6 +91,7 @@ void AndersenBase::finalize()
  */
 void AndersenBase::analyze()
 {
+    PhaseTimer timer("Andersen");
     /// Initialization for the Solver
     initialize();
 
@@ -148,7 +150,6 @@ void AndersenBase::cleanConsCG(NodeID id) {
 void AndersenBase::normalizePointsTo()
 {
     PAG::MemObjToFieldsMap &memToFieldsMap = pag->getMemToFieldsMap();
-    PAG::NodeLocationSetMap &GepObjNodeMap = pag->getGepObjNodeMap();
 
     // clear GepObjNodeMap/memToFieldsMap/nodeToSubsMap/nodeToRepMap
     // for redundant gepnodes and remove those nodes from pag
@@ -157,7 +158,7 @@ void AndersenBase::normalizePointsTo()
         GepObjPN *gepNode = SVFUtil::dyn_cast<GepObjPN>(pag->getPAGNode(n));
         assert(gepNode && "Not a gep node in redundantGepNodes set");
         const LocationSet ls = gepNode->getLocationSet();
-        GepObjNodeMap.erase(std::make_pair(base, ls));
+        pag->removeGepObjNodeEntry(base, ls);
         memToFieldsMap[base].reset(n);
         cleanConsCG(n);
 
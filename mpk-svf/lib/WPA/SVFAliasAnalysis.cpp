@@ -0,0 +1,452 @@
+//===- SVFAliasAnalysis.cpp -- SVF results as an LLVM alias analysis --------//
+
+/*
+ * SVFAliasAnalysis.cpp
+ *
+ * Two pointers are NoAlias when their points-to sets name disjoint base
+ * objects; MustAlias is never claimed. Call mod-ref answers come from
+ * MRGenerator's side effects of the callees, compared by base object as well.
+ */
+
+#include "WPA/SVFAliasAnalysis.h"
+#include "WPA/Andersen.h"
+#include "DDA/ContextDDA.h"
+#include "DDA/DDAClient.h"
+#include "MSSA/MemSSA.h"
+#include "MSSA/SVFGBuilder.h"
+#include "SVF-FE/LLVMModule.h"
+#include "SVF-FE/PAGBuilder.h"
+#include "Util/ExtAPI.h"
+#include "Util/Options.h"
+#include "Util/PhaseProfiler.h"
+
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+
+using namespace SVF;
+using namespace SVFUtil;
+
+char SVFAAWrapperPass::ID = 0;
+char SVFAABuildPass::ID = 0;
+
+namespace
+{
+/*!
+ * Declarations whose memory side effects MRGenerator sees: functions that do
+ * not touch memory, markers, heap allocators and memcpy/memmove, whose loads
+ * and stores the PAG models at the call site
+ */
+bool isModeledDeclaration(const Function* fun)
+{
+    if (fun->doesNotAccessMemory())
+        return true;
+
+    switch (fun->getIntrinsicID())
+    {
+    case llvm::Intrinsic::lifetime_start:
+    case llvm::Intrinsic::lifetime_end:
+    case llvm::Intrinsic::dbg_declare:
+    case llvm::Intrinsic::dbg_value:
+    case llvm::Intrinsic::dbg_label:
+    case llvm::Intrinsic::assume:
+        return true;
+    default:
+        break;
+    }
+
+    const SVFFunction* svfFun = LLVMModuleSet::getLLVMModuleSet()->getSVFFunction(fun);
+    if (svfFun == nullptr)
+        return false;
+    ExtAPI* extAPI = ExtAPI::getExtAPI();
+    return extAPI->is_alloc(svfFun) || extAPI->get_type(svfFun) == ExtAPI::EFT_L_A0__A0R_A1R;
+}
+}
+
+SVFAAResult::SVFAAResult(Module& module) :
+    llvm::AAResultBase<SVFAAResult>(), pag(nullptr), ander(nullptr), dda(nullptr), client(nullptr), mssa(nullptr)
+{
+    PhaseTimer timer("SVF AA");
+
+    llvm::ValueToValueMapTy vmap;
+    analyzed = llvm::CloneModule(module, vmap);
+    SVFModule* svfModule = LLVMModuleSet::getLLVMModuleSet()->buildSVFModule(*analyzed);
+    PAGBuilder builder;
+    pag = builder.build(svfModule);
+    addUnknownSources(builder, *analyzed);
+
+    if (Options::SVFAAUseDDA)
+    {
+        VFPathCond::setMaxPathLen(Options::MaxPathLen);
+        ContextCond::setMaxCxtLen(Options::MaxContextLen);
+        client = new DDAClient(svfModule);
+        dda = new ContextDDA(pag, client);
+        dda->initialize();
+    }
+    /// ContextDDA refines the same Andersen's instance
+    ander = AndersenWaveDiff::createAndersenWaveDiff(pag);
+    mssa = new MemSSA(ander, false);
+
+    collectClosedFunctions(*analyzed);
+
+    /// Queries come for the values of the module; copies SVF deleted (e.g.,
+    /// summarized bodies) are null in vmap
+    auto addValue = [&](const Value* val)
+    {
+        const Value* copy = vmap.lookup(val);
+        if (copy != nullptr && pag->hasValueNode(copy))
+            valueToNode[val] = pag->getValueNode(copy);
+    };
+    for (GlobalVariable& global : module.globals())
+        addValue(&global);
+    for (Function& fun : module)
+    {
+        addValue(&fun);
+        if (const Function* copy = llvm::cast_or_null<Function>(vmap.lookup(&fun)))
+            analyzedFunctions[&fun] = copy;
+        for (Argument& arg : fun.args())
+            addValue(&arg);
+        for (Instruction& inst : llvm::instructions(fun))
+        {
+            addValue(&inst);
+            const Instruction* copy = llvm::cast_or_null<Instruction>(vmap.lookup(&inst));
+            if (copy != nullptr && isNonInstricCallSite(copy))
+                callToNode[&inst] = pag->getICFG()->getCallBlockNode(copy);
+        }
+    }
+}
+
+SVFAAResult::~SVFAAResult()
+{
+    delete mssa;
+    delete dda;
+    delete client;
+
+    SVFGBuilder::releaseSVFG();
+    AndersenWaveDiff::releaseAndersenWaveDiff();
+    PAG::releasePAG();
+    SymbolTableInfo::releaseSymbolInfo();
+    LLVMModuleSet::releaseLLVMModuleSet();
+}
+
+/*!
+ * SVF only sees the module, so whatever outside code may pass in or hand back
+ * is the black hole object:
+ *  - arguments of functions other than main that are externally visible or
+ *    address-taken point to it
+ *  - externally visible globals point to it, so everything loaded through
+ *    them may be unknown
+ *  - pointers returned to or passed into unmodeled external functions escape
+ *    into it, and their results and pointees may be any escaped pointer
+ * The black hole object points to itself, so loads through unknown pointers
+ * stay unknown. The edges have no program point of their own; like the
+ * edges of global initializers they belong to the global ICFG node, where
+ * the SVFG of ContextDDA picks them up.
+ */
+void SVFAAResult::addUnknownSources(PAGBuilder& builder, Module& module)
+{
+    LLVMContext& cxt = module.getContext();
+    builder.setCurrentLocation(llvm::ConstantPointerNull::get(Type::getInt8PtrTy(cxt)), nullptr);
+
+    NodeID blkPtr = pag->getBlkPtr();
+    if (pag->hasNonlabeledEdge(pag->getPAGNode(pag->getBlackHoleNode()), pag->getPAGNode(blkPtr), PAGEdge::Addr) == nullptr)
+        builder.addAddrEdge(pag->getBlackHoleNode(), blkPtr);
+    builder.addStoreEdge(blkPtr, blkPtr);
+
+    for (GlobalVariable& global : module.globals())
+    {
+        if (!global.hasLocalLinkage() && pag->hasValueNode(&global))
+            builder.addCopyEdge(blkPtr, pag->getValueNode(&global));
+    }
+
+    ExtAPI* extAPI = ExtAPI::getExtAPI();
+    for (Function& fun : module)
+    {
+        if (fun.isDeclaration())
+            continue;
+
+        const SVFFunction* svfFun = LLVMModuleSet::getLLVMModuleSet()->getSVFFunction(&fun);
+        if (fun.getName() != "main" && (!fun.hasLocalLinkage() || fun.hasAddressTaken()))
+        {
+            for (Argument& arg : fun.args())
+                if (arg.getType()->isPointerTy() && pag->hasValueNode(&arg))
+                    builder.addCopyEdge(blkPtr, pag->getValueNode(&arg));
+            if (fun.getReturnType()->isPointerTy() && pag->funHasRet(svfFun))
+                builder.addStoreEdge(pag->getReturnNode(svfFun), blkPtr);
+        }
+
+        for (Instruction& inst : llvm::instructions(fun))
+        {
+            const CallBase* call = llvm::dyn_cast<CallBase>(&inst);
+            if (call == nullptr || llvm::isa<llvm::IntrinsicInst>(call))
+                continue;
+            const SVFFunction* callee = getCallee(&inst);
+            if (callee == nullptr || !callee->isDeclaration() || extAPI->get_type(callee) != ExtAPI::EFT_OTHER)
+                continue;
+
+            if (call->getType()->isPointerTy() && pag->hasValueNode(call))
+                builder.addCopyEdge(blkPtr, pag->getValueNode(call));
+            for (const llvm::Use& use : call->args())
+            {
+                const Value* arg = use.get();
+                if (!arg->getType()->isPointerTy() || !pag->hasValueNode(arg))
+                    continue;
+                NodeID argNode = pag->getValueNode(arg);
+                builder.addStoreEdge(argNode, blkPtr);
+                builder.addStoreEdge(blkPtr, argNode);
+            }
+        }
+    }
+}
+
+/*!
+ * A declaration is closed if MRGenerator models its side effects. A defined
+ * function is closed if it has no atomics or inline assembly, every indirect
+ * call it makes is resolved and every function it calls is closed as well.
+ */
+void SVFAAResult::collectClosedFunctions(Module& module)
+{
+    PTACallGraph* callgraph = ander->getPTACallGraph();
+    Map<const Function*, Set<const Function*>> callees;
+
+    for (Function& fun : module)
+    {
+        if (fun.isDeclaration())
+        {
+            if (isModeledDeclaration(&fun))
+                closedFunctions.insert(&fun);
+            continue;
+        }
+
+        bool closed = true;
+        Set<const Function*>& funCallees = callees[&fun];
+        for (Instruction& inst : llvm::instructions(fun))
+        {
+            if (llvm::isa<llvm::AtomicRMWInst>(inst) || llvm::isa<llvm::AtomicCmpXchgInst>(inst))
+                closed = false;
+            else if (const CallBase* call = llvm::dyn_cast<CallBase>(&inst))
+            {
+                if (call->isInlineAsm())
+                    closed = false;
+                else if (const Function* callee = call->getCalledFunction())
+                    funCallees.insert(callee);
+                else
+                {
+                    PTACallGraph::FunctionSet targets;
+                    callgraph->getCallees(pag->getICFG()->getCallBlockNode(&inst), targets);
+                    if (targets.empty())
+                        closed = false;
+                    for (const SVFFunction* target : targets)
+                        funCallees.insert(target->getLLVMFun());
+                }
+            }
+            if (!closed)
+                break;
+        }
+        if (closed)
+            closedFunctions.insert(&fun);
+    }
+
+    /// A function is open once any function it calls is
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (auto& it : callees)
+        {
+            if (!closedFunctions.count(it.first))
+                continue;
+            for (const Function* callee : it.second)
+            {
+                if (!closedFunctions.count(callee))
+                {
+                    closedFunctions.erase(it.first);
+                    changed = true;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/*!
+ * Values the analysis saw and that still exist, with points-to sets that
+ * are non-empty and do not contain the black hole object
+ */
+bool SVFAAResult::getPts(const Value* V, PointsTo& pts)
+{
+    auto it = valueToNode.find(V);
+    if (it == valueToNode.end())
+        return false;
+
+    NodeID id = it->second;
+    if (dda != nullptr && pag->isValidTopLevelPtr(pag->getPAGNode(id)))
+    {
+        ContextCond cxt;
+        CxtVar var(cxt, id);
+        pts = dda->getBVPointsTo(dda->computeDDAPts(var, false));
+    }
+    else
+        pts = ander->getPts(id);
+
+    if (pts.empty())
+        return false;
+    for (NodeID obj : pts)
+        if (pag->isBlkObj(pag->getBaseObjNode(obj)))
+            return false;
+    return true;
+}
+
+const CallBlockNode* SVFAAResult::getClosedCall(const CallBase* call)
+{
+    auto it = callToNode.find(call);
+    if (it == callToNode.end())
+        return nullptr;
+
+    /// The optimizers may have made an indirect call direct
+    const CallBlockNode* cs = it->second;
+    if (const Function* callee = call->getCalledFunction())
+    {
+        auto copy = analyzedFunctions.find(callee);
+        return copy != analyzedFunctions.end() && closedFunctions.count(copy->second) ? cs : nullptr;
+    }
+
+    PTACallGraph::FunctionSet targets;
+    ander->getPTACallGraph()->getCallees(cs, targets);
+    if (targets.empty())
+        return nullptr;
+    for (const SVFFunction* target : targets)
+        if (!closedFunctions.count(target->getLLVMFun()))
+            return nullptr;
+    return cs;
+}
+
+void SVFAAResult::getBaseObjs(const PointsTo& pts, NodeBS& objs)
+{
+    for (NodeID obj : pts)
+        objs.set(pag->getBaseObjNode(obj));
+}
+
+/*!
+ * Base objects the call may modify and read, false if the call may touch
+ * unknown memory. A location points to a field object at the offset of its
+ * pointer, which need not be the field the call accesses (e.g., a memcpy
+ * over the whole object), so only base objects can be compared.
+ */
+bool SVFAAResult::getCallModRef(const CallBlockNode* cs, NodeBS& mod, NodeBS& ref)
+{
+    MRGenerator* mrGen = mssa->getMRGenerator();
+    PointsTo modObjs, refObjs;
+    ander->expandFIObjs(mrGen->getModInfoForCall(cs), modObjs);
+    ander->expandFIObjs(mrGen->getRefInfoForCall(cs), refObjs);
+    getBaseObjs(modObjs, mod);
+    getBaseObjs(refObjs, ref);
+    for (NodeID obj : mod)
+        if (pag->isBlkObj(obj))
+            return false;
+    for (NodeID obj : ref)
+        if (pag->isBlkObj(obj))
+            return false;
+    return true;
+}
+
+AliasResult SVFAAResult::alias(const MemoryLocation& LocA, const MemoryLocation& LocB, llvm::AAQueryInfo& AAQI)
+{
+    PointsTo ptsA, ptsB;
+    if (getPts(LocA.Ptr, ptsA) && getPts(LocB.Ptr, ptsB))
+    {
+        NodeBS objsA, objsB;
+        getBaseObjs(ptsA, objsA);
+        getBaseObjs(ptsB, objsB);
+        if (!objsA.intersects(objsB))
+            return AliasResult::NoAlias;
+    }
+    return llvm::AAResultBase<SVFAAResult>::alias(LocA, LocB, AAQI);
+}
+
+ModRefInfo SVFAAResult::getModRefInfo(const CallBase* call, const MemoryLocation& loc, llvm::AAQueryInfo& AAQI)
+{
+    PointsTo pts;
+    NodeBS mod, ref;
+    const CallBlockNode* cs = getClosedCall(call);
+    if (cs != nullptr && getPts(loc.Ptr, pts) && getCallModRef(cs, mod, ref))
+    {
+        NodeBS objs;
+        getBaseObjs(pts, objs);
+        ModRefInfo result = ModRefInfo::NoModRef;
+        if (mod.intersects(objs))
+            result = llvm::setMod(result);
+        if (ref.intersects(objs))
+            result = llvm::setRef(result);
+        return result;
+    }
+    return llvm::AAResultBase<SVFAAResult>::getModRefInfo(call, loc, AAQI);
+}
+
+ModRefInfo SVFAAResult::getModRefInfo(const CallBase* call1, const CallBase* call2, llvm::AAQueryInfo& AAQI)
+{
+    NodeBS mod1, ref1, mod2, ref2;
+    const CallBlockNode* cs1 = getClosedCall(call1);
+    const CallBlockNode* cs2 = getClosedCall(call2);
+    if (cs1 != nullptr && cs2 != nullptr && getCallModRef(cs1, mod1, ref1) && getCallModRef(cs2, mod2, ref2))
+    {
+        ModRefInfo result = ModRefInfo::NoModRef;
+        /// call1 modifies what call2 reads or modifies
+        if (mod1.intersects(ref2) || mod1.intersects(mod2))
+            result = llvm::setMod(result);
+        /// call1 reads what call2 modifies
+        if (ref1.intersects(mod2))
+            result = llvm::setRef(result);
+        return result;
+    }
+    return llvm::AAResultBase<SVFAAResult>::getModRefInfo(call1, call2, AAQI);
+}
+
+/*!
+ * SVF's singletons (PAG, Andersen's, the LLVM module set) hold one analysis
+ * at a time, so the old result goes before the new one is built
+ */
+void SVFAAWrapperPass::buildResult(Module& module)
+{
+    result.reset();
+    result.reset(new SVFAAResult(module));
+}
+
+bool SVFAAWrapperPass::doFinalization(Module& module)
+{
+    result.reset();
+    return false;
+}
+
+/*!
+ * SVF needs the whole program, so the result is only built for a module
+ * that defines main, i.e. when linking an executable with LTO
+ */
+bool SVFAABuildPass::runOnModule(Module& module)
+{
+    const Function* mainFun = module.getFunction("main");
+    if (mainFun == nullptr || mainFun->isDeclaration())
+        return false;
+    getAnalysis<SVFAAWrapperPass>().buildResult(module);
+    return false;
+}
+
+llvm::ImmutablePass* SVF::createSVFAAWrapperPass()
+{
+    return new SVFAAWrapperPass();
+}
+
+llvm::ModulePass* SVF::createSVFAABuildPass()
+{
+    return new SVFAABuildPass();
+}
+
+llvm::ImmutablePass* SVF::createSVFExternalAAWrapperPass()
+{
+    return llvm::createExternalAAWrapperPass([](llvm::Pass& P, Function&, llvm::AAResults& AAR)
+    {
+        if (SVFAAWrapperPass* wrapper = P.getAnalysisIfAvailable<SVFAAWrapperPass>())
+            if (wrapper->hasResult())
+                AAR.addAAResult(wrapper->getResult());
+    });
+}
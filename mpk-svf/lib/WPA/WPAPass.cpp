@@ -39,6 +39,7 @@
 #include "Util/BasicTypes.h"
 #include "Util/Casting.h"
 #include "Util/Options.h"
+#include "Util/PhaseProfiler.h"
 #include "Util/SVFBasicTypes.h"
 #include "Util/SVFModule.h"
 #include "MemoryModel/PointerAnalysisImpl.h"
@@ -652,11 +653,17 @@ void WPAPass::runOnModule(SVFModule* svfModule)
 //    constructAllocFuncCallGraphs(svfModule,pag, callGraph);
 //
 //    ///Find and mark unsafe pointers, unsafe alloc entry calls
-    findUnsafePointers(_svfg,pag,svfModule);
+    {
+        PhaseTimer timer("findUnsafePointers");
+        findUnsafePointers(_svfg,pag,svfModule);
+    }
 
     removeDummyLoads(svfModule);
 
     LLVMModuleSet::getLLVMModuleSet()->dumpModulesToFile(".bc");
+
+    if (PhaseProfiler::isEnabled())
+        PhaseProfiler::getProfiler()->report();
 }
 
 /*!
@@ -0,0 +1,40 @@
+; Objects handed to MPK-Unsafe calls of C functions. Each holder stores a
+; pointer to an inner object and is passed to a different declaration:
+;
+;   ext_peek   summarized "arg0:nofollow": only the holder is unsafe
+;   ext_plain  no summary: the dummy load follows the holder to the inner object
+;   ext_store  its summary flags the stored-through arg0 readonly and is
+;              rejected, so it is followed like ext_plain
+;
+; unsafe-objects.txt lists the allocas dvf has to mark MPK-Extern-Move.
+
+declare void @ext_peek(i8*)
+declare void @ext_plain(i8*)
+declare void @ext_store(i8*, i8*)
+
+define i32 @main() {
+entry:
+  %peek.inner = alloca i8
+  %peek.holder = alloca i8*
+  store i8* %peek.inner, i8** %peek.holder
+  %peek.arg = bitcast i8** %peek.holder to i8*
+  call void @ext_peek(i8* %peek.arg), !MPK-Unsafe !0
+
+  %plain.inner = alloca i8
+  %plain.holder = alloca i8*
+  store i8* %plain.inner, i8** %plain.holder
+  %plain.arg = bitcast i8** %plain.holder to i8*
+  call void @ext_plain(i8* %plain.arg), !MPK-Unsafe !0
+
+  %store.inner = alloca i8
+  %store.holder = alloca i8*
+  store i8* %store.inner, i8** %store.holder
+  %store.arg = bitcast i8** %store.holder to i8*
+  call void @ext_store(i8* %store.arg, i8* null), !MPK-Unsafe !0
+
+  %safe = alloca i8
+  store i8 0, i8* %safe
+  ret i32 0
+}
+
+!0 = !{!"unsafe call"}
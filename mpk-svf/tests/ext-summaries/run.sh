@@ -0,0 +1,30 @@
+#!/bin/sh
+# Runs dvf with -ext-summaries on ext-summaries.ll and compares the allocas
+# marked MPK-Extern-Move with unsafe-objects.txt.
+#
+# usage: run.sh <dvf> <source dir> <work dir>
+set -e
+
+DVF=$1
+SRC=$2
+WORK=$3
+
+mkdir -p "$WORK"
+cp "$SRC/ext-summaries.ll" "$WORK/"
+cd "$WORK"
+rm -f ext-summaries.bc ext-summaries.bc.ll
+
+"$DVF" -cxt -ext-summaries="$SRC/ext-summaries.txt" ext-summaries.ll > dvf.out 2>&1 || {
+    cat dvf.out
+    exit 1
+}
+
+if ! grep -q "Malformed external function summary in .*ext_store" dvf.out; then
+    echo "the readonly ext_store summary was not rejected"
+    cat dvf.out
+    exit 1
+fi
+
+grep 'alloca.*!MPK-Extern-Move' ext-summaries.bc.ll \
+    | sed 's/^ *%\([^ ]*\) = .*/\1/' | sort > unsafe-objects.txt
+diff -u "$SRC/unsafe-objects.txt" unsafe-objects.txt
@@ -0,0 +1,48 @@
+/*
+ // SVF alias analysis plugin
+ //
+ // Loaded into opt (-load libSvfAA.so) or the full LTO of lld, it builds the
+ // SVF alias analysis after inlining for the optimizations that follow.
+ */
+
+#include "WPA/SVFAliasAnalysis.h"
+
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/Transforms/IPO/PassManagerBuilder.h>
+#include <llvm/Transforms/Scalar.h>
+#include <llvm/Transforms/Scalar/GVN.h>
+
+using namespace llvm;
+using namespace SVF;
+
+static RegisterPass<SVFAAWrapperPass> SVFAA("svf-aa", "SVF whole-program alias analysis", false, true);
+static RegisterPass<SVFAABuildPass> SVFAABuild("svf-aa-build", "Build the SVF whole-program alias analysis", false, true);
+
+static void addSVFAA(legacy::PassManagerBase& PM)
+{
+    PM.add(createSVFAAWrapperPass());
+    PM.add(createSVFExternalAAWrapperPass());
+    PM.add(createSVFAABuildPass());
+}
+
+/// Full LTO sees the whole program; its memory optimizations ran before the
+/// inlined module was analyzed, so they run once more with SVF's answers
+static void addSVFAALTO(const PassManagerBuilder&, legacy::PassManagerBase& PM)
+{
+    addSVFAA(PM);
+    PM.add(createLICMPass());
+    PM.add(createGVNPass());
+    PM.add(createMemCpyOptPass());
+    PM.add(createDeadStoreEliminationPass());
+}
+
+/// opt -O<n> on a linked module: the loop and vectorizer passes after the
+/// inliner use SVF's answers. A ThinLTO backend only sees one module.
+static void addSVFAAOpt(const PassManagerBuilder& builder, legacy::PassManagerBase& PM)
+{
+    if (!builder.PerformThinLTO)
+        addSVFAA(PM);
+}
+
+static RegisterStandardPasses SVFAALTO(PassManagerBuilder::EP_FullLinkTimeOptimizationLast, addSVFAALTO);
+static RegisterStandardPasses SVFAAOpt(PassManagerBuilder::EP_VectorizerStart, addSVFAAOpt);
@@ -0,0 +1,160 @@
+/*
+ // Points-To Set Benchmark
+ //
+ // Times the word kernels of DensePointsTo on each instruction set tier the
+ // host supports, checks them against the scalar kernels, and compares whole
+ // set unions with llvm::SparseBitVector
+ */
+
+#include "Util/DensePointsTo.h"
+#include "llvm/Support/CommandLine.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+using namespace llvm;
+using namespace SVF;
+
+typedef DensePointsTo::Word Word;
+typedef DensePointsTo::Kernels Kernels;
+
+static cl::opt<unsigned> Millis("bench-ms", cl::init(200),
+                               cl::desc("Milliseconds to spend per measurement"));
+
+static volatile unsigned sink;
+
+/// Nanoseconds per call of op, repeated for about -bench-ms milliseconds
+template<typename Op>
+static double measure(Op op)
+{
+    typedef std::chrono::steady_clock Clock;
+    unsigned iters = 0;
+    unsigned acc = 0;
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start + std::chrono::milliseconds(Millis);
+    Clock::time_point now;
+    do
+    {
+        for (unsigned i = 0; i < 64; i++)
+            acc += op();
+        iters += 64;
+        now = Clock::now();
+    }
+    while (now < deadline);
+    sink = acc;
+    return std::chrono::duration<double, std::nano>(now - start).count() / iters;
+}
+
+/// Whether tier computes the same as the scalar kernels on random words
+static bool checkKernels(const Kernels& k, const Kernels& scalar, std::mt19937_64& rng)
+{
+    for (unsigned n = 0; n < 67; n++)
+    {
+        std::vector<Word> a(n), b(n);
+        for (Word& w : a)
+            w = rng() & rng();
+        for (Word& w : b)
+            w = rng() & rng() & rng();
+        std::vector<Word> x = a, y = a;
+        if (k.orWords(x.data(), b.data(), n) != scalar.orWords(y.data(), b.data(), n) || x != y)
+            return false;
+        if (k.andWords(x.data(), b.data(), n) != scalar.andWords(y.data(), b.data(), n) || x != y)
+            return false;
+        if (k.andNotWords(x.data(), a.data(), n) != scalar.andNotWords(y.data(), a.data(), n) || x != y)
+            return false;
+        if (k.intersectWords(a.data(), b.data(), n) != scalar.intersectWords(a.data(), b.data(), n) ||
+                k.subsetWords(b.data(), a.data(), n) != scalar.subsetWords(b.data(), a.data(), n) ||
+                k.popcountWords(a.data(), n) != scalar.popcountWords(a.data(), n))
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char ** argv)
+{
+    cl::ParseCommandLineOptions(argc, argv, "Points-To Set Benchmark\n");
+
+    static const char* tierNames[] = {"scalar", "sse4.1", "avx2"};
+    const DensePointsTo::KernelTier tiers[] =
+    {
+        DensePointsTo::ScalarKernels, DensePointsTo::SSEKernels, DensePointsTo::AVX2Kernels
+    };
+    const Kernels& scalar = *DensePointsTo::getKernels(DensePointsTo::ScalarKernels);
+    std::mt19937_64 rng(1);
+
+    for (unsigned t = 1; t < 3; t++)
+    {
+        const Kernels* k = DensePointsTo::getKernels(tiers[t]);
+        if (k == nullptr)
+            printf("%s: not supported\n", tierNames[t]);
+        else if (!checkKernels(*k, scalar, rng))
+        {
+            printf("%s: kernels disagree with the scalar kernels\n", tierNames[t]);
+            return 1;
+        }
+    }
+
+    printf("ns per kernel call (or, and-not, intersect, subset, popcount)\n");
+    printf("%8s %10s %10s %10s\n", "words", tierNames[0], tierNames[1], tierNames[2]);
+    for (unsigned n : {8u, 64u, 512u, 4096u})
+    {
+        std::vector<Word> a(n), b(n);
+        for (Word& w : a)
+            w = rng() & rng();
+        for (Word& w : b)
+            w = rng() & rng();
+        printf("%8u", n);
+        for (unsigned t = 0; t < 3; t++)
+        {
+            const Kernels* k = DensePointsTo::getKernels(tiers[t]);
+            if (k == nullptr)
+            {
+                printf(" %10s", "-");
+                continue;
+            }
+            std::vector<Word> x = a;
+            double ns = measure([&]()
+            {
+                return k->orWords(x.data(), b.data(), n) + k->andNotWords(x.data(), b.data(), n) +
+                       k->intersectWords(x.data(), b.data(), n) + k->subsetWords(b.data(), x.data(), n) +
+                       k->popcountWords(x.data(), n);
+            });
+            printf(" %10.1f", ns / 5);
+        }
+        printf("\n");
+    }
+
+    printf("\nns per copy and union of two sets, %u%% of the ids in range set\n", 25);
+    printf("%8s %14s %14s\n", "ids", "DensePointsTo", "SparseBitVector");
+    for (unsigned range : {64u, 1024u, 16384u, 262144u})
+    {
+        DensePointsTo da, db;
+        SparseBitVector<> sa, sb;
+        for (unsigned i = 0; i < range; i++)
+        {
+            if (rng() % 4 == 0)
+            {
+                da.set(i);
+                sa.set(i);
+            }
+            if (rng() % 4 == 0)
+            {
+                db.set(i);
+                sb.set(i);
+            }
+        }
+        double dense = measure([&]()
+        {
+            DensePointsTo c = da;
+            return (c |= db) + c.count();
+        });
+        double sparse = measure([&]()
+        {
+            SparseBitVector<> c = sa;
+            return (c |= sb) + c.count();
+        });
+        printf("%8u %14.1f %14.1f\n", range, dense, sparse);
+    }
+    return 0;
+}
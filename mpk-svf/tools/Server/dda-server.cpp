@@ -0,0 +1,33 @@
+/*
+ // Demand-Driven Analysis Server
+ //
+ // Keeps the analysis of a program in memory and answers
+ // alias, points-to and isolation queries over a Unix socket
+ */
+
+#include "SVF-FE/LLVMUtil.h"
+#include "DDA/DDAServer.h"
+
+using namespace llvm;
+using namespace SVF;
+
+static cl::opt<std::string> InputFilename(cl::Positional,
+        cl::desc("<input bitcode>"), cl::init("-"));
+
+static cl::opt<std::string> SocketPath("socket", cl::init(""),
+                                       cl::desc("Unix socket to serve queries on "
+                                                "(default: $XDG_RUNTIME_DIR/dvf-server.sock)"));
+
+int main(int argc, char ** argv)
+{
+    int arg_num = 0;
+    char **arg_value = new char*[argc];
+    std::vector<std::string> moduleNameVec;
+    SVFUtil::processArguments(argc, argv, arg_num, arg_value, moduleNameVec);
+    cl::ParseCommandLineOptions(arg_num, arg_value,
+                                "Demand-Driven Analysis Server\n");
+
+    DDAServer server(moduleNameVec);
+    std::string socketPath = SocketPath.empty() ? DDAServer::getDefaultSocketPath() : SocketPath;
+    return server.serve(socketPath) ? 0 : 1;
+}
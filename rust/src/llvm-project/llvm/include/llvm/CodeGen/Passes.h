@@ -427,8 +427,20 @@ namespace llvm {
 
   FunctionPass *createMpkIsolationGatesPass();
 
+  /// This pass tags FFI calls for instruction selection from the MPKExtern
+  /// attribute, after the MPK isolation IR stage instrumented them.
+  FunctionPass *createMpkTagFFICallsPass();
+
   ModulePass *createSfiTestPass();
 
+  /// This pass confines C dependencies linked in through LTO with SFI, so
+  /// FFI calls into them need no MPK gate.
+  ModulePass *createMpkSfiCDepsPass();
+
+  /// This pass emits call graph profile edges for __mpk_unsafe clones and
+  /// FFI wrappers, so the linker places them next to their callers.
+  ModulePass *createMpkCallGraphProfilePass();
+
   /// This pass detects subregister lanes in a virtual register that are used
   /// independently of other lanes and splits them into separate virtual
   /// registers.
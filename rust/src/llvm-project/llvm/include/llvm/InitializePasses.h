@@ -382,6 +382,9 @@ void initializeSLPVectorizerPass(PassRegistry&);
 void initializeSROALegacyPassPass(PassRegistry&);
 void initializeSafeStackLegacyPassPass(PassRegistry&);
 void initializeMpkIsolationGatesPassPass(PassRegistry&);
+void initializeMpkTagFFICallsPassPass(PassRegistry&);
+void initializeMpkSfiCDepsPassPass(PassRegistry&);
+void initializeMpkCallGraphProfilePassPass(PassRegistry&);
  void initializeSfiTestPassPass(PassRegistry&);
 void initializeSafepointIRVerifierPass(PassRegistry&);
 void initializeSampleProfileLoaderLegacyPassPass(PassRegistry&);
@@ -170,6 +170,9 @@ namespace {
       (void) llvm::createSCCPPass();
       (void) llvm::createSafeStackPass();
       (void) llvm::createMpkIsolationGatesPass();
+      (void) llvm::createMpkTagFFICallsPass();
+      (void) llvm::createMpkSfiCDepsPass();
+      (void) llvm::createMpkCallGraphProfilePass();
       (void) llvm::createSfiTestPass();
       (void) llvm::createSROAPass();
       (void) llvm::createSingleLoopExtractorPass();
@@ -15,8 +15,20 @@
 #define GET_DOMAIN_FUNC_NAME "__get_domain_ptr"
 #define FALSE_POSITIVE_CHECK_FUNC_NAME "__check_false_positive"
 #define COUNT_ALLOCA_FUNC_NAME  "__count_allocas"
+#define MPK_FFI_TAIL_GATE_FUNC_NAME "__mpk_ffi_tail_gate"
+#define MPK_FFI_GATE_FUNC_NAME "__mpk_ffi_gate"
+#define MPK_ISOLATED_MD_NAME "MPK-ISOLATED"
+/* Unsafe window of mpk-library (UNSAFE_START_ADDR/UNSAFE_REGION_LEN in mpk.h) */
+#define MPK_UNSAFE_START_ADDR 0x510000000000ULL
+#define MPK_UNSAFE_REGION_MASK ((1ULL << 34) - 1)
+#define MPK_UNSAFE_ALLOC_FUNC_NAME "__mpk_unsafe__rust_alloc"
+/* Kind byte leading every XRay custom event payload (see llvm-xray mpk) */
+#define MPK_XRAY_GATE_ENTER 'E'
+#define MPK_XRAY_GATE_EXIT 'X'
+#define MPK_XRAY_UNSAFE_ALLOC 'A'
 namespace llvm {
   bool shouldHookWithMpkIsolation();
+  bool shouldRunMpkIsolationIRStage();
 
   class MpkDomain{
     Function* sfiExceptionFunc;
@@ -58,6 +70,27 @@ namespace llvm {
       return false;
     }
 
+    /// SysV x86-64: at most six integer and eight vector arguments in
+    /// registers. The shared FFI gates keep their own frame on the extern
+    /// stack and cannot forward arguments passed in memory; byval and
+    /// inalloca arguments are the caller's to reject.
+    static bool passesArgumentsInRegisters(ArrayRef<Type*> ArgTys,
+                                           const DataLayout& DL){
+      unsigned IntRegs = 0, VecRegs = 0;
+      for(Type* Ty : ArgTys){
+        if(Ty->isPointerTy() ||
+           (Ty->isIntegerTy() && Ty->getIntegerBitWidth() <= 64))
+          ++IntRegs;
+        else if((Ty->isFloatingPointTy() || Ty->isVectorTy()) &&
+                !Ty->isX86_FP80Ty() && !Ty->isFP128Ty() &&
+                DL.getTypeSizeInBits(Ty) <= 128)
+          ++VecRegs;
+        else
+          return false;
+      }
+      return IntRegs <= 6 && VecRegs <= 8;
+    }
+
     static bool shouldInstrumentFFICall(const CallBase* CB){
       if(CB != nullptr && CB->getMetadata("ADD-FFI-WRAPPER") != nullptr){
         Function* calledFunc = CB->getCalledFunction();
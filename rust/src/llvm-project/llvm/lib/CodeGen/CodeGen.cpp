@@ -99,6 +99,9 @@ void llvm::initializeCodeGen(PassRegistry &Registry) {
   initializeRenameIndependentSubregsPass(Registry);
   initializeSafeStackLegacyPassPass(Registry);
   initializeMpkIsolationGatesPassPass(Registry);
+  initializeMpkTagFFICallsPassPass(Registry);
+  initializeMpkSfiCDepsPassPass(Registry);
+  initializeMpkCallGraphProfilePassPass(Registry);
   initializeSfiTestPassPass(Registry);
   initializeScalarizeMaskedMemIntrinPass(Registry);
   initializeShrinkWrapPass(Registry);
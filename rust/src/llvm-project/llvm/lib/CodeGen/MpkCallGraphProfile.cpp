@@ -0,0 +1,171 @@
+/* Part of the MPK Isolation interface for Rust,
+ * Emits call graph edge weights for isolation-heavy code into the
+ * "CG Profile" module flag, which ends up in .llvm.call-graph-profile and is
+ * picked up by lld's call graph sort. The edges cover calls into the
+ * __mpk_unsafe clones of the DDA rewriter and calls into functions with FFI
+ * call sites, so lld places those next to their callers instead of wherever
+ * the clones happened to be appended.
+ *
+ * With PGO the CGProfile pass already records every direct call with its
+ * profile count, so only modules without a profile summary get edges here,
+ * weighted by the static block frequency of the call site.
+ */
+#include "llvm/ADT/APInt.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/MDBuilder.h"
+#include "llvm/IR/Module.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Transforms/MpkIsolation.h"
+
+#define DEBUG_TYPE "mpk-cg-profile"
+
+using namespace llvm;
+
+STATISTIC(NumUnsafeCloneEdges, "Number of call edges into __mpk_unsafe clones");
+STATISTIC(NumFFIWrapperEdges, "Number of call edges into FFI wrappers");
+
+static cl::opt<bool> EnableMpkCGProfile(
+    "mpk-cg-profile", cl::init(true), cl::Hidden,
+    cl::desc("Emit call graph profile edges for __mpk_unsafe clones and FFI "
+             "wrappers when no PGO profile is available"));
+
+static cl::opt<unsigned> MpkCGProfileScale(
+    "mpk-cg-profile-scale", cl::init(1000), cl::Hidden,
+    cl::desc("Edge weight of a call executed once per caller invocation"));
+
+namespace {
+
+class MpkCallGraphProfilePass : public ModulePass {
+public:
+  static char ID;
+  MpkCallGraphProfilePass() : ModulePass(ID) {
+    initializeMpkCallGraphProfilePassPass(*PassRegistry::getPassRegistry());
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.setPreservesAll();
+    AU.addRequired<BlockFrequencyInfoWrapperPass>();
+  }
+
+  bool runOnModule(Module &M) override;
+
+  StringRef getPassName() const override {
+    return "MPK Call Graph Profile";
+  }
+
+private:
+  using EdgeMap = MapVector<std::pair<Function *, Function *>, uint64_t>;
+  bool isIsolationCallee(const Function &F) const;
+  void addModuleFlag(Module &M, const EdgeMap &Edges);
+};
+
+} // namespace
+
+/// Clones created by the DDA rewriter and functions the gates pass found FFI
+/// calls in; both end up in .text far from the code that calls them.
+bool MpkCallGraphProfilePass::isIsolationCallee(const Function &F) const {
+  if (F.isDeclaration())
+    return false;
+  return F.getName().startswith("__mpk_unsafe") ||
+         F.getName().startswith("__mpk_flagged") ||
+         F.hasMetadata("HAS_EXTERN_CALLS");
+}
+
+/// Append to an existing "CG Profile" flag instead of adding a second one;
+/// module flag keys must be unique.
+void MpkCallGraphProfilePass::addModuleFlag(Module &M, const EdgeMap &Edges) {
+  LLVMContext &C = M.getContext();
+  MDBuilder MDB(C);
+  SmallVector<Metadata *, 64> Nodes;
+  for (const auto &E : Edges) {
+    Metadata *Vals[] = {ValueAsMetadata::get(E.first.first),
+                        ValueAsMetadata::get(E.first.second),
+                        MDB.createConstant(ConstantInt::get(
+                            Type::getInt64Ty(C), E.second))};
+    Nodes.push_back(MDNode::get(C, Vals));
+  }
+
+  if (NamedMDNode *Flags = M.getModuleFlagsMetadata()) {
+    for (unsigned I = 0, N = Flags->getNumOperands(); I != N; ++I) {
+      MDNode *Flag = Flags->getOperand(I);
+      auto *Key = dyn_cast<MDString>(Flag->getOperand(1));
+      if (!Key || Key->getString() != "CG Profile")
+        continue;
+      auto *Old = cast<MDNode>(Flag->getOperand(2));
+      Nodes.insert(Nodes.begin(), Old->op_begin(), Old->op_end());
+      Metadata *Ops[] = {Flag->getOperand(0), Flag->getOperand(1),
+                         MDNode::get(C, Nodes)};
+      Flags->setOperand(I, MDNode::get(C, Ops));
+      return;
+    }
+  }
+  M.addModuleFlag(Module::Append, "CG Profile", MDNode::get(C, Nodes));
+}
+
+bool MpkCallGraphProfilePass::runOnModule(Module &M) {
+  if (!llvm::shouldHookWithMpkIsolation() || !EnableMpkCGProfile)
+    return false;
+
+  // Profile counts are emitted by CGProfile; adding ours would double them,
+  // since lld sums the weights of repeated edges.
+  ProfileSummaryInfo PSI(M);
+  if (PSI.hasProfileSummary())
+    return false;
+
+  EdgeMap Edges;
+  for (Function &F : M) {
+    if (F.isDeclaration())
+      continue;
+    BlockFrequencyInfo *BFI = nullptr;
+    uint64_t EntryFreq = 0;
+    for (BasicBlock &BB : F) {
+      for (Instruction &I : BB) {
+        auto *CB = dyn_cast<CallBase>(&I);
+        Function *Callee = CB ? CB->getCalledFunction() : nullptr;
+        if (!Callee || Callee == &F || !isIsolationCallee(*Callee))
+          continue;
+        if (!BFI) {
+          BFI = &getAnalysis<BlockFrequencyInfoWrapperPass>(F).getBFI();
+          EntryFreq = std::max<uint64_t>(BFI->getEntryFreq(), 1);
+        }
+        // Static estimate: calls per invocation of the caller, scaled so
+        // that straight-line calls weigh MpkCGProfileScale.
+        APInt Weight(128, BFI->getBlockFreq(&BB).getFrequency());
+        Weight *= MpkCGProfileScale;
+        Weight = Weight.udiv(EntryFreq);
+        uint64_t W = std::max<uint64_t>(Weight.getLimitedValue(UINT64_MAX), 1);
+        uint64_t &Count = Edges[std::make_pair(&F, Callee)];
+        Count = SaturatingAdd(Count, W);
+        if (Callee->getName().startswith("__mpk_unsafe") ||
+            Callee->getName().startswith("__mpk_flagged"))
+          ++NumUnsafeCloneEdges;
+        else
+          ++NumFFIWrapperEdges;
+      }
+    }
+  }
+
+  if (Edges.empty())
+    return false;
+  addModuleFlag(M, Edges);
+  return true;
+}
+
+char MpkCallGraphProfilePass::ID = 0;
+INITIALIZE_PASS_BEGIN(MpkCallGraphProfilePass, "mpk-cg-profile",
+                      "Mpk Isolation call graph profile", false, false)
+INITIALIZE_PASS_DEPENDENCY(BlockFrequencyInfoWrapperPass)
+INITIALIZE_PASS_END(MpkCallGraphProfilePass, "mpk-cg-profile",
+                    "Mpk Isolation call graph profile", false, false)
+ModulePass *llvm::createMpkCallGraphProfilePass() {
+  return new MpkCallGraphProfilePass();
+}
@@ -16,6 +16,7 @@
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Analysis/AssumptionCache.h"
 #include "llvm/Analysis/BranchProbabilityInfo.h"
 #include "llvm/Analysis/InlineCost.h"
@@ -24,6 +25,7 @@
 #include "llvm/Analysis/ScalarEvolutionExpressions.h"
 #include "llvm/Analysis/StackLifetime.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/CodeGen/Passes.h"
 #include "llvm/CodeGen/TargetLowering.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
 #include "llvm/CodeGen/TargetSubtargetInfo.h"
@@ -42,6 +44,7 @@
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/MDBuilder.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Type.h"
@@ -56,6 +59,10 @@
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Transforms/InstCombine/InstCombine.h"
+#include "llvm/Transforms/Scalar.h"
+#include "llvm/Transforms/Scalar/GVN.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 #include "llvm/Transforms/Utils/Local.h"
@@ -68,6 +75,22 @@
 
 using namespace llvm;
 using namespace llvm::safestack;
+
+static cl::opt<bool> EnableMpkIsolationIRStage(
+    "mpk-isolation-ir-stage", cl::init(true), cl::Hidden,
+    cl::desc("Instrument for MPK isolation at the end of the PassManagerBuilder "
+             "pipelines, followed by a cleanup, instead of right before "
+             "instruction selection"));
+
+bool llvm::shouldRunMpkIsolationIRStage() {
+  return shouldHookWithMpkIsolation() && EnableMpkIsolationIRStage;
+}
+
+static cl::opt<bool> EnableMpkXRayEvents(
+    "mpk-xray-events", cl::init(false), cl::Hidden,
+    cl::desc("Emit XRay custom event sleds around FFI calls and at unsafe "
+             "heap allocation sites"));
+
 namespace {
 /* Borrowed from SafeStack.cpp */
 /// Rewrite an SCEV expression for a memory access address to an expression that
@@ -95,7 +118,6 @@ public:
 
 class MPKExternStack {
   Function &F;
-  const TargetLoweringBase &TL;
   const DataLayout &DL;
   ScalarEvolution &SE;
 
@@ -110,9 +132,8 @@ class MPKExternStack {
   uint64_t getStaticAllocaAllocationSize(AllocaInst *AI);
 
 public:
-  MPKExternStack(Function &F, const TargetLoweringBase &TL,
-                 const DataLayout &DL, ScalarEvolution &SE)
-      : F(F), TL(TL), DL(DL), SE(SE),
+  MPKExternStack(Function &F, const DataLayout &DL, ScalarEvolution &SE)
+      : F(F), DL(DL), SE(SE),
         StackPtrTy(Type::getInt8PtrTy(F.getContext())),
         IntPtrTy(DL.getIntPtrType(F.getContext())),
         Int32Ty(Type::getInt32Ty(F.getContext())),
@@ -388,12 +409,16 @@ public:
     domain = nullptr;
   }
 
+  // No TargetPassConfig dependency: the pass runs in the optimization pipeline.
   void getAnalysisUsage(AnalysisUsage &AU) const override {
-    AU.addRequired<TargetPassConfig>();
     AU.addRequired<TargetLibraryInfoWrapperPass>();
     AU.addRequired<AssumptionCacheTracker>();
   }
 
+  bool doInitialization(Module &) override {
+    XRayPayloads.clear();
+    return false;
+  }
   bool runOnFunction(Function &) override;
 
 private:
@@ -403,13 +428,17 @@ private:
   void applyFalsePositiveCheck(Instruction *);
   void applyFalseNegativeCheck(Instruction *);
   void insertExternStackCall();
+  void emitXRayEvent(IRBuilder<> &, Value *, unsigned);
+  void emitXRayGateEvents(CallInst *);
+  void emitXRayAllocEvent(CallInst *);
+  Constant *getXRayGatePayload(char, StringRef, unsigned &);
   Function *createFunction(std::string, FunctionType *, Module *);
+  StringMap<Constant *> XRayPayloads;
   MpkDomain *domain;
   Instruction *currCallSite;
   DataLayout *dataLayout;
   Function *currFunction;
   MPKExternStack *externStack;
-  TargetMachine *TM = nullptr;
 };
 
 void MpkIsolationGatesPass::applyFalseNegativeCheck(Instruction *inst) {
@@ -484,6 +513,78 @@ void MpkIsolationGatesPass::applySFICast(StoreInst *store) {
   store->setOperand(1, bitCast);
 }
 
+void MpkIsolationGatesPass::emitXRayEvent(IRBuilder<> &IRB, Value *Payload,
+                                          unsigned Size) {
+  Function *EventFn = Intrinsic::getDeclaration(currFunction->getParent(),
+                                                Intrinsic::xray_customevent);
+  IRB.CreateCall(EventFn,
+                 {IRB.CreateBitCast(Payload, IRB.getInt8PtrTy()),
+                  IRB.getInt32(Size)});
+}
+
+/// Gate payloads are the kind byte followed by the callee name; they are
+/// constant, so one private string per kind and callee is shared by the
+/// whole module.
+Constant *MpkIsolationGatesPass::getXRayGatePayload(char Kind,
+                                                    StringRef Callee,
+                                                    unsigned &Size) {
+  std::string Payload = std::string(1, Kind) + Callee.str();
+  Size = Payload.size();
+  Constant *&Str = XRayPayloads[Payload];
+  if (!Str) {
+    LLVMContext &C = currFunction->getContext();
+    Str = ConstantDataArray::getString(C, Payload, /*AddNull=*/false);
+    auto *GV = new GlobalVariable(*currFunction->getParent(), Str->getType(),
+                                  true, GlobalValue::PrivateLinkage, Str,
+                                  "mpk.xray.event");
+    GV->setUnnamedAddr(GlobalValue::UnnamedAddr::Global);
+    Str = ConstantExpr::getBitCast(GV, Type::getInt8PtrTy(C));
+  }
+  return Str;
+}
+
+/// Bracket an FFI call with enter/exit events. The sleds stay nops until the
+/// XRay runtime patches them, so the unpatched cost is a few bytes of code.
+void MpkIsolationGatesPass::emitXRayGateEvents(CallInst *CI) {
+  Function *Callee = CI->getCalledFunction();
+  StringRef Name = Callee ? Callee->getName() : "<indirect>";
+  unsigned Size;
+
+  IRBuilder<> IRB(CI);
+  emitXRayEvent(IRB, getXRayGatePayload(MPK_XRAY_GATE_ENTER, Name, Size), Size);
+  IRB.SetInsertPoint(CI->getNextNode());
+  emitXRayEvent(IRB, getXRayGatePayload(MPK_XRAY_GATE_EXIT, Name, Size), Size);
+}
+
+/// Unsafe allocations record the kind byte, the requested size (u64, little
+/// endian) and the allocator's flag in a packed stack buffer. A zero flag
+/// makes __mpk_unsafe__rust_alloc allocate from the safe heap, so call sites
+/// passing a constant zero get no event.
+void MpkIsolationGatesPass::emitXRayAllocEvent(CallInst *CI) {
+  Value *Flag = CI->getArgOperand(2);
+  if (auto *FlagC = dyn_cast<ConstantInt>(Flag))
+    if (FlagC->isZero())
+      return;
+
+  LLVMContext &C = CI->getContext();
+  Type *Int64Ty = Type::getInt64Ty(C);
+  Type *Int8Ty = Type::getInt8Ty(C);
+  StructType *RecordTy =
+      StructType::get(C, {Int8Ty, Int64Ty, Int8Ty}, /*isPacked=*/true);
+
+  IRBuilder<> IRB(&*currFunction->getEntryBlock().getFirstInsertionPt());
+  AllocaInst *Record = IRB.CreateAlloca(RecordTy, nullptr, "mpk.xray.alloc");
+
+  IRB.SetInsertPoint(CI->getNextNode());
+  IRB.CreateStore(IRB.getInt8(MPK_XRAY_UNSAFE_ALLOC),
+                  IRB.CreateStructGEP(RecordTy, Record, 0));
+  IRB.CreateStore(IRB.CreateZExtOrTrunc(CI->getArgOperand(0), Int64Ty),
+                  IRB.CreateStructGEP(RecordTy, Record, 1));
+  IRB.CreateStore(IRB.CreateZExtOrTrunc(Flag, Int8Ty),
+                  IRB.CreateStructGEP(RecordTy, Record, 2));
+  emitXRayEvent(IRB, Record, 1 + sizeof(uint64_t) + 1);
+}
+
 Function *MpkIsolationGatesPass::createFunction(std::string name,
                                                 FunctionType *type, Module *M) {
   FunctionCallee callee = M->getOrInsertFunction(name, type);
@@ -497,11 +598,9 @@ bool MpkIsolationGatesPass::runOnFunction(Function &F) {
   currFunction = &F;
   auto &currContext = F.getContext();
   Module *currModule = F.getParent();
+  F.addMetadata(MPK_ISOLATED_MD_NAME,
+                *MDNode::get(currContext, MDString::get(currContext, "TRUE")));
   dataLayout = new DataLayout(currModule);
-  TM = &getAnalysis<TargetPassConfig>().getTM<TargetMachine>();
-  auto *TL = TM->getSubtargetImpl(F)->getTargetLowering();
-  if (!TL)
-    report_fatal_error("TargetLowering instance is required");
 
   auto *DL = &F.getParent()->getDataLayout();
   auto &TLI = getAnalysis<TargetLibraryInfoWrapperPass>().getTLI(F);
@@ -511,7 +610,7 @@ bool MpkIsolationGatesPass::runOnFunction(Function &F) {
   DominatorTree DT(F);
   LoopInfo LI(DT);
   ScalarEvolution SE(F, TLI, ACT, DT, LI);
-  externStack = new MPKExternStack(F, *TL, *DL, SE);
+  externStack = new MPKExternStack(F, *DL, SE);
 
   if (!domain) {
     // initialize domain
@@ -533,6 +632,8 @@ bool MpkIsolationGatesPass::runOnFunction(Function &F) {
   SmallVector<Instruction *, 8> StackRestorePoints;
   SmallVector<ReturnInst *, 4> Returns;
   SmallVector<Instruction *, 8> ExternCalls;
+  SmallVector<CallInst *, 8> XRayGateSites;
+  SmallVector<CallInst *, 4> XRayAllocSites;
   bool foundMovable = false;
   if (F.getName() == "main") {
     auto II = F.begin()->begin();
@@ -570,6 +671,9 @@ bool MpkIsolationGatesPass::runOnFunction(Function &F) {
         if (CI->getCalledFunction() && CI->canReturnTwice()) {
           StackRestorePoints.push_back(CI);
         }
+        if (EnableMpkXRayEvents && CI->getCalledFunction() &&
+            CI->getCalledFunction()->getName() == MPK_UNSAFE_ALLOC_FUNC_NAME)
+          XRayAllocSites.push_back(CI);
       } else if (auto LP = dyn_cast<LandingPadInst>(currInst)) {
         StackRestorePoints.push_back(LP);
       } else if (auto allocaInst = dyn_cast<AllocaInst>(currInst)) {
@@ -617,10 +721,21 @@ bool MpkIsolationGatesPass::runOnFunction(Function &F) {
         MDNode *NN =
             MDNode::get(currContext, MDString::get(currContext, "TRUE"));
         F.addMetadata("HAS_EXTERN_CALLS", *NN);
+        // Invokes are left out: their exit event would have to go to a
+        // normal destination that may be shared with other edges.
+        auto CI = dyn_cast<CallInst>(currInst);
+        if (EnableMpkXRayEvents && CI && !CI->isMustTailCall())
+          XRayGateSites.push_back(CI);
       }
     }
   }
 
+  // Emitted after the walk so the event calls are not visited themselves.
+  for (CallInst *CI : XRayGateSites)
+    emitXRayGateEvents(CI);
+  for (CallInst *CI : XRayAllocSites)
+    emitXRayAllocEvent(CI);
+
   if(totalAllocas > 0){
     Instruction* beginInst = &(*(F.begin()->begin()));
     IRBuilder<> IRB(beginInst);
@@ -631,7 +746,8 @@ bool MpkIsolationGatesPass::runOnFunction(Function &F) {
     externStack->run(StaticArrayAllocas, DynamicArrayAllocas,
                      StackRestorePoints, Returns);
   }
-  return !ExternCalls.empty() || foundMovable;
+  return !ExternCalls.empty() || foundMovable || !XRayGateSites.empty() ||
+         !XRayAllocSites.empty();
 }
 
 char MpkIsolationGatesPass::ID = 0;
@@ -642,3 +758,108 @@ INITIALIZE_PASS_END(MpkIsolationGatesPass, "mpk-isolation-gates",
 FunctionPass *llvm::createMpkIsolationGatesPass() {
   return new MpkIsolationGatesPass();
 }
+
+namespace {
+/// Right before instruction selection, tag the FFI calls for X86 LowerCall
+/// from the MPKExtern attribute, the same test the X86 gate pass uses. The
+/// codegen IR passes between the IR stage and here may create, merge or strip
+/// the metadata of calls. A function with FFI calls that the IR stage never
+/// saw (e.g. a pipeline built without PassManagerBuilder) would go out without
+/// its extern stack moves and masks, so that is a fatal error.
+class MpkTagFFICallsPass : public FunctionPass {
+public:
+  static char ID;
+  MpkTagFFICallsPass() : FunctionPass(ID) {
+    initializeMpkTagFFICallsPassPass(*PassRegistry::getPassRegistry());
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.setPreservesCFG();
+  }
+
+  bool runOnFunction(Function &F) override;
+};
+} // namespace
+
+bool MpkTagFFICallsPass::runOnFunction(Function &F) {
+  // main only sets up R15 and never gets its FFI calls tagged.
+  if (!llvm::shouldHookWithMpkIsolation() || F.isDeclaration() ||
+      F.getName() == "main")
+    return false;
+
+  LLVMContext &C = F.getContext();
+  bool hasExternCalls = false;
+  bool changed = false;
+  for (auto &BB : F) {
+    for (auto &I : BB) {
+      auto *CB = dyn_cast<CallBase>(&I);
+      if (!CB)
+        continue;
+      if (MpkDomain::shouldInstrumentInstruction(CB)) {
+        hasExternCalls = true;
+        if (!CB->getMetadata("ADD-FFI-WRAPPER")) {
+          CB->setMetadata("ADD-FFI-WRAPPER",
+                          MDNode::get(C, MDString::get(C, "wrap-ffi-call")));
+          changed = true;
+        }
+      } else if (CB->getMetadata("ADD-FFI-WRAPPER")) {
+        CB->setMetadata("ADD-FFI-WRAPPER", nullptr);
+        changed = true;
+      }
+    }
+  }
+  if (!hasExternCalls)
+    return changed;
+  if (!F.hasMetadata(MPK_ISOLATED_MD_NAME))
+    report_fatal_error("MPK isolation: " + F.getName() +
+                       " was not instrumented; run the IR stage through "
+                       "PassManagerBuilder or pass -mpk-isolation-ir-stage=0");
+  if (!F.hasMetadata("HAS_EXTERN_CALLS")) {
+    F.addMetadata("HAS_EXTERN_CALLS",
+                  *MDNode::get(C, MDString::get(C, "TRUE")));
+    changed = true;
+  }
+  return changed;
+}
+
+char MpkTagFFICallsPass::ID = 0;
+INITIALIZE_PASS(MpkTagFFICallsPass, "mpk-tag-ffi-calls",
+                "Mpk Isolation FFI call tagging", false, false)
+FunctionPass *llvm::createMpkTagFFICallsPass() {
+  return new MpkTagFFICallsPass();
+}
+
+/// The IR stage: the isolation instrumentation (extern stack moves, SFI
+/// masks, FFI call tags) once inlining is over, followed by a cleanup that
+/// CSEs the R15 reads, extern stack pointer loads and masks it adds and
+/// hoists them out of loops. SFI for C dependencies runs earlier, before the
+/// LTO inliner (see MpkSfiCDeps.cpp). Pre-link LTO modules are
+/// left alone; they are instrumented by the post-link pipeline. Only the
+/// legacy pass manager's PassManagerBuilder pipelines reach these extension
+/// points.
+static void addMpkIsolationStage(const PassManagerBuilder &Builder,
+                                 legacy::PassManagerBase &PM) {
+  if (!llvm::shouldRunMpkIsolationIRStage() || Builder.PrepareForLTO ||
+      Builder.PrepareForThinLTO)
+    return;
+
+  PM.add(createMpkIsolationGatesPass());
+  if (Builder.OptLevel == 0)
+    return;
+  PM.add(createEarlyCSEPass(true /* Enable mem-ssa. */));
+  if (Builder.OptLevel > 1)
+    PM.add(createGVNPass());
+  PM.add(createLICMPass());
+  PM.add(createInstructionCombiningPass());
+  PM.add(createCFGSimplificationPass());
+}
+
+static RegisterStandardPasses
+    MpkIsolationStage(PassManagerBuilder::EP_OptimizerLast,
+                      addMpkIsolationStage);
+static RegisterStandardPasses
+    MpkIsolationStageO0(PassManagerBuilder::EP_EnabledOnOptLevel0,
+                        addMpkIsolationStage);
+static RegisterStandardPasses
+    MpkIsolationStageLTO(PassManagerBuilder::EP_FullLinkTimeOptimizationLast,
+                         addMpkIsolationStage);
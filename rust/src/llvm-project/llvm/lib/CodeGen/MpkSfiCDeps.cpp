@@ -0,0 +1,523 @@
+/* Part of the MPK Isolation interface for Rust,
+ * Confines C dependencies linked in through cross-language LTO with SFI
+ * instead of MPK gates: every memory access of the C code is masked into the
+ * unsafe window, its escaping stack objects are moved to the extern stack,
+ * and only its calls leaving the LTO unit keep an MPK gate. Calls from Rust
+ * into the C code then become ordinary calls without WRPKRU.
+ */
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Analysis/ValueTracking.h"
+#include "llvm/BinaryFormat/Dwarf.h"
+#include "llvm/CodeGen/Passes.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DebugInfoMetadata.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/InitializePasses.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/IPO/PassManagerBuilder.h"
+#include "llvm/Transforms/MpkIsolation.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include <atomic>
+
+#define DEBUG_TYPE "mpk-sfi-c-deps"
+
+using namespace llvm;
+
+STATISTIC(NumSandboxedFuncs, "Number of C functions confined with SFI");
+STATISTIC(NumMaskedAccesses, "Number of masked memory accesses");
+STATISTIC(NumMovedAllocas, "Number of C allocas moved to the extern stack");
+STATISTIC(NumGatedCalls, "Number of C calls leaving the LTO unit");
+STATISTIC(NumClampedAccesses, "Number of accesses kept inside a global");
+STATISTIC(NumGatedIndirectCalls, "Number of gated indirect C calls");
+STATISTIC(NumTrappedIndirectCalls,
+          "Number of indirect C calls trapping outside the LTO unit");
+STATISTIC(NumLocalTargets,
+          "Number of address-taken functions placed in the local section");
+
+/// Section of the address-taken functions defined in the LTO unit; the linker
+/// defines __start_/__stop_ symbols around it.
+static const char *const LocalTextSection = "mpk_sfi_text";
+
+static cl::opt<bool> EnableMpkSfiCDeps(
+    "mpk-sfi-c-deps", cl::init(false), cl::Hidden,
+    cl::desc("Confine C dependencies linked through LTO with SFI instead of "
+             "gating every FFI call into them"));
+
+namespace {
+
+class MpkSfiCDepsPass : public ModulePass {
+public:
+  static char ID;
+  MpkSfiCDepsPass() : ModulePass(ID) {
+    initializeMpkSfiCDepsPassPass(*PassRegistry::getPassRegistry());
+  }
+
+  bool runOnModule(Module &M) override;
+
+  StringRef getPassName() const override { return "MPK SFI C Dependencies"; }
+
+private:
+  bool isRustFunction(const Function &F) const;
+  void collectCFunctions(Module &M);
+  bool isContainedAlloca(const AllocaInst *AI) const;
+  bool isExemptPointer(const Value *Ptr) const;
+  Value *maskPointer(IRBuilder<> &IRB, Value *Ptr);
+  Value *confinePointer(IRBuilder<> &IRB, Value *Ptr, Value *&End);
+  void confineMemIntrinsic(MemIntrinsic *MI);
+  void placeLocalTargets(Module &M);
+  void gateIndirectCall(CallInst *CI);
+  void confineFunction(Function &F);
+  void dropExternMarkers(Module &M);
+
+  SetVector<Function *> CFunctions;
+  bool HasLocalTargets = false;
+  const DataLayout *DL = nullptr;
+  Type *IntPtrTy = nullptr;
+};
+
+} // namespace
+
+/// Legacy Rust symbols end in a 16 hex digit hash (_ZN...17h<hash>E), v0
+/// symbols start with _R. C++ symbols carry no such hash.
+static bool isRustSymbol(StringRef Name) {
+  if (Name.startswith("_R"))
+    return true;
+  return Name.startswith("_ZN") && Name.size() > 23 && Name.endswith("E") &&
+         Name.drop_back(17).endswith("17h");
+}
+
+/// Rust code carries Rust debug info, the Rust personality or a Rust symbol;
+/// everything else reached from an FFI call is C. The IR stage marks every
+/// function it instruments, C included, so its marker does not tell them apart.
+bool MpkSfiCDepsPass::isRustFunction(const Function &F) const {
+  if (const DISubprogram *SP = F.getSubprogram())
+    return SP->getUnit()->getSourceLanguage() == dwarf::DW_LANG_Rust;
+  if (F.hasPersonalityFn() &&
+      F.getPersonalityFn()->stripPointerCasts()->getName() ==
+          "rust_eh_personality")
+    return true;
+  return isRustSymbol(F.getName());
+}
+
+/// Calls whose result points into libc's own memory: errno, the ctype
+/// tables, the environment and static result buffers.
+static bool isLibcObjectFunction(StringRef Name) {
+  return StringSwitch<bool>(Name)
+      .Cases("__errno_location", "__h_errno_location", "__ctype_b_loc",
+             "__ctype_tolower_loc", "__ctype_toupper_loc", true)
+      .Cases("getenv", "secure_getenv", "setlocale", "localeconv",
+             "nl_langinfo", true)
+      .Cases("localtime", "gmtime", "ctime", "asctime", "strerror", true)
+      .Default(false);
+}
+
+/// Globals libc exports to programs.
+static bool isLibcGlobal(StringRef Name) {
+  return StringSwitch<bool>(Name)
+      .Cases("stdin", "stdout", "stderr", "environ", "__environ", true)
+      .Cases("optarg", "optind", "opterr", "optopt", true)
+      .Cases("timezone", "daylight", "tzname", "program_invocation_name",
+             "program_invocation_short_name", true)
+      .Default(false);
+}
+
+/// Result of a libc call handing out libc's own memory, e.g. errno's
+/// __errno_location(), getenv() or localtime(). Any other call, strchr() or
+/// memcpy() included, may return a pointer derived from its arguments.
+static bool isExternalObject(const Value *V) {
+  auto *CB = dyn_cast<CallBase>(V);
+  if (!CB)
+    return false;
+  const Function *Callee = CB->getCalledFunction();
+  return Callee && Callee->isDeclaration() && !Callee->isIntrinsic() &&
+         isLibcObjectFunction(Callee->getName());
+}
+
+/// The C side of the LTO unit: defined callees of MPKExtern call sites, and
+/// the defined functions they call in turn, stopping at Rust callbacks.
+/// available_externally copies are left alone: the real definition lives in
+/// another module (ThinLTO), so they keep their gate.
+void MpkSfiCDepsPass::collectCFunctions(Module &M) {
+  SmallVector<Function *, 16> Worklist;
+  for (Function &F : M) {
+    if (F.isDeclaration() || !isRustFunction(F))
+      continue;
+    for (Instruction &I : instructions(F)) {
+      auto *CB = dyn_cast<CallBase>(&I);
+      if (!CB || !MpkDomain::shouldInstrumentInstruction(CB))
+        continue;
+      Function *Callee = CB->getCalledFunction();
+      if (Callee && !Callee->isDeclaration() &&
+          !Callee->hasAvailableExternallyLinkage() &&
+          !isRustFunction(*Callee) && CFunctions.insert(Callee))
+        Worklist.push_back(Callee);
+    }
+  }
+
+  while (!Worklist.empty()) {
+    Function *F = Worklist.pop_back_val();
+    for (Instruction &I : instructions(*F)) {
+      auto *CB = dyn_cast<CallBase>(&I);
+      if (!CB)
+        continue;
+      Function *Callee = CB->getCalledFunction();
+      if (Callee && !Callee->isDeclaration() &&
+          !Callee->hasAvailableExternallyLinkage() &&
+          !isRustFunction(*Callee) && CFunctions.insert(Callee))
+        Worklist.push_back(Callee);
+    }
+  }
+}
+
+/// An alloca whose address never escapes and is only accessed at constant
+/// in-bounds offsets cannot be used to reach other memory, so it may stay on
+/// the native stack with unmasked accesses.
+bool MpkSfiCDepsPass::isContainedAlloca(const AllocaInst *AI) const {
+  if (!AI->isStaticAlloca())
+    return false;
+  SmallVector<const Value *, 8> Worklist;
+  Worklist.push_back(AI);
+  while (!Worklist.empty()) {
+    const Value *V = Worklist.pop_back_val();
+    for (const User *U : V->users()) {
+      if (auto *LI = dyn_cast<LoadInst>(U)) {
+        if (LI->getPointerOperand() != V)
+          return false;
+      } else if (auto *SI = dyn_cast<StoreInst>(U)) {
+        if (SI->getPointerOperand() != V || SI->getValueOperand() == V)
+          return false;
+      } else if (auto *BC = dyn_cast<BitCastInst>(U)) {
+        Worklist.push_back(BC);
+      } else if (auto *GEP = dyn_cast<GetElementPtrInst>(U)) {
+        if (!GEP->isInBounds() || !GEP->hasAllConstantIndices())
+          return false;
+        Worklist.push_back(GEP);
+      } else if (auto *II = dyn_cast<IntrinsicInst>(U)) {
+        if (!II->isLifetimeStartOrEnd() && !isa<DbgInfoIntrinsic>(II))
+          return false;
+      } else {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+/// Accesses at constant in-bounds offsets into contained allocas, the
+/// module's own globals and thread-locals, and libc's own objects (stdout,
+/// errno, ...) need no mask, which would send them into the unsafe window
+/// instead. Heap memory needs none either way: malloc and friends are called
+/// through a gate and return unsafe memory.
+bool MpkSfiCDepsPass::isExemptPointer(const Value *Ptr) const {
+  const Value *Base = Ptr->stripInBoundsConstantOffsets();
+  if (auto *AI = dyn_cast<AllocaInst>(Base))
+    return !AI->hasMetadata("MPK-Extern-Move");
+  if (auto *GV = dyn_cast<GlobalVariable>(Base))
+    return !GV->isDeclaration() || isLibcGlobal(GV->getName());
+  return isExternalObject(Base);
+}
+
+/// ptr' = (ptr & (len - 1)) | start, which keeps every access inside the
+/// unsafe window set up by mpk-library.
+Value *MpkSfiCDepsPass::maskPointer(IRBuilder<> &IRB, Value *Ptr) {
+  Value *Addr = IRB.CreatePtrToInt(Ptr, IntPtrTy);
+  Addr = IRB.CreateAnd(Addr, ConstantInt::get(IntPtrTy, MPK_UNSAFE_REGION_MASK));
+  Addr = IRB.CreateOr(Addr, ConstantInt::get(IntPtrTy, MPK_UNSAFE_START_ADDR));
+  ++NumMaskedAccesses;
+  return IRB.CreateIntToPtr(Addr, Ptr->getType(), "mpk.sfi");
+}
+
+/// Confine an access pointer and set End to the end of the memory it is
+/// confined to (nullptr if unbounded). Accesses at variable offsets into the
+/// module's own globals are kept inside the global, falling back to its start.
+/// libc's globals and the objects it hands out have no known size and are
+/// trusted like libc itself. Everything else, other external globals included,
+/// is masked into the unsafe window.
+Value *MpkSfiCDepsPass::confinePointer(IRBuilder<> &IRB, Value *Ptr,
+                                       Value *&End) {
+  End = nullptr;
+  if (isExemptPointer(Ptr))
+    return Ptr;
+
+  const Value *Base = GetUnderlyingObject(Ptr, *DL);
+  auto *GV = dyn_cast<GlobalVariable>(Base);
+  if (GV && GV->isDeclaration() && isLibcGlobal(GV->getName()))
+    return Ptr;
+  if (GV && !GV->isDeclaration() && GV->getValueType()->isSized()) {
+    auto *G = const_cast<GlobalVariable *>(GV);
+    Value *Size = ConstantInt::get(IntPtrTy,
+                                   DL->getTypeAllocSize(GV->getValueType()));
+    Value *Start = IRB.CreatePtrToInt(G, IntPtrTy);
+    Value *Offset = IRB.CreateSub(IRB.CreatePtrToInt(Ptr, IntPtrTy), Start);
+    End = IRB.CreateAdd(Start, Size);
+    ++NumClampedAccesses;
+    return IRB.CreateSelect(IRB.CreateICmpULT(Offset, Size), Ptr,
+                            IRB.CreatePointerCast(G, Ptr->getType()),
+                            "mpk.sfi");
+  }
+  if (isExternalObject(Base))
+    return Ptr;
+
+  End = ConstantInt::get(IntPtrTy,
+                         MPK_UNSAFE_START_ADDR + MPK_UNSAFE_REGION_MASK + 1);
+  return maskPointer(IRB, Ptr);
+}
+
+/// Confine the pointers of a mem intrinsic and clamp its length so it ends
+/// inside the memory each pointer was confined to.
+void MpkSfiCDepsPass::confineMemIntrinsic(MemIntrinsic *MI) {
+  IRBuilder<> IRB(MI);
+  Value *Len = MI->getLength();
+  Value *Clamped = IRB.CreateZExtOrTrunc(Len, IntPtrTy);
+  bool WasClamped = false;
+
+  auto confine = [&](unsigned OpIdx) {
+    Value *End = nullptr;
+    Value *Ptr = confinePointer(IRB, MI->getArgOperand(OpIdx), End);
+    MI->setArgOperand(OpIdx, Ptr);
+    if (!End)
+      return;
+    Value *Room = IRB.CreateSub(End, IRB.CreatePtrToInt(Ptr, IntPtrTy));
+    Clamped = IRB.CreateSelect(IRB.CreateICmpULT(Clamped, Room), Clamped, Room);
+    WasClamped = true;
+  };
+  confine(0);
+  if (isa<MemTransferInst>(MI))
+    confine(1);
+
+  if (WasClamped)
+    MI->setLength(IRB.CreateZExtOrTrunc(Clamped, Len->getType()));
+}
+
+/// No byval or inalloca argument, and every argument in a register.
+static bool passesArgumentsInRegisters(const CallBase *CB,
+                                       const DataLayout &DL) {
+  SmallVector<Type *, 8> ArgTys;
+  for (unsigned I = 0, E = CB->arg_size(); I != E; ++I) {
+    if (CB->isByValArgument(I) || CB->paramHasAttr(I, Attribute::InAlloca))
+      return false;
+    ArgTys.push_back(CB->getArgOperand(I)->getType());
+  }
+  return MpkDomain::passesArgumentsInRegisters(ArgTys, DL);
+}
+
+/// Address-taken functions defined in the LTO unit (Rust callbacks and the
+/// confined C code) go to their own section, so an indirect call tells them
+/// from everything else with one range check. A range over the whole text
+/// would also cover the PLT of a non-PIE executable, and with it libc.
+/// Functions that already have a section stay out and are gated.
+void MpkSfiCDepsPass::placeLocalTargets(Module &M) {
+  for (Function &F : M) {
+    if (F.isDeclaration() || F.hasAvailableExternallyLinkage() ||
+        F.hasSection() || !F.hasAddressTaken())
+      continue;
+    F.setSection(LocalTextSection);
+    HasLocalTargets = true;
+    ++NumLocalTargets;
+  }
+}
+
+/// An indirect call may reach a function outside the LTO unit (e.g. libc
+/// through a function pointer), which needs a gate like a direct call to a
+/// declaration. Targets in the local section are called directly; every other
+/// target is called through __mpk_ffi_gate, which takes its callee from the
+/// domain block (R15 + 56). The gate cannot move stack arguments to the
+/// extern stack, so such calls trap on a target outside the section instead.
+void MpkSfiCDepsPass::gateIndirectCall(CallInst *CI) {
+  Module *M = CI->getModule();
+  LLVMContext &C = M->getContext();
+  Type *Int8Ty = Type::getInt8Ty(C);
+  IRBuilder<> IRB(CI);
+
+  Value *Callee = CI->getCalledOperand();
+  Value *Target = IRB.CreatePtrToInt(Callee, IntPtrTy);
+  Value *InText = IRB.getFalse();
+  if (HasLocalTargets) {
+    std::string Name = LocalTextSection;
+    Value *TextStart = IRB.CreatePtrToInt(
+        M->getOrInsertGlobal("__start_" + Name, Int8Ty), IntPtrTy);
+    Value *TextEnd = IRB.CreatePtrToInt(
+        M->getOrInsertGlobal("__stop_" + Name, Int8Ty), IntPtrTy);
+    InText = IRB.CreateAnd(IRB.CreateICmpUGE(Target, TextStart),
+                           IRB.CreateICmpULT(Target, TextEnd));
+  }
+
+  if (!passesArgumentsInRegisters(CI, *DL)) {
+    Instruction *Trap =
+        SplitBlockAndInsertIfThen(IRB.CreateNot(InText), CI, true);
+    IRBuilder<> TrapIRB(Trap);
+    TrapIRB.CreateCall(M->getOrInsertFunction(SFI_EXCEPTION_FUNC_NAME,
+                                              Type::getVoidTy(C)));
+    ++NumTrappedIndirectCalls;
+    return;
+  }
+
+  MDNode *R15 = MDNode::get(C, {MDString::get(C, "r15")});
+  Function *ReadRegister =
+      Intrinsic::getDeclaration(M, Intrinsic::read_register, {IntPtrTy});
+  Value *Domain =
+      IRB.CreateCall(ReadRegister, {MetadataAsValue::get(C, R15)});
+  Value *Slot = IRB.CreateIntToPtr(
+      IRB.CreateAdd(Domain, ConstantInt::get(IntPtrTy, 56)),
+      IntPtrTy->getPointerTo());
+  IRB.CreateStore(Target, Slot);
+
+  FunctionCallee Gate = M->getOrInsertFunction(
+      MPK_FFI_GATE_FUNC_NAME, FunctionType::get(Type::getVoidTy(C), false));
+  CI->setCalledOperand(IRB.CreateSelect(
+      InText, Callee,
+      IRB.CreatePointerCast(Gate.getCallee(), Callee->getType())));
+  ++NumGatedIndirectCalls;
+}
+
+void MpkSfiCDepsPass::confineFunction(Function &F) {
+  LLVMContext &C = F.getContext();
+  MDNode *MoveMD = MDNode::get(C, MDString::get(C, "TRUE"));
+
+  // Move escaping stack objects first so their accesses go through the
+  // extern stack, which lives inside the unsafe window.
+  for (Instruction &I : instructions(F)) {
+    auto *AI = dyn_cast<AllocaInst>(&I);
+    if (AI && !AI->hasMetadata("MPK-Extern-Move") && !isContainedAlloca(AI)) {
+      AI->setMetadata("MPK-Extern-Move", MoveMD);
+      ++NumMovedAllocas;
+    }
+  }
+
+  SmallVector<Instruction *, 32> Accesses;
+  SmallVector<MemIntrinsic *, 8> MemIntrinsics;
+  SmallVector<CallInst *, 8> IndirectCalls;
+  for (Instruction &I : instructions(F)) {
+    if (auto *MI = dyn_cast<MemIntrinsic>(&I)) {
+      MemIntrinsics.push_back(MI);
+      continue;
+    }
+    if (isa<LoadInst>(I) || isa<StoreInst>(I) || isa<AtomicRMWInst>(I) ||
+        isa<AtomicCmpXchgInst>(I)) {
+      Accesses.push_back(&I);
+      continue;
+    }
+    // Calls leaving the LTO unit still cross into the unsafe domain through
+    // a gate, exactly like FFI calls from Rust.
+    auto *CB = dyn_cast<CallBase>(&I);
+    if (!CB || CB->isInlineAsm() || isa<IntrinsicInst>(CB))
+      continue;
+    Function *Callee = CB->getCalledFunction();
+    if (!Callee) {
+      // Invokes are left out: C code has no unwinding through them.
+      if (auto *CI = dyn_cast<CallInst>(CB))
+        IndirectCalls.push_back(CI);
+    } else if (Callee->isDeclaration() &&
+               !CB->hasFnAttr(Attribute::MPKExtern)) {
+      CB->addAttribute(AttributeList::FunctionIndex, Attribute::MPKExtern);
+      ++NumGatedCalls;
+    } else if (!Callee->isDeclaration() && isRustFunction(*Callee)) {
+      // The LTO inliner runs after this pass; a Rust callback inlined here
+      // would run under the C code's masks.
+      CB->setIsNoInline();
+    }
+  }
+
+  for (Instruction *I : Accesses) {
+    IRBuilder<> IRB(I);
+    auto confine = [&](unsigned OpIdx) {
+      Value *End = nullptr;
+      I->setOperand(OpIdx, confinePointer(IRB, I->getOperand(OpIdx), End));
+    };
+    if (isa<LoadInst>(I))
+      confine(LoadInst::getPointerOperandIndex());
+    else if (isa<StoreInst>(I))
+      confine(StoreInst::getPointerOperandIndex());
+    else if (isa<AtomicRMWInst>(I))
+      confine(AtomicRMWInst::getPointerOperandIndex());
+    else
+      confine(AtomicCmpXchgInst::getPointerOperandIndex());
+  }
+  for (MemIntrinsic *MI : MemIntrinsics)
+    confineMemIntrinsic(MI);
+  for (CallInst *CI : IndirectCalls)
+    gateIndirectCall(CI);
+}
+
+/// Calls from Rust into the confined C code must not be gated: drop MPKExtern
+/// from the C functions and from the call sites reaching them, so the X86
+/// gate pass and the FFI call tagging both see plain calls.
+void MpkSfiCDepsPass::dropExternMarkers(Module &M) {
+  for (Function *F : CFunctions)
+    F->removeFnAttr(Attribute::MPKExtern);
+  for (Function &F : M) {
+    for (Instruction &I : instructions(F)) {
+      auto *CB = dyn_cast<CallBase>(&I);
+      if (CB && CB->getCalledFunction() &&
+          CFunctions.count(CB->getCalledFunction()))
+        CB->removeAttribute(AttributeList::FunctionIndex,
+                            Attribute::MPKExtern);
+    }
+  }
+}
+
+bool MpkSfiCDepsPass::runOnModule(Module &M) {
+  if (!llvm::shouldHookWithMpkIsolation() || !EnableMpkSfiCDeps)
+    return false;
+
+  DL = &M.getDataLayout();
+  IntPtrTy = DL->getIntPtrType(M.getContext());
+  CFunctions.clear();
+  HasLocalTargets = false;
+  collectCFunctions(M);
+  if (!CFunctions.empty())
+    placeLocalTargets(M);
+
+  for (Function *F : CFunctions) {
+    confineFunction(*F);
+    ++NumSandboxedFuncs;
+  }
+  dropExternMarkers(M);
+  return !CFunctions.empty();
+}
+
+char MpkSfiCDepsPass::ID = 0;
+INITIALIZE_PASS_BEGIN(MpkSfiCDepsPass, "mpk-sfi-c-deps",
+                      "Mpk Isolation SFI for C dependencies", false, false)
+INITIALIZE_PASS_END(MpkSfiCDepsPass, "mpk-sfi-c-deps",
+                    "Mpk Isolation SFI for C dependencies", false, false)
+ModulePass *llvm::createMpkSfiCDepsPass() { return new MpkSfiCDepsPass(); }
+
+/// The C code is confined before the LTO inliner, so C bodies inlined into
+/// Rust carry their masks and gates along.
+static void addMpkSfiCDepsPass(const PassManagerBuilder &Builder,
+                               legacy::PassManagerBase &PM) {
+  if (llvm::shouldHookWithMpkIsolation() && EnableMpkSfiCDeps)
+    PM.add(createMpkSfiCDepsPass());
+}
+
+/// ThinLTO backends never see the C definitions next to the Rust callers (at
+/// most available_externally copies), so the SFI mode needs full LTO.
+static void warnMpkSfiCDepsThinLTO(const PassManagerBuilder &Builder,
+                                   legacy::PassManagerBase &PM) {
+  static std::atomic<bool> Warned(false);
+  if (!Builder.PerformThinLTO || !llvm::shouldHookWithMpkIsolation() ||
+      !EnableMpkSfiCDeps || Warned.exchange(true))
+    return;
+  errs() << "warning: -mpk-sfi-c-deps needs full LTO and is ignored by "
+            "ThinLTO; calls into C dependencies keep their MPK gates\n";
+}
+
+static RegisterStandardPasses
+    MpkSfiCDeps(PassManagerBuilder::EP_FullLinkTimeOptimizationEarly,
+                addMpkSfiCDepsPass);
+static RegisterStandardPasses
+    MpkSfiCDepsThinLTO(PassManagerBuilder::EP_OptimizerLast,
+                       warnMpkSfiCDepsThinLTO);
@@ -778,7 +778,13 @@ void TargetPassConfig::addISelPrepare() {
   // Add both the safe stack and the stack protection passes: each of them will
   // only protect functions that have corresponding attributes.
   addPass(createSafeStackPass());
-  addPass(createMpkIsolationGatesPass());
+  // The MPK isolation IR stage normally runs at the end of the optimization
+  // pipeline (see MpkIsolation.cpp); only the FFI call tags are refreshed here.
+  if (shouldRunMpkIsolationIRStage())
+    addPass(createMpkTagFFICallsPass());
+  else
+    addPass(createMpkIsolationGatesPass());
+  addPass(createMpkCallGraphProfilePass());
   addPass(createSfiTestPass());
   addPass(createStackProtectorPass());
 
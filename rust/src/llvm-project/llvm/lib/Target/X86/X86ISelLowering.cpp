@@ -83,6 +83,13 @@ static cl::opt<bool> MulConstantOptimization(
              "SHIFT, LEA, etc."),
     cl::Hidden);
 
+/* MPK Isolation */
+static cl::opt<bool> EnableMpkFFITailGate(
+    "mpk-ffi-tail-gate", cl::init(true),
+    cl::desc("Lower FFI calls in tail position as tail calls through the "
+             "shared MPK tail gate instead of forcing a gated call"),
+    cl::Hidden);
+
 static cl::opt<bool> ExperimentalUnorderedISEL(
     "x86-experimental-unordered-atomic-isel", cl::init(false),
     cl::desc("Use LoadSDNode and StoreSDNode instead of "
@@ -3821,6 +3828,24 @@ static SDValue EmitTailCallStoreRetAddr(SelectionDAG &DAG, MachineFunction &MF,
   return Chain;
 }
 
+/// MPK-Isolation: returns true if every outgoing argument of the call is
+/// passed in registers, i.e. nothing has to be materialized on the extern
+/// stack before entering the untrusted domain.
+static bool hasOnlyRegisterArgs(CallingConv::ID CallConv, bool isVarArg,
+                                MachineFunction &MF, LLVMContext &C,
+                                const SmallVectorImpl<ISD::OutputArg> &Outs) {
+  for (const ISD::OutputArg &Out : Outs)
+    if (Out.Flags.isByVal() || Out.Flags.isInAlloca() ||
+        Out.Flags.isPreallocated())
+      return false;
+
+  SmallVector<CCValAssign, 16> ArgLocs;
+  CCState CCInfo(CallConv, isVarArg, MF, ArgLocs, C);
+  CCInfo.AnalyzeArguments(Outs, CC_X86);
+  return llvm::none_of(ArgLocs,
+                       [](const CCValAssign &VA) { return VA.isMemLoc(); });
+}
+
 /// Returns a vector_shuffle mask for an movs{s|d}, movd
 /// operation of specified width.
 static SDValue getMOVL(SelectionDAG &DAG, const SDLoc &dl, MVT VT, SDValue V1,
@@ -3862,14 +3887,16 @@ X86TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
   const auto *II = dyn_cast_or_null<InvokeInst>(CLI.CB);
 
   bool isFFICall = MpkDomain::shouldInstrumentFFICall(CLI.CB);
-  isTailCall = isTailCall && !isFFICall;
-  SDValue ExternStackPtr;
-  if(isFFICall){
-    SDValue Ptr = DAG.getCopyFromReg(Chain,dl,X86::R15,getPointerTy(DAG.getDataLayout()));
-    ExternStackPtr = DAG.getLoad(getPointerTy(DAG.getDataLayout()),dl,Chain,Ptr,MachinePointerInfo());
-    Chain = ExternStackPtr;
-  }
-  
+  /// MPK-Isolation: an FFI call in tail position keeps its tail-call form by
+  /// jumping to __mpk_ffi_tail_gate, which switches PKRU and stack itself and
+  /// returns through a shared stub. The gate cannot forward stack arguments.
+  bool isFFITailGate = isFFICall && isTailCall && EnableMpkFFITailGate &&
+                       Is64Bit && !IsWin64 && !IsGuaranteeTCO &&
+                       !(CLI.CB && CLI.CB->isMustTailCall()) &&
+                       hasOnlyRegisterArgs(CallConv, isVarArg, MF,
+                                           *DAG.getContext(), Outs);
+  isTailCall = isTailCall && (!isFFICall || isFFITailGate);
+
   bool HasNoCfCheck =
       (CI && CI->doesNoCfCheck()) || (II && II->doesNoCfCheck());
   const Module *M = MF.getMMI().getModule();
@@ -3912,6 +3939,7 @@ X86TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
     if (isTailCall)
       ++NumTailCalls;
   }
+  isFFITailGate = isFFITailGate && isTailCall;
 
   assert(!(isVarArg && canGuaranteeTCO(CallConv)) &&
          "Var args not supported with calling convention fastcc, ghc or hipe");
@@ -3932,6 +3960,23 @@ X86TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
     CCInfo.AnalyzeArgumentsSecondPass(Outs, CC_X86);
   }
 
+  /// MPK-Isolation: the extern stack pointer is only needed to place stack
+  /// or byval arguments. Calls passing everything in registers, such as the
+  /// common fn(ptr, len) -> int, skip the load through R15 entirely.
+  SDValue ExternStackPtr;
+  bool NeedsExternStack =
+      isFFICall && !isFFITailGate &&
+      (llvm::any_of(ArgLocs,
+                    [](const CCValAssign &VA) { return VA.isMemLoc(); }) ||
+       llvm::any_of(Outs, [](const ISD::OutputArg &Out) {
+         return Out.Flags.isByVal();
+       }));
+  if(NeedsExternStack){
+    SDValue Ptr = DAG.getCopyFromReg(Chain,dl,X86::R15,getPointerTy(DAG.getDataLayout()));
+    ExternStackPtr = DAG.getLoad(getPointerTy(DAG.getDataLayout()),dl,Chain,Ptr,MachinePointerInfo());
+    Chain = ExternStackPtr;
+  }
+
   // Get a count of how many bytes are to be pushed on the stack.
   unsigned NumBytes = CCInfo.getAlignedCallFrameSize();
   if (IsSibcall)
@@ -3994,7 +4039,7 @@ X86TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
   if (isTailCall && FPDiff){
     Chain = EmitTailCallLoadRetAddr(DAG, RetAddrFrIdx, Chain, isTailCall,
                                     Is64Bit, FPDiff, dl);
-    if(isFFICall){
+    if(ExternStackPtr.getNode()){
       Chain = DAG.getStore(Chain,dl,RetAddrFrIdx,ExternStackPtr,MachinePointerInfo());
     }
   }
@@ -4103,7 +4148,7 @@ X86TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
     } else if (!IsSibcall && (!isTailCall || isByVal)) {
       assert(VA.isMemLoc());
       if (!StackPtr.getNode()){
-        if(isFFICall){
+        if(ExternStackPtr.getNode()){
           StackPtr = ExternStackPtr;
           
         }else
@@ -4118,6 +4163,18 @@ X86TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
   if (!MemOpChains.empty())
     Chain = DAG.getNode(ISD::TokenFactor, dl, MVT::Other, MemOpChains);
 
+  if (isFFITailGate) {
+    /// MPK-Isolation: hand the real callee to the tail gate through the
+    /// domain block (R15 + 56) and tail call the gate instead.
+    EVT PtrVT = getPointerTy(DAG.getDataLayout());
+    SDValue Target = LowerGlobalOrExternal(Callee, DAG, /*ForCall=*/false);
+    SDValue Domain = DAG.getCopyFromReg(Chain, dl, X86::R15, PtrVT);
+    SDValue TargetSlot = DAG.getNode(ISD::ADD, dl, PtrVT, Domain,
+                                     DAG.getIntPtrConstant(56, dl));
+    Chain = DAG.getStore(Chain, dl, Target, TargetSlot, MachinePointerInfo());
+    Callee = DAG.getExternalSymbol(MPK_FFI_TAIL_GATE_FUNC_NAME, PtrVT);
+  }
+
   if (Subtarget.isPICStyleGOT()) {
     // ELF / PIC requires GOT in the EBX register before function calls via PLT
     // GOT pointer.
@@ -4221,7 +4278,7 @@ X86TargetLowering::LowerCall(TargetLowering::CallLoweringInfo &CLI,
         // Copy relative to framepointer.
         SDValue Source = DAG.getIntPtrConstant(VA.getLocMemOffset(), dl);
         if (!StackPtr.getNode()){
-          if(isFFICall){
+          if(ExternStackPtr.getNode()){
             StackPtr = ExternStackPtr;
           }else{
             StackPtr = DAG.getCopyFromReg(Chain, dl, RegInfo->getStackRegister(),
@@ -10,10 +10,13 @@
 #include "X86Subtarget.h"
 #include "X86TargetMachine.h"
 #include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/EHPersonalities.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/WinEHFuncInfo.h"
@@ -28,6 +31,21 @@
 using namespace llvm;
 
 #define X86_MPK_ISOLATION_NAME "X86 MPK Isolation"
+#define DEBUG_TYPE "x86-mpk-isolation-pass"
+
+STATISTIC(NumInlineGates, "Number of FFI call sites with an inline gate");
+STATISTIC(NumOutlinedGates,
+          "Number of FFI call sites calling the shared gate trampoline");
+
+static cl::opt<bool> EnableMpkOutlineGates(
+    "mpk-outline-gates", cl::init(false), cl::Hidden,
+    cl::desc("Call the shared __mpk_ffi_gate trampoline at cold FFI call "
+             "sites instead of expanding the gate inline"));
+
+static cl::opt<unsigned> MpkInlineGateFreq(
+    "mpk-inline-gate-freq", cl::init(8), cl::Hidden,
+    cl::desc("Keep the inline gate at FFI call sites whose block runs at "
+             "least this many times per function entry"));
 
 namespace {
 class X86MPKIsolation: public MachineFunctionPass {
@@ -42,11 +60,23 @@ public:
   X86MPKIsolation(): MachineFunctionPass(ID){
     initializeX86MPKIsolationPass(*PassRegistry::getPassRegistry());
   }
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.setPreservesCFG();
+    AU.addRequired<MachineLoopInfo>();
+    AU.addRequired<MachineBlockFrequencyInfo>();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
   bool runOnMachineFunction(MachineFunction &MF) override;
   bool isExternCall(MachineInstr &MI);
+  bool shouldOutlineGate(MachineInstr &MI);
+  void outlineGate(MachineBasicBlock &BB, MachineInstr &MI,
+                   const TargetInstrInfo *TII, const X86Subtarget &STI);
   bool isFrameStoreOpcode(int Opcode, unsigned &MemBytes);
   bool isPush(int Opcode, unsigned &MemBytes);
   const uint32_t getMaskedPKRU(uint8_t pKey, const MPKPROT& prot);
+private:
+  MachineLoopInfo *MLI = nullptr;
+  MachineBlockFrequencyInfo *MBFI = nullptr;
 };
 
 }
@@ -183,6 +213,64 @@ bool X86MPKIsolation::isExternCall(MachineInstr &MI) {
   return false;
 }
 
+/// The trampoline keeps its frame on the extern stack, right where stack
+/// arguments would go, so only callees taking all arguments in registers
+/// can share it.
+static bool takesRegisterArguments(const GlobalValue *GV) {
+  const auto *F = dyn_cast<Function>(GV);
+  if (!F || F->isVarArg())
+    return false;
+  for (const Argument &Arg : F->args())
+    if (Arg.hasByValAttr() || Arg.hasInAllocaAttr() ||
+        Arg.hasPreallocatedAttr())
+      return false;
+  return MpkDomain::passesArgumentsInRegisters(F->getFunctionType()->params(),
+                                               F->getParent()->getDataLayout());
+}
+
+/// Inline gates are kept for loop-resident or hot call sites, where the
+/// extra call/ret of the trampoline would show up; every other direct FFI
+/// call passing its arguments in registers shares the out-of-line
+/// __mpk_ffi_gate.
+bool X86MPKIsolation::shouldOutlineGate(MachineInstr &MI) {
+  if (!EnableMpkOutlineGates || MI.getOpcode() != X86::CALL64pcrel32 ||
+      !MI.getOperand(0).isGlobal() ||
+      !takesRegisterArguments(MI.getOperand(0).getGlobal()))
+    return false;
+  MachineBasicBlock *MBB = MI.getParent();
+  if (MLI->getLoopFor(MBB))
+    return false;
+  uint64_t EntryFreq = MBFI->getEntryFreq();
+  if (EntryFreq &&
+      MBFI->getBlockFreq(MBB).getFrequency() >= EntryFreq * MpkInlineGateFreq)
+    return false;
+  return true;
+}
+
+/// Hand the callee to the trampoline through the domain block (R15 + 56) and
+/// call __mpk_ffi_gate instead. R11 is neither an argument register nor live
+/// across a call, so it carries the callee address.
+void X86MPKIsolation::outlineGate(MachineBasicBlock &BB, MachineInstr &MI,
+                                  const TargetInstrInfo *TII,
+                                  const X86Subtarget &STI) {
+  auto DL = MI.getDebugLoc();
+  MachineOperand &Target = MI.getOperand(0);
+  const GlobalValue *GV = Target.getGlobal();
+  unsigned char Flag = STI.classifyGlobalReference(GV);
+  unsigned LoadOpc = isGlobalStubReference(Flag) ? X86::MOV64rm : X86::LEA64r;
+  BuildMI(BB, MI, DL, TII->get(LoadOpc), X86::R11)
+      .addReg(X86::RIP)
+      .addImm(1)
+      .addReg(0)
+      .addGlobalAddress(GV, Target.getOffset(), Flag)
+      .addReg(0);
+  auto storeTarget = BuildMI(BB, MI, DL, TII->get(X86::MOV64mr));
+  addRegOffset(storeTarget, X86::R15, false, 56).addReg(X86::R11);
+  Target.ChangeToES(MPK_FFI_GATE_FUNC_NAME, STI.isPositionIndependent()
+                                                ? X86II::MO_PLT
+                                                : X86II::MO_NO_FLAG);
+}
+
 char X86MPKIsolation::ID = 0;
 
 bool X86MPKIsolation::runOnMachineFunction(MachineFunction &MF) {
@@ -193,11 +281,27 @@ bool X86MPKIsolation::runOnMachineFunction(MachineFunction &MF) {
   bool foundEntry = false;
   const TargetSubtargetInfo* TSI = &static_cast<const TargetSubtargetInfo&>(MF.getSubtarget());
   const TargetInstrInfo* TII = TSI->getInstrInfo();
+  const TargetRegisterInfo* TRI = TSI->getRegisterInfo();
+  const X86Subtarget &STI = MF.getSubtarget<X86Subtarget>();
+  MLI = &getAnalysis<MachineLoopInfo>();
+  MBFI = &getAnalysis<MachineBlockFrequencyInfo>();
   for(auto &BB: MF){
     MachineBasicBlock::iterator MI = BB.begin();
     while(MI != BB.end()){
       if(MI->getDesc().isCall() && isExternCall(*MI)){
+        if(shouldOutlineGate(*MI)){
+          outlineGate(BB, *MI, TII, STI);
+          ++NumOutlinedGates;
+          MI++;
+          continue;
+        }
+        ++NumInlineGates;
         auto DL = MI->getDebugLoc();
+        /// WRPKRU clobbers ECX/EDX; only preserve them when the call passes
+        /// arguments (entry) or returns values (exit) through them.
+        bool argInRDX = MI->readsRegister(X86::RDX, TRI);
+        bool argInRCX = MI->readsRegister(X86::RCX, TRI);
+        bool retInRDX = MI->definesRegister(X86::RDX, TRI);
 
         /// Store Stack Ptr
         auto saveRSP = BuildMI(BB, MI, DL, TII->get(X86::MOV64mr));
@@ -215,27 +319,35 @@ bool X86MPKIsolation::runOnMachineFunction(MachineFunction &MF) {
         addRegOffset(switchDomain, X86::R15, false, 8).addImm(1);
 
         /// Switch Domain for MPK
-        auto saveEDX = BuildMI(BB, MI, DL, TII->get(X86::MOV32mr));
-        addRegOffset(saveEDX, X86::R15, false, 16).addReg(X86::EDX);
-        auto saveECX = BuildMI(BB, MI, DL, TII->get(X86::MOV32mr));
-        addRegOffset(saveECX, X86::R15, false, 20).addReg(X86::ECX);
+        if(argInRDX){
+          auto saveEDX = BuildMI(BB, MI, DL, TII->get(X86::MOV32mr));
+          addRegOffset(saveEDX, X86::R15, false, 16).addReg(X86::EDX);
+        }
+        if(argInRCX){
+          auto saveECX = BuildMI(BB, MI, DL, TII->get(X86::MOV32mr));
+          addRegOffset(saveECX, X86::R15, false, 20).addReg(X86::ECX);
+        }
         BuildMI(BB, MI, DL, TII->get(X86::MOV32ri), X86::ECX).addImm(0);
         BuildMI(BB, MI, DL, TII->get(X86::MOV32ri), X86::EDX).addImm(0);
         BuildMI(BB, MI, DL, TII->get(X86::MOV32ri), X86::EAX).addImm(0);
         BuildMI(BB, MI, DL, TII->get(X86::WRPKRUr));
-        auto restoreEDX = BuildMI(BB, MI, DL, TII->get(X86::MOV32rm), X86::EDX);
-        addRegOffset(restoreEDX, X86::R15, false, 16);
-        auto restoreECX = BuildMI(BB, MI, DL, TII->get(X86::MOV32rm), X86::ECX);
-        addRegOffset(restoreECX, X86::R15, false, 20);
+        if(argInRDX){
+          auto restoreEDX = BuildMI(BB, MI, DL, TII->get(X86::MOV32rm), X86::EDX);
+          addRegOffset(restoreEDX, X86::R15, false, 16);
+        }
+        if(argInRCX){
+          auto restoreECX = BuildMI(BB, MI, DL, TII->get(X86::MOV32rm), X86::ECX);
+          addRegOffset(restoreECX, X86::R15, false, 20);
+        }
         MI++;
 
         /// Switch Domain for MPK
         auto saveEAX = BuildMI(BB, MI, DL, TII->get(X86::MOV32mr));
         addRegOffset(saveEAX, X86::R15, false, 12).addReg(X86::EAX);
-        saveEDX = BuildMI(BB, MI, DL, TII->get(X86::MOV32mr));
-        addRegOffset(saveEDX, X86::R15, false, 16).addReg(X86::EDX);
-        saveECX = BuildMI(BB, MI, DL, TII->get(X86::MOV32mr));
-        addRegOffset(saveECX, X86::R15, false, 20).addReg(X86::ECX);
+        if(retInRDX){
+          auto saveEDX = BuildMI(BB, MI, DL, TII->get(X86::MOV32mr));
+          addRegOffset(saveEDX, X86::R15, false, 16).addReg(X86::EDX);
+        }
         BuildMI(BB, MI, DL, TII->get(X86::MOV32ri), X86::ECX).addImm(0);
         BuildMI(BB, MI, DL, TII->get(X86::MOV32ri), X86::EDX).addImm(0);
         BuildMI(BB, MI, DL, TII->get(X86::MOV32ri), X86::EAX).addImm(0);
@@ -243,10 +355,10 @@ bool X86MPKIsolation::runOnMachineFunction(MachineFunction &MF) {
 
         auto restoreEAX = BuildMI(BB, MI, DL, TII->get(X86::MOV32rm), X86::EAX);
         addRegOffset(restoreEAX, X86::R15, false, 12);
-        restoreEDX = BuildMI(BB, MI, DL, TII->get(X86::MOV32rm), X86::EDX);
-        addRegOffset(restoreEDX, X86::R15, false, 16);
-        restoreECX = BuildMI(BB, MI, DL, TII->get(X86::MOV32rm), X86::ECX);
-        addRegOffset(restoreECX, X86::R15, false, 20);
+        if(retInRDX){
+          auto restoreEDX = BuildMI(BB, MI, DL, TII->get(X86::MOV32rm), X86::EDX);
+          addRegOffset(restoreEDX, X86::R15, false, 16);
+        }
 
         /// Switch Domain for MPK-LIBRARY
         switchDomain = BuildMI(BB, MI, DL, TII->get(X86::MOV32mi));
@@ -263,9 +375,12 @@ bool X86MPKIsolation::runOnMachineFunction(MachineFunction &MF) {
   return true;
 }
 
-INITIALIZE_PASS(X86MPKIsolation, "x86-mpk-isolation-pass",
-                X86_MPK_ISOLATION_NAME, false, false
-)
+INITIALIZE_PASS_BEGIN(X86MPKIsolation, "x86-mpk-isolation-pass",
+                      X86_MPK_ISOLATION_NAME, false, false)
+INITIALIZE_PASS_DEPENDENCY(MachineLoopInfo)
+INITIALIZE_PASS_DEPENDENCY(MachineBlockFrequencyInfo)
+INITIALIZE_PASS_END(X86MPKIsolation, "x86-mpk-isolation-pass",
+                    X86_MPK_ISOLATION_NAME, false, false)
 FunctionPass *llvm::createX86MPKIsolationPass(){
   return new X86MPKIsolation();
 }
@@ -0,0 +1,274 @@
+//===- xray-mpk.cpp - MPK Untrusted Domain Latency Histograms -------------===//
+//
+// Part of the LLVM Project, under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the 'mpk' subcommand, which turns the custom events
+// emitted with -mpk-xray-events into per-callee histograms of the time spent
+// in the untrusted domain, and a size histogram of unsafe heap allocations.
+//
+// Every custom event payload starts with a kind byte:
+//   'E' <callee name>  entering the untrusted domain for an FFI call
+//   'X' <callee name>  returning to the trusted domain
+//   'A' <u64 size> <u8 flag>  allocation through __mpk_unsafe__rust_alloc;
+//                             a zero flag allocates from the safe heap
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "xray-registry.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/XRay/Trace.h"
+
+using namespace llvm;
+using namespace llvm::xray;
+
+static cl::SubCommand
+    Mpk("mpk", "Histograms of time spent in the MPK untrusted domain");
+static cl::opt<std::string> MpkInput(cl::Positional,
+                                     cl::desc("<xray log file>"), cl::Required,
+                                     cl::sub(Mpk));
+static cl::opt<std::string> MpkOutput("output", cl::value_desc("output file"),
+                                      cl::init("-"),
+                                      cl::desc("output file; use '-' for stdout"),
+                                      cl::sub(Mpk));
+static cl::alias MpkOutput2("o", cl::aliasopt(MpkOutput),
+                            cl::desc("Alias for -output"));
+enum class MpkOutputFormats { TEXT, CSV };
+static cl::opt<MpkOutputFormats>
+    MpkOutputFormat("format", cl::desc("output format"),
+                    cl::values(clEnumValN(MpkOutputFormats::TEXT, "text",
+                                          "report histograms in text"),
+                               clEnumValN(MpkOutputFormats::CSV, "csv",
+                                          "report histogram buckets in csv")),
+                    cl::sub(Mpk));
+static cl::alias MpkOutputFormat2("f", cl::desc("Alias of -format"),
+                                  cl::aliasopt(MpkOutputFormat));
+static cl::opt<int> MpkTop("top", cl::desc("only show the top N callees"),
+                           cl::sub(Mpk), cl::init(-1));
+static cl::alias MpkTop2("p", cl::desc("Alias for -top"),
+                         cl::aliasopt(MpkTop));
+
+namespace {
+
+// Durations and sizes are bucketed by powers of two: bucket K holds values in
+// [2^(K-1), 2^K), bucket 0 holds zero.
+using Histogram = std::vector<uint64_t>;
+
+void addToHistogram(Histogram &H, uint64_t Value) {
+  unsigned Bucket = Value == 0 ? 0 : Log2_64(Value) + 1;
+  if (H.size() <= Bucket)
+    H.resize(Bucket + 1);
+  ++H[Bucket];
+}
+
+uint64_t bucketLow(unsigned Bucket) {
+  return Bucket == 0 ? 0 : uint64_t(1) << (Bucket - 1);
+}
+
+uint64_t bucketHigh(unsigned Bucket) { return uint64_t(1) << Bucket; }
+
+struct CalleeStats {
+  std::string Name;
+  std::vector<uint64_t> Durations; // in ticks (ns when the frequency is known)
+  Histogram Buckets;
+  uint64_t Sum = 0;
+};
+
+class MpkAccountant {
+  // Open FFI calls per thread, innermost last; FFI code may call back into
+  // Rust which calls out again.
+  DenseMap<uint32_t, std::vector<std::pair<std::string, uint64_t>>> Open;
+  StringMap<CalleeStats> Callees;
+  double TicksPerUnit;
+
+public:
+  Histogram AllocSizes;
+  uint64_t AllocBytes = 0;
+  uint64_t NumAllocs = 0;
+  uint64_t NumUnmatched = 0;
+  uint64_t NumMalformed = 0;
+
+  explicit MpkAccountant(uint64_t CycleFrequency)
+      : TicksPerUnit(CycleFrequency ? double(CycleFrequency) / 1e9 : 1.0) {}
+
+  void accountRecord(const XRayRecord &R);
+  void finish() {
+    for (const auto &ThreadStack : Open)
+      NumUnmatched += ThreadStack.second.size();
+  }
+  std::vector<CalleeStats *> sortedCallees();
+};
+
+} // namespace
+
+void MpkAccountant::accountRecord(const XRayRecord &R) {
+  if (R.Type != RecordTypes::CUSTOM_EVENT || R.Data.empty())
+    return;
+  StringRef Payload(R.Data);
+  char Kind = Payload.front();
+  Payload = Payload.drop_front();
+
+  switch (Kind) {
+  case 'E':
+    Open[R.TId].emplace_back(Payload.str(), R.TSC);
+    return;
+  case 'X': {
+    auto &Stack = Open[R.TId];
+    // Match the innermost open call to the same callee; anything opened after
+    // it lost its exit event and is dropped.
+    auto It = std::find_if(Stack.rbegin(), Stack.rend(),
+                           [&](const std::pair<std::string, uint64_t> &E) {
+                             return E.first == Payload;
+                           });
+    if (It == Stack.rend()) {
+      ++NumUnmatched;
+      return;
+    }
+    NumUnmatched += std::distance(Stack.rbegin(), It);
+    uint64_t Start = It->second;
+    Stack.erase(std::next(It).base(), Stack.end());
+
+    uint64_t Ticks = R.TSC > Start ? R.TSC - Start : 0;
+    uint64_t Duration = uint64_t(double(Ticks) / TicksPerUnit);
+    CalleeStats &S = Callees[Payload];
+    if (S.Name.empty())
+      S.Name = Payload.str();
+    S.Durations.push_back(Duration);
+    S.Sum += Duration;
+    addToHistogram(S.Buckets, Duration);
+    return;
+  }
+  case 'A':
+    if (Payload.size() != sizeof(uint64_t) + 1) {
+      ++NumMalformed;
+      return;
+    }
+    // Safe allocations go through the same allocator entry point.
+    if (Payload.back() == 0)
+      return;
+    {
+      uint64_t Size = support::endian::read64le(Payload.data());
+      ++NumAllocs;
+      AllocBytes += Size;
+      addToHistogram(AllocSizes, Size);
+    }
+    return;
+  default:
+    // Custom events from other sources.
+    return;
+  }
+}
+
+std::vector<CalleeStats *> MpkAccountant::sortedCallees() {
+  std::vector<CalleeStats *> Result;
+  for (auto &Entry : Callees)
+    Result.push_back(&Entry.getValue());
+  llvm::sort(Result, [](const CalleeStats *L, const CalleeStats *R) {
+    return L->Sum > R->Sum || (L->Sum == R->Sum && L->Name < R->Name);
+  });
+  if (MpkTop > 0 && Result.size() > size_t(MpkTop))
+    Result.resize(MpkTop);
+  for (CalleeStats *S : Result)
+    llvm::sort(S->Durations);
+  return Result;
+}
+
+static uint64_t percentile(const std::vector<uint64_t> &Sorted, double P) {
+  return Sorted[std::min(Sorted.size() - 1, size_t(Sorted.size() * P))];
+}
+
+static void printHistogram(raw_ostream &OS, const Histogram &H,
+                           StringRef Unit) {
+  uint64_t Max = *std::max_element(H.begin(), H.end());
+  for (unsigned B = 0; B < H.size(); ++B) {
+    if (!H[B])
+      continue;
+    unsigned Width = unsigned((H[B] * 40 + Max - 1) / Max);
+    OS << formatv("  [{0,12}, {1,12}) {2}: {3,10} ", bucketLow(B),
+                  bucketHigh(B), Unit, H[B])
+       << std::string(Width, '#') << '\n';
+  }
+}
+
+static void exportText(raw_ostream &OS, MpkAccountant &A, StringRef Unit) {
+  for (CalleeStats *S : A.sortedCallees()) {
+    const auto &D = S->Durations;
+    OS << formatv("{0}: count {1}, min {2}, med {3}, 90p {4}, 99p {5}, max "
+                  "{6}, sum {7} ({8})\n",
+                  S->Name, D.size(), D.front(), percentile(D, 0.5),
+                  percentile(D, 0.9), percentile(D, 0.99), D.back(), S->Sum,
+                  Unit);
+    printHistogram(OS, S->Buckets, Unit);
+  }
+  if (A.NumAllocs) {
+    OS << formatv("unsafe allocations: count {0}, bytes {1}\n", A.NumAllocs,
+                  A.AllocBytes);
+    printHistogram(OS, A.AllocSizes, "bytes");
+  }
+  if (A.NumUnmatched)
+    OS << formatv("unmatched domain transitions: {0}\n", A.NumUnmatched);
+  if (A.NumMalformed)
+    OS << formatv("malformed allocation events: {0}\n", A.NumMalformed);
+}
+
+static void exportCSV(raw_ostream &OS, MpkAccountant &A, StringRef Unit) {
+  OS << "kind,name,low,high,unit,count\n";
+  for (CalleeStats *S : A.sortedCallees())
+    for (unsigned B = 0; B < S->Buckets.size(); ++B)
+      if (S->Buckets[B])
+        OS << formatv("ffi,{0},{1},{2},{3},{4}\n", S->Name, bucketLow(B),
+                      bucketHigh(B), Unit, S->Buckets[B]);
+  for (unsigned B = 0; B < A.AllocSizes.size(); ++B)
+    if (A.AllocSizes[B])
+      OS << formatv("alloc,{0},{1},{2},bytes,{3}\n", "__mpk_unsafe__rust_alloc",
+                    bucketLow(B), bucketHigh(B), A.AllocSizes[B]);
+}
+
+static CommandRegistration Unused(&Mpk, []() -> Error {
+  std::error_code EC;
+  raw_fd_ostream OS(MpkOutput, EC, sys::fs::OpenFlags::OF_Text);
+  if (EC)
+    return make_error<StringError>(
+        Twine("Cannot open file '") + MpkOutput + "' for writing.", EC);
+
+  auto TraceOrErr = loadTraceFile(MpkInput);
+  if (!TraceOrErr)
+    return joinErrors(
+        make_error<StringError>(
+            Twine("Failed loading input file '") + MpkInput + "'",
+            std::make_error_code(std::errc::executable_format_error)),
+        TraceOrErr.takeError());
+
+  auto &T = *TraceOrErr;
+  uint64_t CycleFrequency = T.getFileHeader().CycleFrequency;
+  MpkAccountant A(CycleFrequency);
+  for (const auto &Record : T)
+    A.accountRecord(Record);
+  A.finish();
+
+  // Without a cycle frequency in the header, report raw TSC ticks.
+  StringRef Unit = CycleFrequency ? "ns" : "cycles";
+  switch (MpkOutputFormat) {
+  case MpkOutputFormats::TEXT:
+    exportText(OS, A, Unit);
+    break;
+  case MpkOutputFormats::CSV:
+    exportCSV(OS, A, Unit);
+    break;
+  }
+  return Error::success();
+});
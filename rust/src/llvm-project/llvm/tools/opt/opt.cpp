@@ -571,6 +571,8 @@ int main(int argc, char **argv) {
   initializeDwarfEHPreparePass(Registry);
   initializeSafeStackLegacyPassPass(Registry);
   initializeMpkIsolationGatesPassPass(Registry);
+  initializeMpkSfiCDepsPassPass(Registry);
+  initializeMpkCallGraphProfilePassPass(Registry);
   initializeSfiTestPassPass(Registry);
   initializeSjLjEHPreparePass(Registry);
   initializePreISelIntrinsicLoweringLegacyPassPass(Registry);